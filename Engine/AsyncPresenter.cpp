@@ -0,0 +1,135 @@
+/******************************************************************************************
+*	Chili DirectX Framework Version 16.10.01											  *
+*	AsyncPresenter.cpp																	  *
+*	Copyright 2016 PlanetChili <http://www.planetchili.net>								  *
+*																						  *
+*	This file is part of The Chili DirectX Framework.									  *
+*																						  *
+*	The Chili DirectX Framework is free software: you can redistribute it and/or modify	  *
+*	it under the terms of the GNU General Public License as published by				  *
+*	the Free Software Foundation, either version 3 of the License, or					  *
+*	(at your option) any later version.													  *
+*																						  *
+*	The Chili DirectX Framework is distributed in the hope that it will be useful,		  *
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of						  *
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the						  *
+*	GNU General Public License for more details.										  *
+*																						  *
+*	You should have received a copy of the GNU General Public License					  *
+*	along with The Chili DirectX Framework.  If not, see <http://www.gnu.org/licenses/>.  *
+******************************************************************************************/
+#include "AsyncPresenter.h"
+#include "Profiler.h"
+
+AsyncPresenter::AsyncPresenter( std::unique_ptr<Presenter> pInner,unsigned int width,unsigned int height,
+	unsigned int queueDepth )
+	:
+	pInner( std::move( pInner ) )
+{
+	assert( queueDepth > 0u );
+	frames.reserve( queueDepth );
+	for( unsigned int i = 0u; i < queueDepth; i++ )
+	{
+		frames.emplace_back( width,height,Surface::RowAlignment::CacheLine );
+		freeFrames.push_back( i );
+	}
+	presentThread = std::thread( &AsyncPresenter::PresentLoop,this );
+}
+
+AsyncPresenter::~AsyncPresenter()
+{
+	{
+		std::lock_guard<std::mutex> lock( mtx );
+		stopping = true;
+	}
+	cv.notify_all();
+	presentThread.join();
+}
+
+Surface AsyncPresenter::Map()
+{
+	std::unique_lock<std::mutex> lock( mtx );
+	assert( !isMapped );
+	// back-pressure: wait for the present thread to give a frame back
+	cv.wait( lock,[this]() { return !freeFrames.empty() || presentError; } );
+	RethrowPresentError();
+	mapped = freeFrames.back();
+	freeFrames.pop_back();
+	isMapped = true;
+	Surface& frame = frames[mapped];
+	return Surface::MakeView( frame.GetBufferPtr(),frame.GetWidth(),frame.GetHeight(),frame.GetPitch() );
+}
+
+void AsyncPresenter::Unmap()
+{
+	{
+		std::lock_guard<std::mutex> lock( mtx );
+		assert( isMapped );
+		isMapped = false;
+		readyFrames.push_back( mapped );
+	}
+	cv.notify_all();
+}
+
+void AsyncPresenter::Present()
+{
+	std::lock_guard<std::mutex> lock( mtx );
+	RethrowPresentError();
+}
+
+void AsyncPresenter::Flush()
+{
+	std::unique_lock<std::mutex> lock( mtx );
+	cv.wait( lock,[this]() { return (readyFrames.empty() && !busy) || presentError; } );
+	RethrowPresentError();
+}
+
+void AsyncPresenter::PresentLoop()
+{
+	std::unique_lock<std::mutex> lock( mtx );
+	while( true )
+	{
+		cv.wait( lock,[this]() { return !readyFrames.empty() || stopping; } );
+		if( readyFrames.empty() )
+		{
+			// stopping and everything has been presented
+			return;
+		}
+		const size_t i = readyFrames.front();
+		readyFrames.pop_front();
+		busy = true;
+		lock.unlock();
+
+		try
+		{
+			CHILI_PROFILE_ZONE( "PresentFrame" );
+			Surface target = pInner->Map();
+			frames[i].Present( target.GetPitch() * sizeof( Color ),
+				reinterpret_cast<unsigned char*>(target.GetBufferPtr()) );
+			pInner->Unmap();
+			pInner->Present();
+		}
+		catch( ... )
+		{
+			lock.lock();
+			// hand the error over to the render thread and stop presenting
+			presentError = std::current_exception();
+			busy = false;
+			cv.notify_all();
+			return;
+		}
+
+		lock.lock();
+		busy = false;
+		freeFrames.push_back( i );
+		cv.notify_all();
+	}
+}
+
+void AsyncPresenter::RethrowPresentError()
+{
+	if( presentError )
+	{
+		std::rethrow_exception( presentError );
+	}
+}
@@ -0,0 +1,67 @@
+/******************************************************************************************
+*	Chili DirectX Framework Version 16.10.01											  *
+*	AsyncPresenter.h																	  *
+*	Copyright 2016 PlanetChili <http://www.planetchili.net>								  *
+*																						  *
+*	This file is part of The Chili DirectX Framework.									  *
+*																						  *
+*	The Chili DirectX Framework is free software: you can redistribute it and/or modify	  *
+*	it under the terms of the GNU General Public License as published by				  *
+*	the Free Software Foundation, either version 3 of the License, or					  *
+*	(at your option) any later version.													  *
+*																						  *
+*	The Chili DirectX Framework is distributed in the hope that it will be useful,		  *
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of						  *
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the						  *
+*	GNU General Public License for more details.										  *
+*																						  *
+*	You should have received a copy of the GNU General Public License					  *
+*	along with The Chili DirectX Framework.  If not, see <http://www.gnu.org/licenses/>.  *
+******************************************************************************************/
+#pragma once
+
+#include "Presenter.h"
+#include <memory>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+
+// wraps another presenter and moves uploading/presenting onto a dedicated thread
+// the render thread fills one of queueDepth frames while the present thread works
+// through finished ones; Map blocks when every frame is still queued (back-pressure)
+class AsyncPresenter : public Presenter
+{
+public:
+	AsyncPresenter( std::unique_ptr<Presenter> pInner,unsigned int width,unsigned int height,
+		unsigned int queueDepth = 2u );
+	AsyncPresenter( const AsyncPresenter& ) = delete;
+	AsyncPresenter& operator=( const AsyncPresenter& ) = delete;
+	// presents any frames still queued before returning
+	~AsyncPresenter();
+	Surface Map() override;
+	void Unmap() override;
+	// frame is handed off in Unmap, so nothing left to do here
+	void Present() override;
+	// block until every queued frame has been presented
+	void Flush();
+private:
+	void PresentLoop();
+	void RethrowPresentError();
+private:
+	std::unique_ptr<Presenter> pInner;
+	std::vector<Surface> frames;
+	// indices into frames
+	std::vector<size_t> freeFrames;
+	std::deque<size_t> readyFrames;
+	size_t mapped = 0u;
+	bool isMapped = false;
+	bool busy = false;
+	bool stopping = false;
+	std::exception_ptr presentError;
+	std::mutex mtx;
+	std::condition_variable cv;
+	std::thread presentThread;
+};
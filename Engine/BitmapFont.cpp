@@ -0,0 +1,192 @@
+/******************************************************************************************
+*	Chili DirectX Framework Version 16.10.01											  *
+*	BitmapFont.cpp																		  *
+*	Copyright 2016 PlanetChili <http://www.planetchili.net>								  *
+*																						  *
+*	This file is part of The Chili DirectX Framework.									  *
+*																						  *
+*	The Chili DirectX Framework is free software: you can redistribute it and/or modify	  *
+*	it under the terms of the GNU General Public License as published by				  *
+*	the Free Software Foundation, either version 3 of the License, or					  *
+*	(at your option) any later version.													  *
+*																						  *
+*	The Chili DirectX Framework is distributed in the hope that it will be useful,		  *
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of						  *
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the						  *
+*	GNU General Public License for more details.										  *
+*																						  *
+*	You should have received a copy of the GNU General Public License					  *
+*	along with The Chili DirectX Framework.  If not, see <http://www.gnu.org/licenses/>.  *
+******************************************************************************************/
+#include "BitmapFont.h"
+#include <algorithm>
+
+namespace
+{
+	// one byte per row, top to bottom, the leftmost pixel in bit 4; the bottom row is for descenders
+	constexpr unsigned char glyphRows[][BitmapFont::GlyphHeight] =
+	{
+		{ 0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00 }, // ' '
+		{ 0x04,0x04,0x04,0x04,0x04,0x00,0x04,0x00 }, // '!'
+		{ 0x0A,0x0A,0x0A,0x00,0x00,0x00,0x00,0x00 }, // '"'
+		{ 0x0A,0x0A,0x1F,0x0A,0x1F,0x0A,0x0A,0x00 }, // '#'
+		{ 0x04,0x0F,0x14,0x0E,0x05,0x1E,0x04,0x00 }, // '$'
+		{ 0x18,0x19,0x02,0x04,0x08,0x13,0x03,0x00 }, // '%'
+		{ 0x0C,0x12,0x14,0x08,0x15,0x12,0x0D,0x00 }, // '&'
+		{ 0x04,0x04,0x08,0x00,0x00,0x00,0x00,0x00 }, // '\''
+		{ 0x02,0x04,0x08,0x08,0x08,0x04,0x02,0x00 }, // '('
+		{ 0x08,0x04,0x02,0x02,0x02,0x04,0x08,0x00 }, // ')'
+		{ 0x00,0x04,0x15,0x0E,0x15,0x04,0x00,0x00 }, // '*'
+		{ 0x00,0x04,0x04,0x1F,0x04,0x04,0x00,0x00 }, // '+'
+		{ 0x00,0x00,0x00,0x00,0x00,0x0C,0x04,0x08 }, // ','
+		{ 0x00,0x00,0x00,0x1F,0x00,0x00,0x00,0x00 }, // '-'
+		{ 0x00,0x00,0x00,0x00,0x00,0x0C,0x0C,0x00 }, // '.'
+		{ 0x00,0x01,0x02,0x04,0x08,0x10,0x00,0x00 }, // '/'
+		{ 0x0E,0x11,0x13,0x15,0x19,0x11,0x0E,0x00 }, // '0'
+		{ 0x04,0x0C,0x04,0x04,0x04,0x04,0x0E,0x00 }, // '1'
+		{ 0x0E,0x11,0x01,0x02,0x04,0x08,0x1F,0x00 }, // '2'
+		{ 0x1F,0x02,0x04,0x02,0x01,0x11,0x0E,0x00 }, // '3'
+		{ 0x02,0x06,0x0A,0x12,0x1F,0x02,0x02,0x00 }, // '4'
+		{ 0x1F,0x10,0x1E,0x01,0x01,0x11,0x0E,0x00 }, // '5'
+		{ 0x06,0x08,0x10,0x1E,0x11,0x11,0x0E,0x00 }, // '6'
+		{ 0x1F,0x01,0x02,0x04,0x08,0x08,0x08,0x00 }, // '7'
+		{ 0x0E,0x11,0x11,0x0E,0x11,0x11,0x0E,0x00 }, // '8'
+		{ 0x0E,0x11,0x11,0x0F,0x01,0x02,0x0C,0x00 }, // '9'
+		{ 0x00,0x0C,0x0C,0x00,0x0C,0x0C,0x00,0x00 }, // ':'
+		{ 0x00,0x0C,0x0C,0x00,0x0C,0x04,0x08,0x00 }, // ';'
+		{ 0x02,0x04,0x08,0x10,0x08,0x04,0x02,0x00 }, // '<'
+		{ 0x00,0x00,0x1F,0x00,0x1F,0x00,0x00,0x00 }, // '='
+		{ 0x08,0x04,0x02,0x01,0x02,0x04,0x08,0x00 }, // '>'
+		{ 0x0E,0x11,0x01,0x02,0x04,0x00,0x04,0x00 }, // '?'
+		{ 0x0E,0x11,0x01,0x0D,0x15,0x15,0x0E,0x00 }, // '@'
+		{ 0x0E,0x11,0x11,0x11,0x1F,0x11,0x11,0x00 }, // 'A'
+		{ 0x1E,0x11,0x11,0x1E,0x11,0x11,0x1E,0x00 }, // 'B'
+		{ 0x0E,0x11,0x10,0x10,0x10,0x11,0x0E,0x00 }, // 'C'
+		{ 0x1C,0x12,0x11,0x11,0x11,0x12,0x1C,0x00 }, // 'D'
+		{ 0x1F,0x10,0x10,0x1E,0x10,0x10,0x1F,0x00 }, // 'E'
+		{ 0x1F,0x10,0x10,0x1E,0x10,0x10,0x10,0x00 }, // 'F'
+		{ 0x0E,0x11,0x10,0x17,0x11,0x11,0x0F,0x00 }, // 'G'
+		{ 0x11,0x11,0x11,0x1F,0x11,0x11,0x11,0x00 }, // 'H'
+		{ 0x0E,0x04,0x04,0x04,0x04,0x04,0x0E,0x00 }, // 'I'
+		{ 0x07,0x02,0x02,0x02,0x02,0x12,0x0C,0x00 }, // 'J'
+		{ 0x11,0x12,0x14,0x18,0x14,0x12,0x11,0x00 }, // 'K'
+		{ 0x10,0x10,0x10,0x10,0x10,0x10,0x1F,0x00 }, // 'L'
+		{ 0x11,0x1B,0x15,0x15,0x11,0x11,0x11,0x00 }, // 'M'
+		{ 0x11,0x11,0x19,0x15,0x13,0x11,0x11,0x00 }, // 'N'
+		{ 0x0E,0x11,0x11,0x11,0x11,0x11,0x0E,0x00 }, // 'O'
+		{ 0x1E,0x11,0x11,0x1E,0x10,0x10,0x10,0x00 }, // 'P'
+		{ 0x0E,0x11,0x11,0x11,0x15,0x12,0x0D,0x00 }, // 'Q'
+		{ 0x1E,0x11,0x11,0x1E,0x14,0x12,0x11,0x00 }, // 'R'
+		{ 0x0F,0x10,0x10,0x0E,0x01,0x01,0x1E,0x00 }, // 'S'
+		{ 0x1F,0x04,0x04,0x04,0x04,0x04,0x04,0x00 }, // 'T'
+		{ 0x11,0x11,0x11,0x11,0x11,0x11,0x0E,0x00 }, // 'U'
+		{ 0x11,0x11,0x11,0x11,0x11,0x0A,0x04,0x00 }, // 'V'
+		{ 0x11,0x11,0x11,0x15,0x15,0x15,0x0A,0x00 }, // 'W'
+		{ 0x11,0x11,0x0A,0x04,0x0A,0x11,0x11,0x00 }, // 'X'
+		{ 0x11,0x11,0x11,0x0A,0x04,0x04,0x04,0x00 }, // 'Y'
+		{ 0x1F,0x01,0x02,0x04,0x08,0x10,0x1F,0x00 }, // 'Z'
+		{ 0x0E,0x08,0x08,0x08,0x08,0x08,0x0E,0x00 }, // '['
+		{ 0x00,0x10,0x08,0x04,0x02,0x01,0x00,0x00 }, // '\\'
+		{ 0x0E,0x02,0x02,0x02,0x02,0x02,0x0E,0x00 }, // ']'
+		{ 0x04,0x0A,0x11,0x00,0x00,0x00,0x00,0x00 }, // '^'
+		{ 0x00,0x00,0x00,0x00,0x00,0x00,0x1F,0x00 }, // '_'
+		{ 0x08,0x04,0x02,0x00,0x00,0x00,0x00,0x00 }, // '`'
+		{ 0x00,0x00,0x0E,0x01,0x0F,0x11,0x0F,0x00 }, // 'a'
+		{ 0x10,0x10,0x16,0x19,0x11,0x11,0x1E,0x00 }, // 'b'
+		{ 0x00,0x00,0x0E,0x10,0x10,0x11,0x0E,0x00 }, // 'c'
+		{ 0x01,0x01,0x0D,0x13,0x11,0x11,0x0F,0x00 }, // 'd'
+		{ 0x00,0x00,0x0E,0x11,0x1F,0x10,0x0E,0x00 }, // 'e'
+		{ 0x06,0x09,0x08,0x1C,0x08,0x08,0x08,0x00 }, // 'f'
+		{ 0x00,0x00,0x0F,0x11,0x11,0x0F,0x01,0x0E }, // 'g'
+		{ 0x10,0x10,0x16,0x19,0x11,0x11,0x11,0x00 }, // 'h'
+		{ 0x04,0x00,0x0C,0x04,0x04,0x04,0x0E,0x00 }, // 'i'
+		{ 0x02,0x00,0x06,0x02,0x02,0x02,0x12,0x0C }, // 'j'
+		{ 0x10,0x10,0x12,0x14,0x18,0x14,0x12,0x00 }, // 'k'
+		{ 0x0C,0x04,0x04,0x04,0x04,0x04,0x0E,0x00 }, // 'l'
+		{ 0x00,0x00,0x1A,0x15,0x15,0x11,0x11,0x00 }, // 'm'
+		{ 0x00,0x00,0x16,0x19,0x11,0x11,0x11,0x00 }, // 'n'
+		{ 0x00,0x00,0x0E,0x11,0x11,0x11,0x0E,0x00 }, // 'o'
+		{ 0x00,0x00,0x1E,0x11,0x11,0x1E,0x10,0x10 }, // 'p'
+		{ 0x00,0x00,0x0F,0x11,0x11,0x0F,0x01,0x01 }, // 'q'
+		{ 0x00,0x00,0x16,0x19,0x10,0x10,0x10,0x00 }, // 'r'
+		{ 0x00,0x00,0x0E,0x10,0x0E,0x01,0x1E,0x00 }, // 's'
+		{ 0x08,0x08,0x1C,0x08,0x08,0x09,0x06,0x00 }, // 't'
+		{ 0x00,0x00,0x11,0x11,0x11,0x13,0x0D,0x00 }, // 'u'
+		{ 0x00,0x00,0x11,0x11,0x11,0x0A,0x04,0x00 }, // 'v'
+		{ 0x00,0x00,0x11,0x11,0x15,0x15,0x0A,0x00 }, // 'w'
+		{ 0x00,0x00,0x11,0x0A,0x04,0x0A,0x11,0x00 }, // 'x'
+		{ 0x00,0x00,0x11,0x11,0x11,0x0F,0x01,0x0E }, // 'y'
+		{ 0x00,0x00,0x1F,0x02,0x04,0x08,0x1F,0x00 }, // 'z'
+		{ 0x02,0x04,0x04,0x08,0x04,0x04,0x02,0x00 }, // '{'
+		{ 0x04,0x04,0x04,0x04,0x04,0x04,0x04,0x00 }, // '|'
+		{ 0x08,0x04,0x04,0x02,0x04,0x04,0x08,0x00 }, // '}'
+		{ 0x00,0x00,0x08,0x15,0x02,0x00,0x00,0x00 }, // '~'
+	};
+}
+
+BitmapFont::BitmapFont()
+	:
+	atlas( CellWidth,GlyphHeight * nGlyphs )
+{
+	static_assert( sizeof( glyphRows ) / sizeof( *glyphRows ) == nGlyphs,"one glyph per character" );
+	const Color ink( 255u,255u,255u,255u );
+	const Color clear( 0u,255u,255u,255u );
+	for( unsigned int i = 0u; i < nGlyphs; i++ )
+	{
+		blank[i] = true;
+		for( int y = 0; y < GlyphHeight; y++ )
+		{
+			const unsigned int bits = glyphRows[i][y];
+			blank[i] = blank[i] && bits == 0u;
+			for( int x = 0; x < CellWidth; x++ )
+			{
+				const bool set = x < GlyphWidth && ((bits >> (GlyphWidth - 1 - x)) & 1u);
+				atlas.PutPixel( x,i * GlyphHeight + y,set ? ink : clear );
+			}
+		}
+	}
+}
+
+void BitmapFont::Layout( const std::string& text,TextLayout& layout ) const
+{
+	layout.quads.clear();
+	int x = 0;
+	int y = 0;
+	int width = 0;
+	for( const char c : text )
+	{
+		if( c == '\n' )
+		{
+			x = 0;
+			y += LineHeight;
+			continue;
+		}
+		const unsigned int i = c >= firstChar && c <= lastChar ? unsigned( c - firstChar ) : unsigned( '?' - firstChar );
+		if( !blank[i] )
+		{
+			const int top = int( i ) * GlyphHeight;
+			layout.quads.push_back( { x,y,{ top,top + GlyphHeight,0,CellWidth } } );
+		}
+		x += Advance;
+		width = std::max( width,x );
+	}
+	layout.width = width;
+	layout.height = text.empty() ? 0 : y + LineHeight;
+}
+
+const BitmapFont::TextLayout& BitmapFont::GetCached( const std::string& text )
+{
+	const auto i = cache.find( text );
+	if( i != cache.end() )
+	{
+		return i->second;
+	}
+	TextLayout& layout = cache[text];
+	Layout( text,layout );
+	return layout;
+}
+
+void BitmapFont::ClearCache()
+{
+	cache.clear();
+}
@@ -0,0 +1,85 @@
+/******************************************************************************************
+*	Chili DirectX Framework Version 16.10.01											  *
+*	BitmapFont.h																		  *
+*	Copyright 2016 PlanetChili <http://www.planetchili.net>								  *
+*																						  *
+*	This file is part of The Chili DirectX Framework.									  *
+*																						  *
+*	The Chili DirectX Framework is free software: you can redistribute it and/or modify	  *
+*	it under the terms of the GNU General Public License as published by				  *
+*	the Free Software Foundation, either version 3 of the License, or					  *
+*	(at your option) any later version.													  *
+*																						  *
+*	The Chili DirectX Framework is distributed in the hope that it will be useful,		  *
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of						  *
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the						  *
+*	GNU General Public License for more details.										  *
+*																						  *
+*	You should have received a copy of the GNU General Public License					  *
+*	along with The Chili DirectX Framework.  If not, see <http://www.gnu.org/licenses/>.  *
+******************************************************************************************/
+#pragma once
+
+#include "Surface.h"
+#include "Rect.h"
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+// fixed width 5x8 pixel font covering printable ASCII, drawn with Graphics::DrawString
+// the glyphs are rasterized once into an atlas whose pixels are white, with alpha as coverage,
+// for Surface::BlendMode::Tint to draw in any color; glyphs are stacked top to bottom in 8x8
+// cells, so each glyph is 256 contiguous, cache line aligned bytes
+// quads take in the whole cell: its blank columns leave the destination as it was under Tint,
+// and 8 pixel rows blend in whole SIMD registers with no scalar tail
+class BitmapFont
+{
+public:
+	// one glyph of laid out text: the part of the atlas to draw, and where relative to the text
+	struct Quad
+	{
+		int x;
+		int y;
+		RectI srcRect;
+	};
+	struct TextLayout
+	{
+		// blank glyphs (spaces) get no quad
+		std::vector<Quad> quads;
+		// bounding box of the text's character cells
+		int width = 0;
+		int height = 0;
+	};
+public:
+	BitmapFont();
+	BitmapFont( const BitmapFont& ) = delete;
+	BitmapFont& operator=( const BitmapFont& ) = delete;
+	// lays out text with its top left corner at (0,0), reusing layout's storage so that text
+	// changing every frame doesn't allocate; '\n' starts a new line, and characters the font
+	// doesn't have come out as '?'
+	void Layout( const std::string& text,TextLayout& layout ) const;
+	// layout of text that stays the same from frame to frame (labels, help), made on first use
+	// and kept; references stay valid until ClearCache
+	const TextLayout& GetCached( const std::string& text );
+	void ClearCache();
+	const Surface& GetAtlas() const
+	{
+		return atlas;
+	}
+public:
+	static constexpr int GlyphWidth = 5;
+	static constexpr int GlyphHeight = 8;
+	// width of a glyph's cell in the atlas, and of its quads
+	static constexpr int CellWidth = 8;
+	// glyph plus spacing, across and down
+	static constexpr int Advance = 6;
+	static constexpr int LineHeight = 10;
+private:
+	static constexpr char firstChar = ' ';
+	static constexpr char lastChar = '~';
+	static constexpr unsigned int nGlyphs = lastChar - firstChar + 1;
+	Surface atlas;
+	// whether each glyph has any pixels set
+	bool blank[nGlyphs];
+	std::unordered_map<std::string,TextLayout> cache;
+};
@@ -0,0 +1,157 @@
+/******************************************************************************************
+*	Chili DirectX Framework Version 16.10.01											  *
+*	CaptureQueue.cpp																	  *
+*	Copyright 2016 PlanetChili <http://www.planetchili.net>								  *
+*																						  *
+*	This file is part of The Chili DirectX Framework.									  *
+*																						  *
+*	The Chili DirectX Framework is free software: you can redistribute it and/or modify	  *
+*	it under the terms of the GNU General Public License as published by				  *
+*	the Free Software Foundation, either version 3 of the License, or					  *
+*	(at your option) any later version.													  *
+*																						  *
+*	The Chili DirectX Framework is distributed in the hope that it will be useful,		  *
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of						  *
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the						  *
+*	GNU General Public License for more details.										  *
+*																						  *
+*	You should have received a copy of the GNU General Public License					  *
+*	along with The Chili DirectX Framework.  If not, see <http://www.gnu.org/licenses/>.  *
+******************************************************************************************/
+#include "CaptureQueue.h"
+#include "Profiler.h"
+
+CaptureQueue::CaptureQueue( unsigned int nWorkers,unsigned int poolSize )
+	:
+	buffers( poolSize )
+{
+	assert( nWorkers > 0u );
+	assert( poolSize > 0u );
+	for( size_t i = 0u; i < poolSize; i++ )
+	{
+		freeBuffers.push_back( i );
+	}
+	for( unsigned int i = 0u; i < nWorkers; i++ )
+	{
+		workers.emplace_back( &CaptureQueue::SaveLoop,this );
+	}
+}
+
+CaptureQueue::~CaptureQueue()
+{
+	{
+		std::lock_guard<std::mutex> lock( mtx );
+		stopping = true;
+	}
+	cv.notify_all();
+	for( std::thread& worker : workers )
+	{
+		worker.join();
+	}
+}
+
+bool CaptureQueue::Submit( const Surface& surface,std::wstring filename )
+{
+	CHILI_PROFILE_ZONE( "CaptureQueue::Submit" );
+	size_t i;
+	{
+		std::lock_guard<std::mutex> lock( mtx );
+		stats.submitted++;
+		if( freeBuffers.empty() )
+		{
+			stats.dropped++;
+			return false;
+		}
+		i = freeBuffers.back();
+		freeBuffers.pop_back();
+	}
+	// the buffer is ours until it is queued, so copy without holding the lock
+	std::unique_ptr<Surface>& pBuffer = buffers[i];
+	if( !pBuffer || !Matches( *pBuffer,surface ) )
+	{
+		pBuffer = surface.GetLayout() == Surface::Layout::Tiled ?
+			std::make_unique<Surface>( surface.GetWidth(),surface.GetHeight(),Surface::Layout::Tiled ) :
+			std::make_unique<Surface>( surface.GetWidth(),surface.GetHeight(),surface.GetPitch() );
+	}
+	pBuffer->Copy( surface );
+	{
+		std::lock_guard<std::mutex> lock( mtx );
+		queue.push_back( { i,std::move( filename ) } );
+	}
+	cv.notify_one();
+	return true;
+}
+
+void CaptureQueue::Flush()
+{
+	std::unique_lock<std::mutex> lock( mtx );
+	idle.wait( lock,[this]() { return queue.empty() && nSaving == 0u; } );
+}
+
+CaptureQueue::Stats CaptureQueue::GetStats() const
+{
+	std::lock_guard<std::mutex> lock( mtx );
+	return stats;
+}
+
+std::wstring CaptureQueue::GetLastError() const
+{
+	std::lock_guard<std::mutex> lock( mtx );
+	return lastError;
+}
+
+void CaptureQueue::SaveLoop()
+{
+	std::unique_lock<std::mutex> lock( mtx );
+	while( true )
+	{
+		cv.wait( lock,[this]() { return !queue.empty() || stopping; } );
+		if( queue.empty() )
+		{
+			// stopping and everything has been saved
+			return;
+		}
+		const Capture capture = std::move( queue.front() );
+		queue.pop_front();
+		nSaving++;
+		lock.unlock();
+
+		std::wstring error;
+		try
+		{
+			CHILI_PROFILE_ZONE( "CaptureQueue::Save" );
+			buffers[capture.buffer]->Save( capture.filename );
+		}
+		catch( const ChiliException& e )
+		{
+			error = e.GetFullMessage();
+		}
+		catch( ... )
+		{
+			error = L"Saving surface to [" + capture.filename + L"]: unexpected error.";
+		}
+
+		lock.lock();
+		nSaving--;
+		if( error.empty() )
+		{
+			stats.saved++;
+		}
+		else
+		{
+			stats.failed++;
+			lastError = std::move( error );
+		}
+		freeBuffers.push_back( capture.buffer );
+		if( queue.empty() && nSaving == 0u )
+		{
+			idle.notify_all();
+		}
+	}
+}
+
+bool CaptureQueue::Matches( const Surface& buffer,const Surface& surface )
+{
+	return buffer.GetWidth() == surface.GetWidth() && buffer.GetHeight() == surface.GetHeight() &&
+		buffer.GetPitch() == surface.GetPitch() && buffer.GetLayout() == surface.GetLayout();
+}
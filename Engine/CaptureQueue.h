@@ -0,0 +1,83 @@
+/******************************************************************************************
+*	Chili DirectX Framework Version 16.10.01											  *
+*	CaptureQueue.h																		  *
+*	Copyright 2016 PlanetChili <http://www.planetchili.net>								  *
+*																						  *
+*	This file is part of The Chili DirectX Framework.									  *
+*																						  *
+*	The Chili DirectX Framework is free software: you can redistribute it and/or modify	  *
+*	it under the terms of the GNU General Public License as published by				  *
+*	the Free Software Foundation, either version 3 of the License, or					  *
+*	(at your option) any later version.													  *
+*																						  *
+*	The Chili DirectX Framework is distributed in the hope that it will be useful,		  *
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of						  *
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the						  *
+*	GNU General Public License for more details.										  *
+*																						  *
+*	You should have received a copy of the GNU General Public License					  *
+*	along with The Chili DirectX Framework.  If not, see <http://www.gnu.org/licenses/>.  *
+******************************************************************************************/
+#pragma once
+
+#include "Surface.h"
+#include <memory>
+#include <vector>
+#include <deque>
+#include <string>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+// saves surfaces (Surface::Save) on background threads, so capturing every frame doesn't
+// hold up the caller: Submit only copies the surface into a pooled buffer, a single memcpy
+// once the pool matches the surface's layout and pitch
+// when every buffer is still waiting to be saved the capture is dropped rather than waited on
+class CaptureQueue
+{
+public:
+	struct Stats
+	{
+		unsigned long long submitted = 0u;
+		// not queued because every buffer was busy
+		unsigned long long dropped = 0u;
+		unsigned long long saved = 0u;
+		unsigned long long failed = 0u;
+	};
+public:
+	CaptureQueue( unsigned int nWorkers = 2u,unsigned int poolSize = 8u );
+	CaptureQueue( const CaptureQueue& ) = delete;
+	CaptureQueue& operator=( const CaptureQueue& ) = delete;
+	// saves everything still queued before returning
+	~CaptureQueue();
+	// false if the capture was dropped
+	bool Submit( const Surface& surface,std::wstring filename );
+	// block until everything queued has been saved
+	void Flush();
+	Stats GetStats() const;
+	// message of the most recent failed save, empty if there hasn't been one
+	std::wstring GetLastError() const;
+private:
+	void SaveLoop();
+	static bool Matches( const Surface& buffer,const Surface& surface );
+private:
+	struct Capture
+	{
+		size_t buffer;
+		std::wstring filename;
+	};
+	// allocated on first use by Submit, to match the surfaces handed to it
+	std::vector<std::unique_ptr<Surface>> buffers;
+	// indices into buffers
+	std::vector<size_t> freeBuffers;
+	std::deque<Capture> queue;
+	unsigned int nSaving = 0u;
+	bool stopping = false;
+	Stats stats;
+	std::wstring lastError;
+	mutable std::mutex mtx;
+	// workers wait on cv for queued captures, Flush waits on idle for the queue to drain
+	std::condition_variable cv;
+	std::condition_variable idle;
+	std::vector<std::thread> workers;
+};
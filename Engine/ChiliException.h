@@ -21,6 +21,12 @@
 #pragma once
 #include <string>
 
+// wide string literal of a narrow one, for __FILE__; msvc's crt defines this, others don't
+#ifndef _CRT_WIDE
+#define _CRT_WIDE_( s ) L ## s
+#define _CRT_WIDE( s ) _CRT_WIDE_( s )
+#endif
+
 class ChiliException
 {
 public:
@@ -38,4 +38,23 @@ inline T wrap_angle( T theta )
 	return (modded > (T)PI_D) ?
 		(modded - (T)2.0 * (T)PI_D) :
 		modded;
-}
\ No newline at end of file
+}
+
+// linear interpolation from a to b; alpha of 0 gives a, 1 gives b
+template<typename T>
+inline T interpolate( const T& a,const T& b,float alpha )
+{
+	return a + (b - a) * alpha;
+}
+
+// interpolate between two wrapped angles along the shorter arc
+template<typename T>
+inline T interpolate_angle( T a,T b,float alpha )
+{
+	T delta = wrap_angle( b - a );
+	if( delta < -(T)PI_D )
+	{
+		delta += (T)2.0 * (T)PI_D;
+	}
+	return wrap_angle( a + delta * (T)alpha );
+}
@@ -0,0 +1,75 @@
+/******************************************************************************************
+*	Chili DirectX Framework Version 16.10.01											  *
+*	D3DPresenter.h																		  *
+*	Copyright 2016 PlanetChili <http://www.planetchili.net>								  *
+*																						  *
+*	This file is part of The Chili DirectX Framework.									  *
+*																						  *
+*	The Chili DirectX Framework is free software: you can redistribute it and/or modify	  *
+*	it under the terms of the GNU General Public License as published by				  *
+*	the Free Software Foundation, either version 3 of the License, or					  *
+*	(at your option) any later version.													  *
+*																						  *
+*	The Chili DirectX Framework is distributed in the hope that it will be useful,		  *
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of						  *
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the						  *
+*	GNU General Public License for more details.										  *
+*																						  *
+*	You should have received a copy of the GNU General Public License					  *
+*	along with The Chili DirectX Framework.  If not, see <http://www.gnu.org/licenses/>.  *
+******************************************************************************************/
+#pragma once
+#include <d3d11.h>
+#include <wrl.h>
+#include "GDIPlusManager.h"
+#include "ChiliException.h"
+#include "Presenter.h"
+
+#define CHILI_GFX_EXCEPTION( hr,note ) D3DPresenter::Exception( hr,note,_CRT_WIDE(__FILE__),__LINE__ )
+
+// presents frames to a window through a dynamic D3D11 texture drawn as a fullscreen quad
+// Map hands out the mapped texture memory itself, so Graphics can render into it directly
+class D3DPresenter : public Presenter
+{
+public:
+	class Exception : public ChiliException
+	{
+	public:
+		Exception( HRESULT hr,const std::wstring& note,const wchar_t* file,unsigned int line );
+		std::wstring GetErrorName() const;
+		std::wstring GetErrorDescription() const;
+		virtual std::wstring GetFullMessage() const override;
+		virtual std::wstring GetExceptionType() const override;
+	private:
+		HRESULT hr;
+	};
+private:
+	// vertex format for the framebuffer fullscreen textured quad
+	struct FSQVertex
+	{
+		float x,y,z;		// position
+		float u,v;			// texcoords
+	};
+public:
+	D3DPresenter( class HWNDKey& key );
+	D3DPresenter( const D3DPresenter& ) = delete;
+	D3DPresenter& operator=( const D3DPresenter& ) = delete;
+	~D3DPresenter();
+	Surface Map() override;
+	void Unmap() override;
+	void Present() override;
+private:
+	GDIPlusManager										gdipMan;
+	Microsoft::WRL::ComPtr<IDXGISwapChain>				pSwapChain;
+	Microsoft::WRL::ComPtr<ID3D11Device>				pDevice;
+	Microsoft::WRL::ComPtr<ID3D11DeviceContext>			pImmediateContext;
+	Microsoft::WRL::ComPtr<ID3D11RenderTargetView>		pRenderTargetView;
+	Microsoft::WRL::ComPtr<ID3D11Texture2D>				pSysBufferTexture;
+	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView>	pSysBufferTextureView;
+	Microsoft::WRL::ComPtr<ID3D11PixelShader>			pPixelShader;
+	Microsoft::WRL::ComPtr<ID3D11VertexShader>			pVertexShader;
+	Microsoft::WRL::ComPtr<ID3D11Buffer>				pVertexBuffer;
+	Microsoft::WRL::ComPtr<ID3D11InputLayout>			pInputLayout;
+	Microsoft::WRL::ComPtr<ID3D11SamplerState>			pSamplerState;
+	D3D11_MAPPED_SUBRESOURCE							mappedSysBufferTexture;
+};
\ No newline at end of file
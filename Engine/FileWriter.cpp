@@ -0,0 +1,80 @@
+/******************************************************************************************
+*	Chili DirectX Framework Version 16.10.01											  *
+*	FileWriter.cpp																		  *
+*	Copyright 2016 PlanetChili <http://www.planetchili.net>								  *
+*																						  *
+*	This file is part of The Chili DirectX Framework.									  *
+*																						  *
+*	The Chili DirectX Framework is free software: you can redistribute it and/or modify	  *
+*	it under the terms of the GNU General Public License as published by				  *
+*	the Free Software Foundation, either version 3 of the License, or					  *
+*	(at your option) any later version.													  *
+*																						  *
+*	The Chili DirectX Framework is distributed in the hope that it will be useful,		  *
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of						  *
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the						  *
+*	GNU General Public License for more details.										  *
+*																						  *
+*	You should have received a copy of the GNU General Public License					  *
+*	along with The Chili DirectX Framework.  If not, see <http://www.gnu.org/licenses/>.  *
+******************************************************************************************/
+#include "FileWriter.h"
+#include "Utf8.h"
+#include <cstring>
+
+FileWriter::FileWriter( const std::wstring& filename,size_t bufferSize )
+	:
+	buffer( bufferSize )
+{
+#ifdef _WIN32
+	if( _wfopen_s( &pFile,filename.c_str(),L"wb" ) != 0 )
+	{
+		pFile = nullptr;
+	}
+#else
+	pFile = fopen( ToUtf8( filename ).c_str(),"wb" );
+#endif
+	if( pFile != nullptr )
+	{
+		// we do our own buffering
+		setvbuf( pFile,nullptr,_IONBF,0 );
+	}
+}
+
+FileWriter::~FileWriter()
+{
+	if( pFile != nullptr )
+	{
+		Flush();
+		fclose( pFile );
+	}
+}
+
+void FileWriter::Write( const void* pData,size_t size )
+{
+	if( !*this )
+	{
+		return;
+	}
+	if( size > buffer.size() - used )
+	{
+		Flush();
+		// too big to be worth copying through the buffer
+		if( size >= buffer.size() )
+		{
+			failed = fwrite( pData,1u,size,pFile ) != size;
+			return;
+		}
+	}
+	memcpy( buffer.data() + used,pData,size );
+	used += size;
+}
+
+void FileWriter::Flush()
+{
+	if( used != 0u && !failed )
+	{
+		failed = fwrite( buffer.data(),1u,used,pFile ) != used;
+	}
+	used = 0u;
+}
@@ -0,0 +1,51 @@
+/******************************************************************************************
+*	Chili DirectX Framework Version 16.10.01											  *
+*	FileWriter.h																		  *
+*	Copyright 2016 PlanetChili <http://www.planetchili.net>								  *
+*																						  *
+*	This file is part of The Chili DirectX Framework.									  *
+*																						  *
+*	The Chili DirectX Framework is free software: you can redistribute it and/or modify	  *
+*	it under the terms of the GNU General Public License as published by				  *
+*	the Free Software Foundation, either version 3 of the License, or					  *
+*	(at your option) any later version.													  *
+*																						  *
+*	The Chili DirectX Framework is distributed in the hope that it will be useful,		  *
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of						  *
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the						  *
+*	GNU General Public License for more details.										  *
+*																						  *
+*	You should have received a copy of the GNU General Public License					  *
+*	along with The Chili DirectX Framework.  If not, see <http://www.gnu.org/licenses/>.  *
+******************************************************************************************/
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdio>
+
+// buffered binary output to a (wide named) file, so many small writes cost one system call
+// per bufferSize bytes; like std::ofstream, check it with operator bool after writing
+class FileWriter
+{
+public:
+	explicit FileWriter( const std::wstring& filename,size_t bufferSize = defaultBufferSize );
+	FileWriter( const FileWriter& ) = delete;
+	FileWriter& operator=( const FileWriter& ) = delete;
+	// flushes and closes
+	~FileWriter();
+	// false if the file couldn't be opened or any write so far failed
+	explicit operator bool() const
+	{
+		return pFile != nullptr && !failed;
+	}
+	void Write( const void* pData,size_t size );
+	void Flush();
+public:
+	static constexpr size_t defaultBufferSize = 1u << 20;
+private:
+	FILE* pFile = nullptr;
+	std::vector<unsigned char> buffer;
+	size_t used = 0u;
+	bool failed = false;
+};
@@ -0,0 +1,121 @@
+/******************************************************************************************
+*	Chili DirectX Framework Version 16.10.01											  *
+*	FrameArena.cpp																		  *
+*	Copyright 2016 PlanetChili <http://www.planetchili.net>								  *
+*																						  *
+*	This file is part of The Chili DirectX Framework.									  *
+*																						  *
+*	The Chili DirectX Framework is free software: you can redistribute it and/or modify	  *
+*	it under the terms of the GNU General Public License as published by				  *
+*	the Free Software Foundation, either version 3 of the License, or					  *
+*	(at your option) any later version.													  *
+*																						  *
+*	The Chili DirectX Framework is distributed in the hope that it will be useful,		  *
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of						  *
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the						  *
+*	GNU General Public License for more details.										  *
+*																						  *
+*	You should have received a copy of the GNU General Public License					  *
+*	along with The Chili DirectX Framework.  If not, see <http://www.gnu.org/licenses/>.  *
+******************************************************************************************/
+#include "FrameArena.h"
+#include <algorithm>
+#include <new>
+#include <cstdint>
+#include <cstdlib>
+#include <assert.h>
+#ifdef _MSC_VER
+#include <malloc.h>
+#endif
+
+FrameArena::FrameArena( size_t capacity )
+	:
+	capacity( capacity )
+{
+	blocks.push_back( AllocateBlock( capacity ) );
+	pNext = blocks.front();
+	pEnd = pNext + capacity;
+}
+
+FrameArena::~FrameArena()
+{
+	for( unsigned char* pBlock : blocks )
+	{
+		FreeBlock( pBlock );
+	}
+}
+
+void* FrameArena::Allocate( size_t size,size_t alignment )
+{
+	assert( alignment != 0u && (alignment & (alignment - 1u)) == 0u );
+	assert( alignment <= maxAlignment );
+	size_t padding = (alignment - reinterpret_cast<uintptr_t>( pNext ) % alignment) % alignment;
+	if( padding + size > size_t( pEnd - pNext ) )
+	{
+		// spill into a new block, which is aligned to maxAlignment
+		const size_t blockSize = std::max( size,capacity );
+		blocks.push_back( AllocateBlock( blockSize ) );
+		pNext = blocks.back();
+		pEnd = pNext + blockSize;
+		padding = 0u;
+	}
+	unsigned char* const p = pNext + padding;
+	pNext = p + size;
+	used += padding + size;
+	return p;
+}
+
+void FrameArena::Reset()
+{
+	peak = std::max( peak,used );
+	if( blocks.size() > 1u )
+	{
+		// the frame didn't fit: trade the spill blocks for one block that holds it all
+		for( unsigned char* pBlock : blocks )
+		{
+			FreeBlock( pBlock );
+		}
+		blocks.clear();
+		capacity = std::max( capacity * 2u,used );
+		blocks.push_back( AllocateBlock( capacity ) );
+		nGrowths++;
+	}
+	pNext = blocks.front();
+	pEnd = pNext + capacity;
+	used = 0u;
+}
+
+FrameArena::Stats FrameArena::GetStats() const
+{
+	Stats stats;
+	stats.capacity = capacity;
+	stats.used = used;
+	stats.peak = std::max( peak,used );
+	stats.nGrowths = nGrowths;
+	return stats;
+}
+
+unsigned char* FrameArena::AllocateBlock( size_t size )
+{
+	// whole alignment blocks, as aligned_alloc requires
+	const size_t nBytes = std::max( (size + maxAlignment - 1u) / maxAlignment * maxAlignment,maxAlignment );
+#ifdef _MSC_VER
+	void* const p = _aligned_malloc( nBytes,maxAlignment );
+#else
+	void* const p = aligned_alloc( maxAlignment,nBytes );
+#endif
+	if( p == nullptr )
+	{
+		throw std::bad_alloc();
+	}
+	return static_cast<unsigned char*>( p );
+}
+
+void FrameArena::FreeBlock( unsigned char* pBlock )
+{
+#ifdef _MSC_VER
+	_aligned_free( pBlock );
+#else
+	free( pBlock );
+#endif
+}
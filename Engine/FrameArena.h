@@ -0,0 +1,79 @@
+/******************************************************************************************
+*	Chili DirectX Framework Version 16.10.01											  *
+*	FrameArena.h																		  *
+*	Copyright 2016 PlanetChili <http://www.planetchili.net>								  *
+*																						  *
+*	This file is part of The Chili DirectX Framework.									  *
+*																						  *
+*	The Chili DirectX Framework is free software: you can redistribute it and/or modify	  *
+*	it under the terms of the GNU General Public License as published by				  *
+*	the Free Software Foundation, either version 3 of the License, or					  *
+*	(at your option) any later version.													  *
+*																						  *
+*	The Chili DirectX Framework is distributed in the hope that it will be useful,		  *
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of						  *
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the						  *
+*	GNU General Public License for more details.										  *
+*																						  *
+*	You should have received a copy of the GNU General Public License					  *
+*	along with The Chili DirectX Framework.  If not, see <http://www.gnu.org/licenses/>.  *
+******************************************************************************************/
+#pragma once
+
+#include <vector>
+#include <type_traits>
+#include <cstddef>
+
+// linear allocator for scratch data that only lives until the end of the frame (transformed
+// vertices, index lists...): Allocate bumps an offset and Reset rewinds it, nothing is freed
+// or destroyed individually, so it only hands out trivially destructible types
+// a frame that outgrows the block spills into extra heap blocks; the next Reset replaces them
+// with a single block big enough for that frame, so once warmed up nothing is allocated
+// not thread safe: allocate from one thread (workers may fill what it handed out)
+class FrameArena
+{
+public:
+	struct Stats
+	{
+		size_t capacity = 0u;
+		// bytes handed out since the last Reset, alignment padding included
+		size_t used = 0u;
+		// most used in any frame
+		size_t peak = 0u;
+		// times a frame didn't fit and the block had to grow
+		unsigned int nGrowths = 0u;
+	};
+public:
+	explicit FrameArena( size_t capacity = defaultCapacity );
+	FrameArena( const FrameArena& ) = delete;
+	FrameArena& operator=( const FrameArena& ) = delete;
+	~FrameArena();
+	// alignment must be a power of two no greater than maxAlignment
+	void* Allocate( size_t size,size_t alignment = alignof( std::max_align_t ) );
+	// uninitialized storage for count T
+	template<typename T>
+	T* Allocate( size_t count )
+	{
+		static_assert( std::is_trivially_destructible<T>::value,"FrameArena never runs destructors" );
+		return static_cast<T*>( Allocate( sizeof( T ) * count,alignof( T ) ) );
+	}
+	// invalidates everything allocated since the last Reset
+	void Reset();
+	Stats GetStats() const;
+public:
+	static constexpr size_t defaultCapacity = 1u << 20;
+	static constexpr size_t maxAlignment = 64u;
+private:
+	static unsigned char* AllocateBlock( size_t size );
+	static void FreeBlock( unsigned char* pBlock );
+private:
+	// every block, the first being the one kept between frames
+	std::vector<unsigned char*> blocks;
+	size_t capacity;
+	// free space in the last block
+	unsigned char* pNext;
+	unsigned char* pEnd;
+	size_t used = 0u;
+	size_t peak = 0u;
+	unsigned int nGrowths = 0u;
+};
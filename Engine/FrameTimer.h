@@ -0,0 +1,36 @@
+/******************************************************************************************
+*	Chili DirectX Framework Version 16.10.01											  *
+*	FrameTimer.h																		  *
+*	Copyright 2016 PlanetChili <http://www.planetchili.net>								  *
+*																						  *
+*	This file is part of The Chili DirectX Framework.									  *
+*																						  *
+*	The Chili DirectX Framework is free software: you can redistribute it and/or modify	  *
+*	it under the terms of the GNU General Public License as published by				  *
+*	the Free Software Foundation, either version 3 of the License, or					  *
+*	(at your option) any later version.													  *
+*																						  *
+*	The Chili DirectX Framework is distributed in the hope that it will be useful,		  *
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of						  *
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the						  *
+*	GNU General Public License for more details.										  *
+*																						  *
+*	You should have received a copy of the GNU General Public License					  *
+*	along with The Chili DirectX Framework.  If not, see <http://www.gnu.org/licenses/>.  *
+******************************************************************************************/
+#pragma once
+
+#include <chrono>
+
+// steady-clock timer for measuring time between frames
+class FrameTimer
+{
+public:
+	FrameTimer();
+	// seconds elapsed since the previous Mark (or construction)
+	float Mark();
+	// seconds elapsed since the previous Mark, without resetting it
+	float Peek() const;
+private:
+	std::chrono::steady_clock::time_point last;
+};
@@ -21,61 +21,306 @@
 #include "MainWindow.h"
 #include "Game.h"
 #include "Mat3.h"
+#include "D3DPresenter.h"
+#include "AsyncPresenter.h"
+#include <algorithm>
 
-Game::Game( MainWindow& wnd )
+Game::Game( MainWindow& wnd,Mode mode )
 	:
-	wnd( wnd ),
-	gfx( wnd ),
-	cube( 1.0f )
+	Game( wnd.kbd,wnd.mouse,std::make_unique<AsyncPresenter>( std::make_unique<D3DPresenter>( wnd ),
+		Graphics::ScreenWidth,Graphics::ScreenHeight,frameQueueDepth ),mode )
+{}
+
+Game::Game( Keyboard& kbd,Mouse& mouse,std::unique_ptr<Presenter> pPresenter,Mode mode )
+	:
+	kbd( kbd ),
+	mouse( mouse ),
+	mode( mode ),
+	gfx( std::move( pPresenter ) ),
+	cube( 1.0f ),
+	triangles( cube.GetTriangles() ),
+	resolution( composeBudgetMs,Graphics::ScreenWidth,Graphics::ScreenHeight )
 {
+	gfx.SetJobSystem( &jobs );
+	gfx.SetFrameCallback( [this]( const Surface& frame ) { CaptureFrame( frame ); } );
+	gfx.SetOverlay( [this]( Surface& frame )
+	{
+		if( showHud )
+		{
+			CHILI_PROFILE_ZONE( "PerfHud" );
+			hud.Draw( frame,gfx );
+		}
+	} );
+	if( mode == Mode::RealTime )
+	{
+		// start simulating only once everything it touches is constructed
+		updateThread = std::thread( &Game::UpdateLoop,this );
+	}
+}
+
+Game::~Game()
+{
+	if( updateThread.joinable() )
+	{
+		quitting = true;
+		updateThread.join();
+	}
 }
 
 void Game::Go()
 {
-	gfx.BeginFrame();
+	const float frameMs = frameTimer.Mark() * 1000.0f;
+	{
+		CHILI_PROFILE_ZONE( "Go" );
+		{
+			CHILI_PROFILE_ZONE( "BeginFrame" );
+			gfx.BeginFrame();
+		}
+		SampleControls();
+		// F8 toggles the overdraw heatmap
+		const bool heatmapKeyDown = kbd.KeyIsPressed( VK_F8 );
+		if( heatmapKeyDown && !heatmapKeyWasDown )
+		{
+			showOverdraw = !showOverdraw;
+			gfx.SetOverdrawHeatmap( showOverdraw );
+		}
+		heatmapKeyWasDown = heatmapKeyDown;
+		// F7 shows or hides the performance overlay; its timings differ run to run, so it
+		// never shows in Lockstep mode, whose frames must be reproducible
+		const bool hudKeyDown = kbd.KeyIsPressed( VK_F7 );
+		if( hudKeyDown && !hudKeyWasDown && mode != Mode::Lockstep )
+		{
+			showHud = !showHud;
+		}
+		hudKeyWasDown = hudKeyDown;
+		// F10 toggles saving every frame, F11 saves just the next one
+		const bool captureKeyDown = kbd.KeyIsPressed( VK_F10 );
+		if( captureKeyDown && !captureKeyWasDown )
+		{
+			capturing = !capturing;
+		}
+		captureKeyWasDown = captureKeyDown;
+		const bool screenshotKeyDown = kbd.KeyIsPressed( VK_F11 );
+		if( screenshotKeyDown && !screenshotKeyWasDown )
+		{
+			screenshotPending = true;
+		}
+		screenshotKeyWasDown = screenshotKeyDown;
+		if( mode == Mode::Lockstep )
+		{
+			Step();
+			PublishSnapshot();
+		}
+		{
+			CHILI_PROFILE_ZONE( "ComposeFrame" );
+			const auto start = std::chrono::steady_clock::now();
+			// render the latest published step while the update thread works on the next one
+			ComposeFrame( GetViewState( snapshots.Read() ) );
+			const std::chrono::duration<float,std::milli> cost = std::chrono::steady_clock::now() - start;
+			if( mode == Mode::RealTime && resolution.Update( cost.count() ) )
+			{
+				gfx.SetResolution( resolution.GetWidth(),resolution.GetHeight() );
+			}
+		}
+		PerfHud::FrameTimes times;
+		times.frameMs = frameMs;
+		times.updateMs = updateMs.load( std::memory_order_relaxed );
+		times.transformMs = transformMs;
+		times.rasterMs = rasterMs;
+		times.presentMs = presentMs;
+		hud.AddFrame( times );
+		{
+			CHILI_PROFILE_ZONE( "EndFrame" );
+			const auto start = std::chrono::steady_clock::now();
+			gfx.EndFrame();
+			presentMs = std::chrono::duration<float,std::milli>( std::chrono::steady_clock::now() - start ).count();
+		}
+	}
+	CHILI_PROFILE_FRAME();
+#if CHILI_PROFILE
+	// F9 dumps the recent frames for about:tracing, and each zone's min/avg/p99 over them
+	const bool traceKeyDown = kbd.KeyIsPressed( VK_F9 );
+	if( traceKeyDown && !traceKeyWasDown )
+	{
+		Profiler::WriteTrace( "trace.json" );
+		Profiler::WriteSummary( "trace_summary.txt" );
+	}
+	traceKeyWasDown = traceKeyDown;
+#endif
+}
+
+void Game::SampleControls()
+{
+	const std::pair<unsigned char,Control> bindings[] = {
+		{ 'Q',RotXPos },{ 'W',RotYPos },{ 'E',RotZPos },
+		{ 'A',RotXNeg },{ 'S',RotYNeg },{ 'D',RotZNeg },
+		{ 'R',MoveAway },{ 'F',MoveCloser }
+	};
+	unsigned int pressed = 0u;
+	for( const auto& b : bindings )
+	{
+		if( kbd.KeyIsPressed( b.first ) )
+		{
+			pressed |= b.second;
+		}
+	}
+	controls.store( pressed,std::memory_order_relaxed );
+	// raw motion is drained every frame so movement made before a drag doesn't leak into it
+	const Vei2 rawDelta = mouse.ReadRawDelta();
+	if( mouse.LeftIsPressed() )
+	{
+		dragX.fetch_add( rawDelta.x,std::memory_order_relaxed );
+		dragY.fetch_add( rawDelta.y,std::memory_order_relaxed );
+	}
+	// controls come from key states, so the event buffers are only drained (here, on the
+	// thread that reads input) to keep them from filling up and dropping later events
+	kbd.Flush();
+	mouse.Flush();
+}
+
+void Game::StartVideo( const std::wstring& filename )
+{
+	// one frame per simulation step is what Lockstep produces, and what RealTime aims for
+	pVideo = std::make_unique<VideoCapture>( filename,Graphics::ScreenWidth,Graphics::ScreenHeight,
+		static_cast<unsigned int>( 1.0f / simDt + 0.5f ) );
+}
+
+VideoCapture::Stats Game::StopVideo()
+{
+	assert( pVideo );
+	pVideo->Flush();
+	const VideoCapture::Stats stats = pVideo->GetStats();
+	pVideo.reset();
+	return stats;
+}
+
+void Game::CaptureFrame( const Surface& frame )
+{
+	if( screenshotPending )
+	{
+		screenshotPending = false;
+		capture.Submit( frame,L"screenshot_" + std::to_wstring( nScreenshots++ ) + L".bmp" );
+	}
+	if( capturing )
+	{
+		// numbered by frame, so frames the queue had to drop show up as gaps
+		std::wstring number = std::to_wstring( nCaptureFrames++ );
+		number.insert( 0u,number.size() < 6u ? 6u - number.size() : 0u,L'0' );
+		capture.Submit( frame,L"capture_" + number + L".qoi" );
+	}
+	if( pVideo )
+	{
+		pVideo->Submit( frame );
+	}
+}
+
+void Game::UpdateLoop()
+{
+	FrameTimer ft;
+	float accumulator = 0.0f;
+	while( !quitting )
+	{
+		accumulator += std::min( ft.Mark(),float( maxFrameTime ) );
+		// zero or more fixed steps, depending on how much time has passed
+		bool stepped = false;
+		while( accumulator >= simDt )
+		{
+			Step();
+			accumulator -= simDt;
+			stepped = true;
+		}
+		if( stepped )
+		{
+			PublishSnapshot();
+		}
+		// nothing to do until the next step is due
+		std::this_thread::sleep_for( std::chrono::duration<float>( simDt - accumulator ) );
+	}
+}
+
+void Game::Step()
+{
+	CHILI_PROFILE_ZONE( "UpdateModel" );
+	const auto start = std::chrono::steady_clock::now();
+	prevState = state;
 	UpdateModel();
-	ComposeFrame();
-	gfx.EndFrame();
+	const std::chrono::duration<float,std::milli> cost = std::chrono::steady_clock::now() - start;
+	updateMs.store( cost.count(),std::memory_order_relaxed );
+}
+
+void Game::PublishSnapshot()
+{
+	FrameSnapshot& snapshot = snapshots.GetWriteBuffer();
+	snapshot.prev = prevState;
+	snapshot.cur = state;
+	snapshot.stepTime = std::chrono::steady_clock::now();
+	snapshots.Publish();
 }
 
 void Game::UpdateModel()
 {
-	const float dt = 1.0f / 144.0f;
-	if( wnd.kbd.KeyIsPressed( 'Q' ) )
+	const float dt = simDt;
+	const unsigned int pressed = controls.load( std::memory_order_relaxed );
+	float& theta_x = state.theta_x;
+	float& theta_y = state.theta_y;
+	float& theta_z = state.theta_z;
+	float& offset_z = state.offset_z;
+	if( pressed & RotXPos )
 	{
 		theta_x = wrap_angle( theta_x + dTheta * dt );
 	}
-	if( wnd.kbd.KeyIsPressed( 'W' ) )
+	if( pressed & RotYPos )
 	{
 		theta_y = wrap_angle( theta_y + dTheta * dt );
 	}
-	if( wnd.kbd.KeyIsPressed( 'E' ) )
+	if( pressed & RotZPos )
 	{
 		theta_z = wrap_angle( theta_z + dTheta * dt );
 	}
-	if( wnd.kbd.KeyIsPressed( 'A' ) )
+	if( pressed & RotXNeg )
 	{
 		theta_x = wrap_angle( theta_x - dTheta * dt );
 	}
-	if( wnd.kbd.KeyIsPressed( 'S' ) )
+	if( pressed & RotYNeg )
 	{
 		theta_y = wrap_angle( theta_y - dTheta * dt );
 	}
-	if( wnd.kbd.KeyIsPressed( 'D' ) )
+	if( pressed & RotZNeg )
 	{
 		theta_z = wrap_angle( theta_z - dTheta * dt );
 	}
-	if( wnd.kbd.KeyIsPressed( 'R' ) )
+	if( pressed & MoveAway )
 	{
 		offset_z += 2.0f * dt;
 	}
-	if( wnd.kbd.KeyIsPressed( 'F' ) )
+	if( pressed & MoveCloser )
 	{
 		offset_z -= 2.0f * dt;
 	}
+	// dragging with the left button spins the cube, horizontal motion about y and vertical about x
+	const int dx = dragX.exchange( 0,std::memory_order_relaxed );
+	const int dy = dragY.exchange( 0,std::memory_order_relaxed );
+	if( dx != 0 || dy != 0 )
+	{
+		theta_y = wrap_angle( theta_y - float( dx ) * dragSensitivity );
+		theta_x = wrap_angle( theta_x - float( dy ) * dragSensitivity );
+	}
+}
+
+Game::ModelState Game::GetViewState( const FrameSnapshot& snapshot ) const
+{
+	if( mode == Mode::Lockstep )
+	{
+		// the step was taken for this very frame
+		return snapshot.cur;
+	}
+	// snapshots lag one step behind, so blend from prev towards cur as the next step approaches
+	const std::chrono::duration<float> sinceStep = std::chrono::steady_clock::now() - snapshot.stepTime;
+	const float alpha = std::min( sinceStep.count() / simDt,1.0f );
+	return ModelState::Interpolate( snapshot.prev,snapshot.cur,alpha );
 }
 
-void Game::ComposeFrame()
+void Game::ComposeFrame( const ModelState& view )
 {
 	const Color colors[12] = {
 		Colors::White,
@@ -91,23 +336,43 @@ void Game::ComposeFrame()
 		Colors::Blue,
 		Colors::Cyan
 	};
-	auto triangles = cube.GetTriangles();
-	const Mat3 rot =
-		Mat3::RotationX( theta_x ) *
-		Mat3::RotationY( theta_y ) *
-		Mat3::RotationZ( theta_z );
-	for( auto& v : triangles.vertices )
+	const Mat3 rot = Mat3::RotationXYZ( view.theta_x,view.theta_y,view.theta_z );
+	// onto whatever resolution this frame is drawn at
+	const PubeScreenTransformer pst( gfx.GetWidth(),gfx.GetHeight() );
+	// transformed vertices only live for this frame
+	Vec3* const vertices = gfx.GetFrameArena().Allocate<Vec3>( triangles.vertices.size() );
+	const auto transformStart = std::chrono::steady_clock::now();
+	// vertices are independent; small meshes like the cube stay below the grain and run inline
 	{
-		v *= rot;
-		v += { 0.0f,0.0f,offset_z };
-		pst.Transform( v );
+		CHILI_PROFILE_ZONE( "TransformVertices" );
+		jobs.ParallelFor( 0u,triangles.vertices.size(),[&]( size_t i )
+		{
+			Vec3 v = triangles.vertices[i];
+			v *= rot;
+			v += { 0.0f,0.0f,view.offset_z };
+			pst.Transform( v );
+			vertices[i] = v;
+		},vertexGrain );
 	}
+	const auto rasterStart = std::chrono::steady_clock::now();
+	transformMs = std::chrono::duration<float,std::milli>( rasterStart - transformStart ).count();
 	/* go throuhg each of the 3 indexed vertices to obtain eac of the triangles*/
 	for( auto i = triangles.indices.cbegin(),
 		end = triangles.indices.cend();
 		i != end; std::advance( i,3 ) )
 	{
-		gfx.DrawTriangle( triangles.vertices[*i],triangles.vertices[*std::next( i )],triangles.vertices[*std::next( i,2 )],
+		gfx.DrawTriangle( vertices[*i],vertices[*std::next( i )],vertices[*std::next( i,2 )],
 						  colors[std::distance( triangles.indices.cbegin(),i ) / 3] );
 	}
+	rasterMs = std::chrono::duration<float,std::milli>( std::chrono::steady_clock::now() - rasterStart ).count();
+}
+
+Game::ModelState Game::ModelState::Interpolate( const ModelState& prev,const ModelState& cur,float alpha )
+{
+	ModelState s;
+	s.offset_z = interpolate( prev.offset_z,cur.offset_z,alpha );
+	s.theta_x = interpolate_angle( prev.theta_x,cur.theta_x,alpha );
+	s.theta_y = interpolate_angle( prev.theta_y,cur.theta_y,alpha );
+	s.theta_z = interpolate_angle( prev.theta_z,cur.theta_z,alpha );
+	return s;
 }
\ No newline at end of file
@@ -21,33 +21,155 @@
 #pragma once
 
 #include "Graphics.h"
+#include "Keyboard.h"
+#include "Mouse.h"
 #include "PubeScreenTransformer.h"
 #include "Cube.h"
+#include "FrameTimer.h"
+#include "TripleBuffer.h"
+#include "JobSystem.h"
+#include "CaptureQueue.h"
+#include "VideoCapture.h"
+#include "ResolutionController.h"
+#include "PerfHud.h"
+#include "Profiler.h"
+#include <atomic>
+#include <thread>
+#include <chrono>
 
 class Game
 {
 public:
-	Game( class MainWindow& wnd );
+	// how the simulation is advanced
+	enum class Mode
+	{
+		// on its own thread at a fixed rate, with rendering interpolating between steps
+		RealTime,
+		// one fixed step per frame on the rendering thread, so frames depend only on input
+		Lockstep
+	};
+public:
+	Game( class MainWindow& wnd,Mode mode = Mode::RealTime );
+	// without a window: input comes from kbd and mouse, frames go to pPresenter
+	Game( Keyboard& kbd,Mouse& mouse,std::unique_ptr<Presenter> pPresenter,Mode mode );
 	Game( const Game& ) = delete;
 	Game& operator=( const Game& ) = delete;
+	~Game();
 	void Go();
+	const Graphics& GetGraphics() const
+	{
+		return gfx;
+	}
+	// stream every frame to a .y4m file until StopVideo
+	void StartVideo( const std::wstring& filename );
+	// finishes writing the video and returns how it went
+	VideoCapture::Stats StopVideo();
+private:
+	// everything the simulation advances; the last two states are kept so that
+	// rendering can interpolate between fixed simulation steps
+	struct ModelState
+	{
+		float offset_z = 2.0f;
+		float theta_x = 0.0f;
+		float theta_y = 0.0f;
+		float theta_z = 0.0f;
+		static ModelState Interpolate( const ModelState& prev,const ModelState& cur,float alpha );
+	};
+	// immutable result of a simulation step, handed from the update thread to the render thread
+	struct FrameSnapshot
+	{
+		ModelState prev;
+		ModelState cur;
+		// when cur was produced, for interpolating towards the next step
+		std::chrono::steady_clock::time_point stepTime = std::chrono::steady_clock::now();
+	};
+	// keys driving the model, sampled on the window thread for the update thread
+	enum Control : unsigned int
+	{
+		RotXPos = 1u << 0,
+		RotYPos = 1u << 1,
+		RotZPos = 1u << 2,
+		RotXNeg = 1u << 3,
+		RotYNeg = 1u << 4,
+		RotZNeg = 1u << 5,
+		MoveAway = 1u << 6,
+		MoveCloser = 1u << 7
+	};
 private:
-	void ComposeFrame();
+	void ComposeFrame( const ModelState& view );
 	void UpdateModel();
+	// runs on updateThread in RealTime mode: steps the simulation at a fixed rate and publishes snapshots
+	void UpdateLoop();
+	void Step();
+	void PublishSnapshot();
+	// state to draw this frame, blended between the snapshot's steps in RealTime mode
+	ModelState GetViewState( const FrameSnapshot& snapshot ) const;
+	void SampleControls();
+	// hands the finished frame to the capture queue if a screenshot or capture is on,
+	// and to the video if one is being recorded
+	void CaptureFrame( const Surface& frame );
 	/********************************/
 	/*  User Functions              */
 	/********************************/
 private:
-	MainWindow& wnd;
+	Keyboard& kbd;
+	Mouse& mouse;
+	const Mode mode;
+	// frames in flight between the render thread and the present thread
+	static constexpr unsigned int frameQueueDepth = 3u;
 	Graphics gfx;
+	JobSystem jobs;
+	CaptureQueue capture;
+	std::unique_ptr<VideoCapture> pVideo;
 	/********************************/
 	/*  User Variables              */
-	PubeScreenTransformer pst;
 	Cube cube;
+	// model space, built once; transformed into the frame arena every frame
+	const IndexedTriangleList triangles;
+	// render resolution follows ComposeFrame's cost in RealTime mode; Lockstep frames must be
+	// reproducible, so they stay at full resolution
+	ResolutionController resolution;
+	static constexpr float composeBudgetMs = 8.0f;
+	PerfHud hud;
+	// owned by the rendering thread: frame to frame time, and the stages timed for the hud
+	FrameTimer frameTimer;
+	float transformMs = 0.0f;
+	float rasterMs = 0.0f;
+	float presentMs = 0.0f;
 	static constexpr float dTheta = PI;
-	float offset_z = 2.0f;
-	float theta_x = 0.0f;
-	float theta_y = 0.0f;
-	float theta_z = 0.0f;
+	// radians per raw mouse count
+	static constexpr float dragSensitivity = 0.005f;
+	// fewest vertices worth handing to a worker
+	static constexpr size_t vertexGrain = 1024u;
+	// simulation runs at a fixed rate, independent of render rate
+	static constexpr float simDt = 1.0f / 60.0f;
+	// cap on time simulated per frame, so a long stall doesn't snowball into more updates
+	static constexpr float maxFrameTime = 0.25f;
+	// owned by the update thread (the rendering thread in Lockstep mode)
+	ModelState prevState;
+	ModelState state;
+	// shared between threads
+	std::atomic<unsigned int> controls{ 0u };
+	// raw mouse motion while dragging, not yet applied by UpdateModel
+	std::atomic<int> dragX{ 0 };
+	std::atomic<int> dragY{ 0 };
+	std::atomic<bool> quitting{ false };
+	// cost of the latest simulation step
+	std::atomic<float> updateMs{ 0.0f };
+	TripleBuffer<FrameSnapshot> snapshots;
+	std::thread updateThread;
+	bool showOverdraw = false;
+	bool heatmapKeyWasDown = false;
+	bool showHud = false;
+	bool hudKeyWasDown = false;
+	bool capturing = false;
+	bool captureKeyWasDown = false;
+	bool screenshotPending = false;
+	bool screenshotKeyWasDown = false;
+	unsigned int nScreenshots = 0u;
+	unsigned int nCaptureFrames = 0u;
+#if CHILI_PROFILE
+	bool traceKeyWasDown = false;
+#endif
 	/********************************/
 };
\ No newline at end of file
@@ -0,0 +1,392 @@
+/******************************************************************************************
+*	Chili DirectX Framework Version 16.10.01											  *
+*	GoldenTest.cpp																		  *
+*	Copyright 2016 PlanetChili <http://www.planetchili.net>								  *
+*																						  *
+*	This file is part of The Chili DirectX Framework.									  *
+*																						  *
+*	The Chili DirectX Framework is free software: you can redistribute it and/or modify	  *
+*	it under the terms of the GNU General Public License as published by				  *
+*	the Free Software Foundation, either version 3 of the License, or					  *
+*	(at your option) any later version.													  *
+*																						  *
+*	The Chili DirectX Framework is distributed in the hope that it will be useful,		  *
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of						  *
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the						  *
+*	GNU General Public License for more details.										  *
+*																						  *
+*	You should have received a copy of the GNU General Public License					  *
+*	along with The Chili DirectX Framework.  If not, see <http://www.gnu.org/licenses/>.  *
+******************************************************************************************/
+#include "GoldenTest.h"
+#include "Graphics.h"
+#include "HeadlessPresenter.h"
+#include "PubeScreenTransformer.h"
+#include "Cube.h"
+#include "Mat3.h"
+#include <chrono>
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+#include <vector>
+#include <cmath>
+
+namespace
+{
+	struct Scene
+	{
+		const wchar_t* name;
+		unsigned int nFrames;
+		void( *Draw )( Graphics& gfx,unsigned int frame );
+		// called before each frame's BeginFrame, after the runner has put back full resolution
+		// and the default upscale filter; may be null
+		void( *Setup )( Graphics& gfx,unsigned int frame );
+	};
+
+	const Color palette[] = {
+		Colors::White,Colors::Blue,Colors::Cyan,Colors::Gray,
+		Colors::Green,Colors::Magenta,Colors::LightGray,Colors::Yellow
+	};
+	constexpr unsigned int nColors = sizeof( palette ) / sizeof( *palette );
+
+	// the game's cube, stepped through a spread of orientations
+	void DrawCubeSweep( Graphics& gfx,unsigned int frame )
+	{
+		const float t = float( frame ) * PI / 8.0f;
+		const Mat3 rot = Mat3::RotationX( t ) * Mat3::RotationY( t * 0.7f ) * Mat3::RotationZ( t * 0.3f );
+		const PubeScreenTransformer pst;
+		auto triangles = Cube( 1.0f ).GetTriangles();
+		for( auto& v : triangles.vertices )
+		{
+			v *= rot;
+			v += { 0.0f,0.0f,2.0f };
+			pst.Transform( v );
+		}
+		for( size_t i = 0u; i < triangles.indices.size(); i += 3u )
+		{
+			gfx.DrawTriangle( triangles.vertices[triangles.indices[i]],
+				triangles.vertices[triangles.indices[i + 1u]],
+				triangles.vertices[triangles.indices[i + 2u]],
+				palette[(i / 3u) % nColors] );
+		}
+	}
+
+	// long triangles about a pixel wide, at every angle
+	void DrawSlivers( Graphics& gfx,unsigned int frame )
+	{
+		const Vec2 center = { 320.0f,320.0f };
+		const float width = frame == 0u ? 0.5f : 1.5f;
+		for( unsigned int i = 0u; i < 32u; i++ )
+		{
+			const float angle = float( i ) * PI / 32.0f;
+			const Vec2 dir = { std::cos( angle ),std::sin( angle ) };
+			const Vec2 perp = { -dir.y,dir.x };
+			const Vec2 start = center + dir * 40.0f;
+			const Vec2 end = center + dir * 300.0f;
+			gfx.DrawTriangle( start,end,end + perp * width,palette[i % nColors] );
+		}
+	}
+
+	// triangles sharing edges around a center; any gap or double write along a shared edge
+	// shows up as a changed pixel
+	void DrawFans( Graphics& gfx,unsigned int frame )
+	{
+		// second frame puts the center off the pixel grid
+		const Vec2 center = frame == 0u ? Vec2{ 320.0f,320.0f } : Vec2{ 320.37f,319.61f };
+		const unsigned int nSlices = 24u;
+		for( unsigned int i = 0u; i < nSlices; i++ )
+		{
+			const float a0 = float( i ) * 2.0f * PI / float( nSlices );
+			const float a1 = float( i + 1u ) * 2.0f * PI / float( nSlices );
+			gfx.DrawTriangle( center,
+				center + Vec2{ std::cos( a0 ),std::sin( a0 ) } * 250.0f,
+				center + Vec2{ std::cos( a1 ),std::sin( a1 ) } * 250.0f,
+				palette[i % nColors] );
+		}
+	}
+
+	// triangles hanging over each edge, entirely outside, degenerate, and far larger than the screen
+	void DrawOffscreen( Graphics& gfx,unsigned int frame )
+	{
+		const float w = float( Graphics::ScreenWidth );
+		const float h = float( Graphics::ScreenHeight );
+		if( frame == 0u )
+		{
+			gfx.DrawTriangle( { -100.0f,100.0f },{ 150.0f,50.0f },{ 80.0f,300.0f },Colors::Blue );
+			gfx.DrawTriangle( { w - 150.0f,100.0f },{ w + 120.0f,200.0f },{ w - 50.0f,350.0f },Colors::Green );
+			gfx.DrawTriangle( { 200.0f,-80.0f },{ 400.0f,60.0f },{ 250.0f,120.0f },Colors::Cyan );
+			gfx.DrawTriangle( { 300.0f,h - 60.0f },{ 500.0f,h + 90.0f },{ 200.0f,h + 40.0f },Colors::Magenta );
+			gfx.DrawTriangle( { -300.0f,-300.0f },{ -100.0f,-250.0f },{ -200.0f,-50.0f },Colors::White );
+			gfx.DrawTriangle( { w + 10.0f,h + 10.0f },{ w + 200.0f,h + 20.0f },{ w + 50.0f,h + 300.0f },Colors::White );
+			gfx.DrawTriangle( { 100.0f,100.0f },{ 200.0f,200.0f },{ 300.0f,300.0f },Colors::White );
+		}
+		else
+		{
+			gfx.DrawTriangle( { -5000.0f,-4000.0f },{ 6000.0f,-3000.0f },{ 200.0f,7000.0f },Colors::Gray );
+			gfx.DrawTriangle( { -20.0f,-20.0f },{ w + 20.0f,h * 0.5f },{ -20.0f,h + 20.0f },Colors::Yellow );
+		}
+	}
+
+	// 37 pixels wide, so rows end in a scalar tail after both 4 and 8 pixel steps; color and
+	// alpha change every pixel, and a diagonal pattern of pixels holds the color key
+	Surface MakeSprite( Surface::Layout layout )
+	{
+		Surface sprite( 37u,23u,layout );
+		for( unsigned int y = 0u; y < sprite.GetHeight(); y++ )
+		{
+			for( unsigned int x = 0u; x < sprite.GetWidth(); x++ )
+			{
+				const unsigned char a = static_cast<unsigned char>( x * 13u + y * 29u );
+				sprite.PutPixel( x,y,(x + y) % 7u == 0u ? Color( a,255u,0u,255u ) :
+					Color( a,static_cast<unsigned char>( x * 7u ),static_cast<unsigned char>( y * 11u ),
+						static_cast<unsigned char>( x * y ) ) );
+			}
+		}
+		return sprite;
+	}
+
+	// a row of blits per blend mode over the fans: whole sprites hanging off every screen edge,
+	// narrow source rectangles (1 to 13 pixels) and blits cut by a clip rectangle of odd width
+	// the second frame blits a tiled copy of the sprite, the unclipped ones through DrawSprites
+	void DrawBlits( Graphics& gfx,unsigned int frame )
+	{
+		static const Surface linearSprite = MakeSprite( Surface::Layout::Linear );
+		static const Surface tiledSprite = MakeSprite( Surface::Layout::Tiled );
+		const Surface& sprite = frame == 0u ? linearSprite : tiledSprite;
+		const Surface::BlendMode modes[] = {
+			Surface::BlendMode::Opaque,Surface::BlendMode::ColorKey,
+			Surface::BlendMode::Alpha,Surface::BlendMode::Tint
+		};
+		const int w = int( Graphics::ScreenWidth );
+		const int h = int( Graphics::ScreenHeight );
+		const RectI whole = { 0,int( sprite.GetHeight() ),0,int( sprite.GetWidth() ) };
+
+		DrawFans( gfx,0u );
+		std::vector<Graphics::Sprite> batch;
+		for( int i = 0; i < 4; i++ )
+		{
+			const Surface::BlendMode mode = modes[i];
+			// ColorKey skips the key; Tint uses it as the tint color
+			const Color key = mode == Surface::BlendMode::Tint ? Colors::Yellow : Colors::Magenta;
+			const int y = 40 + i * 150;
+			const auto blit = [&]( int x,int y,const RectI& srcRect )
+			{
+				if( frame == 0u )
+				{
+					gfx.DrawSprite( x,y,srcRect,sprite,mode,key );
+				}
+				else
+				{
+					batch.push_back( { x,y,srcRect,&sprite,mode,key } );
+				}
+			};
+			blit( -11,y,whole );
+			blit( 60,y,whole );
+			blit( w - 20,y + 30,whole );
+			blit( 60 + i * 150,-9,whole );
+			blit( 60 + i * 150,h - 10,whole );
+			int x = 120;
+			for( int width : { 1,3,5,13 } )
+			{
+				blit( x,y,{ 2,21,5,5 + width } );
+				x += width + 6;
+			}
+			// clip of 31 pixels, narrower than the sprite and not aligned to 4 or 8
+			const RectI clip = { y + 3,y + 18,203,234 };
+			for( int offset : { -6,0,9 } )
+			{
+				gfx.DrawSprite( 200 + offset * 3,y + offset,whole,clip,sprite,mode,key );
+			}
+		}
+		if( !batch.empty() )
+		{
+			gfx.DrawSprites( batch );
+		}
+	}
+
+	// odd sizes, so the scale steps are fractions and the last row and column of taps are clamped
+	const struct
+	{
+		unsigned int width;
+		unsigned int height;
+	} upscaleSizes[] = { { 213u,161u },{ 457u,331u } };
+
+	// each size through nearest and then bilinear upscaling
+	void SetUpscale( Graphics& gfx,unsigned int frame )
+	{
+		gfx.SetResolution( upscaleSizes[frame / 2u].width,upscaleSizes[frame / 2u].height );
+		gfx.SetUpscaleFilter( frame % 2u == 0u ? SurfaceScaler::Filter::Nearest : SurfaceScaler::Filter::Bilinear );
+	}
+
+	// fans and sprites fitted to the reduced render size; hard edges and per pixel gradients
+	// both show where the upscale puts its taps
+	void DrawUpscale( Graphics& gfx,unsigned int frame )
+	{
+		static const Surface sprite = MakeSprite( Surface::Layout::Linear );
+		const float w = float( gfx.GetWidth() );
+		const float h = float( gfx.GetHeight() );
+		const Vec2 center = { w * 0.5f,h * 0.5f };
+		const float radius = std::min( w,h ) * 0.45f;
+		const unsigned int nSlices = 16u;
+		for( unsigned int i = 0u; i < nSlices; i++ )
+		{
+			const float a0 = float( i ) * 2.0f * PI / float( nSlices );
+			const float a1 = float( i + 1u ) * 2.0f * PI / float( nSlices );
+			gfx.DrawTriangle( center,
+				center + Vec2{ std::cos( a0 ),std::sin( a0 ) } * radius,
+				center + Vec2{ std::cos( a1 ),std::sin( a1 ) } * radius,
+				palette[i % nColors] );
+		}
+		const RectI whole = { 0,int( sprite.GetHeight() ),0,int( sprite.GetWidth() ) };
+		gfx.DrawSprite( 3,5,whole,sprite );
+		gfx.DrawSprite( int( gfx.GetWidth() ) - 30,int( gfx.GetHeight() ) - 17,whole,sprite,
+			Surface::BlendMode::Alpha );
+	}
+
+	const Scene scenes[] = {
+		{ L"cube_sweep",16u,DrawCubeSweep },
+		{ L"slivers",2u,DrawSlivers },
+		{ L"fans",2u,DrawFans },
+		{ L"offscreen",2u,DrawOffscreen },
+		{ L"blits",2u,DrawBlits },
+		{ L"upscale",4u,DrawUpscale,SetUpscale }
+	};
+
+	struct Diff
+	{
+		unsigned int nPixels = 0u;
+		unsigned int maxDelta = 0u;
+		unsigned int left = ~0u;
+		unsigned int top = ~0u;
+		unsigned int right = 0u;
+		unsigned int bottom = 0u;
+	};
+
+	// compares color channels only; the unused top byte is not part of the image
+	Diff Compare( const Surface& actual,const Surface& golden,Surface& diffImage )
+	{
+		Diff diff;
+		for( unsigned int y = 0u; y < actual.GetHeight(); y++ )
+		{
+			for( unsigned int x = 0u; x < actual.GetWidth(); x++ )
+			{
+				const Color a = actual.GetPixel( x,y );
+				const Color g = golden.GetPixel( x,y );
+				const int delta = std::max( {
+					std::abs( int( a.GetR() ) - int( g.GetR() ) ),
+					std::abs( int( a.GetG() ) - int( g.GetG() ) ),
+					std::abs( int( a.GetB() ) - int( g.GetB() ) ) } );
+				if( delta == 0 )
+				{
+					// matching pixels are shown dimmed so the differences stand out
+					const unsigned char lum = static_cast<unsigned char>( (g.GetR() + g.GetG() + g.GetB()) / 12 );
+					diffImage.PutPixel( x,y,{ lum,lum,lum } );
+					continue;
+				}
+				diffImage.PutPixel( x,y,Colors::Magenta );
+				diff.nPixels++;
+				diff.maxDelta = std::max( diff.maxDelta,static_cast<unsigned int>( delta ) );
+				diff.left = std::min( diff.left,x );
+				diff.top = std::min( diff.top,y );
+				diff.right = std::max( diff.right,x );
+				diff.bottom = std::max( diff.bottom,y );
+			}
+		}
+		return diff;
+	}
+}
+
+bool RunGoldenTests( const std::wstring& dir,bool update,std::wstring& report )
+{
+	auto pPresenter = std::make_unique<HeadlessPresenter>( Graphics::ScreenWidth,Graphics::ScreenHeight );
+	const HeadlessPresenter& presenter = *pPresenter;
+	Graphics gfx( std::move( pPresenter ) );
+
+	std::wostringstream out;
+	bool passed = true;
+	for( const Scene& scene : scenes )
+	{
+		// combined over all frames of the scene
+		unsigned long long sceneHash = 0u;
+		std::chrono::steady_clock::duration renderTime{ 0 };
+		std::wostringstream problems;
+		for( unsigned int frame = 0u; frame < scene.nFrames; frame++ )
+		{
+			gfx.SetResolution( Graphics::ScreenWidth,Graphics::ScreenHeight );
+			gfx.SetUpscaleFilter( SurfaceScaler::Filter::Bilinear );
+			if( scene.Setup )
+			{
+				scene.Setup( gfx,frame );
+			}
+			const auto start = std::chrono::steady_clock::now();
+			gfx.BeginFrame();
+			scene.Draw( gfx,frame );
+			gfx.EndFrame();
+			renderTime += std::chrono::steady_clock::now() - start;
+
+			const Surface& actual = presenter.GetLastFrame();
+			sceneHash = sceneHash * 1099511628211ull ^ actual.GetHash();
+			// forward slashes work on Windows as well
+			const std::wstring base = dir + L"/" + scene.name + L"_" + std::to_wstring( frame );
+			if( update )
+			{
+				actual.Save( base + L".bmp" );
+				continue;
+			}
+			Surface golden( 1u,1u );
+			try
+			{
+				golden = Surface::FromFile( base + L".bmp" );
+			}
+			catch( const Surface::Exception& e )
+			{
+				// missing, truncated or corrupt: a frame with nothing to compare against fails
+				// (goldens are only ever written by an update run)
+				problems << L"\n    frame " << frame << L": no readable golden image (" << e.GetNote() << L")";
+				passed = false;
+				continue;
+			}
+			if( golden.GetWidth() != actual.GetWidth() || golden.GetHeight() != actual.GetHeight() )
+			{
+				problems << L"\n    frame " << frame << L": golden is " << golden.GetWidth() << L"x" << golden.GetHeight();
+				passed = false;
+				continue;
+			}
+			Surface diffImage( actual.GetWidth(),actual.GetHeight() );
+			const Diff diff = Compare( actual,golden,diffImage );
+			if( diff.nPixels != 0u )
+			{
+				problems << L"\n    frame " << frame << L": " << diff.nPixels << L" pixels differ (max delta "
+					<< diff.maxDelta << L") in [" << diff.left << L"," << diff.top << L"]-["
+					<< diff.right << L"," << diff.bottom << L"]";
+				actual.Save( base + L"_actual.bmp" );
+				diffImage.Save( base + L"_diff.bmp" );
+				passed = false;
+			}
+		}
+		const std::chrono::duration<double,std::milli> ms = renderTime;
+		out << scene.name << L": " << scene.nFrames << L" frames, "
+			<< std::fixed << std::setprecision( 3 ) << ms.count() / double( scene.nFrames ) << L" ms/frame, hash "
+			<< std::hex << std::setw( 16 ) << std::setfill( L'0' ) << sceneHash << std::dec << std::setfill( L' ' );
+		const std::wstring sceneProblems = problems.str();
+		if( update )
+		{
+			out << L" (golden updated)";
+		}
+		else if( !sceneProblems.empty() )
+		{
+			out << L" FAILED" << sceneProblems;
+		}
+		else
+		{
+			out << L" ok";
+		}
+		out << L"\n";
+	}
+	if( !update )
+	{
+		out << (passed ? L"\nAll scenes match.\n" : L"\nSome scenes do not match.\n");
+	}
+	report = out.str();
+	return passed;
+}
@@ -0,0 +1,33 @@
+/******************************************************************************************
+*	Chili DirectX Framework Version 16.10.01											  *
+*	GoldenTest.h																		  *
+*	Copyright 2016 PlanetChili <http://www.planetchili.net>								  *
+*																						  *
+*	This file is part of The Chili DirectX Framework.									  *
+*																						  *
+*	The Chili DirectX Framework is free software: you can redistribute it and/or modify	  *
+*	it under the terms of the GNU General Public License as published by				  *
+*	the Free Software Foundation, either version 3 of the License, or					  *
+*	(at your option) any later version.													  *
+*																						  *
+*	The Chili DirectX Framework is distributed in the hope that it will be useful,		  *
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of						  *
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the						  *
+*	GNU General Public License for more details.										  *
+*																						  *
+*	You should have received a copy of the GNU General Public License					  *
+*	along with The Chili DirectX Framework.  If not, see <http://www.gnu.org/licenses/>.  *
+******************************************************************************************/
+#pragma once
+
+#include <string>
+
+// renders a fixed catalog of rasterizer scenes headlessly and checks every frame against
+// golden images in dir (named <scene>_<frame>.bmp; the reference set is Engine/Golden);
+// with update set the goldens are written instead of compared, which is the only way they are
+// report gets hash, render time and diff summary per scene; mismatching frames also get
+// <scene>_<frame>_actual.bmp and <scene>_<frame>_diff.bmp written next to the goldens
+// goldens assume float math is not contracted into fused multiply-adds (msvc's default); a
+// build that contracts moves a few edge pixels
+// returns false if any frame differs from its golden, or its golden is missing or unreadable
+bool RunGoldenTests( const std::wstring& dir,bool update,std::wstring& report );
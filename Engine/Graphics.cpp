@@ -18,315 +18,161 @@
 *	You should have received a copy of the GNU General Public License					  *
 *	along with The Chili DirectX Framework.  If not, see <http://www.gnu.org/licenses/>.  *
 ******************************************************************************************/
-#include "MainWindow.h"
 #include "Graphics.h"
-#include "DXErr.h"
-#include "ChiliException.h"
+#include "Profiler.h"
 #include <assert.h>
-#include <string>
-#include <array>
-#include <functional>
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <iterator>
 
-// Ignore the intellisense error "cannot open source file" for .shh files.
-// They will be created during the build sequence before the preprocessor runs.
-namespace FramebufferShaders
+namespace
 {
-#include "FramebufferPS.shh"
-#include "FramebufferVS.shh"
+	enum RasterCounter
+	{
+		TrianglesSubmitted,
+		TrianglesCulled,
+		TrianglesClipped,
+		TrianglesRasterized,
+		PixelsWritten,
+		RasterCounterCount
+	};
+	// running totals, one set per drawing thread so counting needs no shared writes
+	struct RasterCounters
+	{
+		std::atomic<unsigned long long> values[RasterCounterCount] = {};
+	};
+	// tells instances apart in the per thread lookup, even one at a dead instance's address
+	std::atomic<unsigned long long> nextRegistryId{ 1u };
 }
 
-#pragma comment( lib,"d3d11.lib" )
-
-using Microsoft::WRL::ComPtr;
-
-Graphics::Graphics( HWNDKey& key )
-	:
-	sysBuffer( ScreenWidth,ScreenHeight )
+// every Graphics keeps its own counters, so each instance's stats cover only what it drew
+struct Graphics::RasterCounterRegistry
 {
-	assert( key.hWnd != nullptr );
-
-	//////////////////////////////////////////////////////
-	// create device and swap chain/get render target view
-	DXGI_SWAP_CHAIN_DESC sd = {};
-	sd.BufferCount = 1;
-	sd.BufferDesc.Width = Graphics::ScreenWidth;
-	sd.BufferDesc.Height = Graphics::ScreenHeight;
-	sd.BufferDesc.Format = DXGI_FORMAT_B8G8R8A8_UNORM;
-	sd.BufferDesc.RefreshRate.Numerator = 1;
-	sd.BufferDesc.RefreshRate.Denominator = 60;
-	sd.BufferUsage = DXGI_USAGE_RENDER_TARGET_OUTPUT;
-	sd.OutputWindow = key.hWnd;
-	sd.SampleDesc.Count = 1;
-	sd.SampleDesc.Quality = 0;
-	sd.Windowed = TRUE;
-
-	D3D_FEATURE_LEVEL	featureLevelsRequested = D3D_FEATURE_LEVEL_9_1;
-	UINT				numLevelsRequested = 1;
-	D3D_FEATURE_LEVEL	featureLevelsSupported;
-	HRESULT				hr;
-	UINT				createFlags = 0u;
-#ifdef _DEBUG
-#ifdef USE_DIRECT3D_DEBUG_RUNTIME
-	createFlags |= D3D11_CREATE_DEVICE_DEBUG;
-#endif
-#endif
-	
-	// create device and front/back buffers
-	if( FAILED( hr = D3D11CreateDeviceAndSwapChain( 
-		nullptr,
-		D3D_DRIVER_TYPE_HARDWARE,
-		nullptr,
-		createFlags,
-		&featureLevelsRequested,
-		numLevelsRequested,
-		D3D11_SDK_VERSION,
-		&sd,
-		&pSwapChain,
-		&pDevice,
-		&featureLevelsSupported,
-		&pImmediateContext ) ) )
-	{
-		throw CHILI_GFX_EXCEPTION( hr,L"Creating device and swap chain" );
-	}
+	const unsigned long long id = nextRegistryId.fetch_add( 1u,std::memory_order_relaxed );
+	std::mutex mutex;
+	std::vector<std::pair<std::thread::id,std::unique_ptr<RasterCounters>>> counters;
+};
 
-	// get handle to backbuffer
-	ComPtr<ID3D11Resource> pBackBuffer;
-	if( FAILED( hr = pSwapChain->GetBuffer(
-		0,
-		__uuidof( ID3D11Texture2D ),
-		(LPVOID*)&pBackBuffer ) ) )
-	{
-		throw CHILI_GFX_EXCEPTION( hr,L"Getting back buffer" );
-	}
-
-	// create a view on backbuffer that we can render to
-	if( FAILED( hr = pDevice->CreateRenderTargetView( 
-		pBackBuffer.Get(),
-		nullptr,
-		&pRenderTargetView ) ) )
+void Graphics::Count( unsigned int counter,unsigned long long n )
+{
+	// the set this thread counted into last, and the registry it belongs to
+	thread_local unsigned long long cachedId = 0u;
+	thread_local RasterCounters* pCached = nullptr;
+	RasterCounterRegistry& reg = *pCounters;
+	if( cachedId != reg.id )
 	{
-		throw CHILI_GFX_EXCEPTION( hr,L"Creating render target view on backbuffer" );
-	}
-
-
-	// set backbuffer as the render target using created view
-	pImmediateContext->OMSetRenderTargets( 1,pRenderTargetView.GetAddressOf(),nullptr );
-
-
-	// set viewport dimensions
-	D3D11_VIEWPORT vp;
-	vp.Width = float( Graphics::ScreenWidth );
-	vp.Height = float( Graphics::ScreenHeight );
-	vp.MinDepth = 0.0f;
-	vp.MaxDepth = 1.0f;
-	vp.TopLeftX = 0.0f;
-	vp.TopLeftY = 0.0f;
-	pImmediateContext->RSSetViewports( 1,&vp );
-
-
-	///////////////////////////////////////
-	// create texture for cpu render target
-	D3D11_TEXTURE2D_DESC sysTexDesc;
-	sysTexDesc.Width = Graphics::ScreenWidth;
-	sysTexDesc.Height = Graphics::ScreenHeight;
-	sysTexDesc.MipLevels = 1;
-	sysTexDesc.ArraySize = 1;
-	sysTexDesc.Format = DXGI_FORMAT_B8G8R8A8_UNORM;
-	sysTexDesc.SampleDesc.Count = 1;
-	sysTexDesc.SampleDesc.Quality = 0;
-	sysTexDesc.Usage = D3D11_USAGE_DYNAMIC;
-	sysTexDesc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
-	sysTexDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
-	sysTexDesc.MiscFlags = 0;
-	// create the texture
-	if( FAILED( hr = pDevice->CreateTexture2D( &sysTexDesc,nullptr,&pSysBufferTexture ) ) )
-	{
-		throw CHILI_GFX_EXCEPTION( hr,L"Creating sysbuffer texture" );
+		std::lock_guard<std::mutex> lock( reg.mutex );
+		const std::thread::id thread = std::this_thread::get_id();
+		auto i = std::find_if( reg.counters.begin(),reg.counters.end(),
+			[thread]( const auto& c ) { return c.first == thread; } );
+		if( i == reg.counters.end() )
+		{
+			reg.counters.emplace_back( thread,std::make_unique<RasterCounters>() );
+			i = std::prev( reg.counters.end() );
+		}
+		pCached = i->second.get();
+		cachedId = reg.id;
 	}
+	// only this thread writes, so no read-modify-write is needed
+	std::atomic<unsigned long long>& value = pCached->values[counter];
+	value.store( value.load( std::memory_order_relaxed ) + n,std::memory_order_relaxed );
+}
 
-	D3D11_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
-	srvDesc.Format = sysTexDesc.Format;
-	srvDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2D;
-	srvDesc.Texture2D.MipLevels = 1;
-	// create the resource view on the texture
-	if( FAILED( hr = pDevice->CreateShaderResourceView( pSysBufferTexture.Get(),
-		&srvDesc,&pSysBufferTextureView ) ) )
+Graphics::Graphics( std::unique_ptr<Presenter> pPresenterIn )
+	:
+	pPresenter( std::move( pPresenterIn ) ),
+	sysBuffer( Surface::MakeView( nullptr,0u,0u,0u ) ),
+	pCounters( std::make_unique<RasterCounterRegistry>() )
+{
+	assert( pPresenter );
+	if( !ZeroCopy )
 	{
-		throw CHILI_GFX_EXCEPTION( hr,L"Creating view on sysBuffer texture" );
+		screenBuffer = surfacePool.Acquire( ScreenWidth,ScreenHeight,ScreenLayout );
 	}
+}
 
+Graphics::~Graphics()
+{}
 
-	////////////////////////////////////////////////
-	// create pixel shader for framebuffer
-	// Ignore the intellisense error "namespace has no member"
-	if( FAILED( hr = pDevice->CreatePixelShader(
-		FramebufferShaders::FramebufferPSBytecode,
-		sizeof( FramebufferShaders::FramebufferPSBytecode ),
-		nullptr,
-		&pPixelShader ) ) )
+void Graphics::EndFrame()
+{
+	UpdateRasterStats();
+	if( !writeCounts.empty() )
 	{
-		throw CHILI_GFX_EXCEPTION( hr,L"Creating pixel shader" );
+		DrawOverdrawHeatmap();
 	}
-	
-
-	/////////////////////////////////////////////////
-	// create vertex shader for framebuffer
-	// Ignore the intellisense error "namespace has no member"
-	if( FAILED( hr = pDevice->CreateVertexShader(
-		FramebufferShaders::FramebufferVSBytecode,
-		sizeof( FramebufferShaders::FramebufferVSBytecode ),
-		nullptr,
-		&pVertexShader ) ) )
+	if( drawingToScreen )
 	{
-		throw CHILI_GFX_EXCEPTION( hr,L"Creating vertex shader" );
+		// fill whatever the frame did not draw over, then hand the memory back
+		sysBuffer.ResolveClears();
+		if( onFrame )
+		{
+			onFrame( sysBuffer );
+		}
+		if( onOverlay )
+		{
+			onOverlay( sysBuffer );
+		}
 	}
-	
-
-	//////////////////////////////////////////////////////////////
-	// create and fill vertex buffer with quad for rendering frame
-	const FSQVertex vertices[] =
+	else
 	{
-		{ -1.0f,1.0f,0.5f,0.0f,0.0f },
-		{ 1.0f,1.0f,0.5f,1.0f,0.0f },
-		{ 1.0f,-1.0f,0.5f,1.0f,1.0f },
-		{ -1.0f,1.0f,0.5f,0.0f,0.0f },
-		{ 1.0f,-1.0f,0.5f,1.0f,1.0f },
-		{ -1.0f,-1.0f,0.5f,0.0f,1.0f },
-	};
-	D3D11_BUFFER_DESC bd = {};
-	bd.Usage = D3D11_USAGE_DEFAULT;
-	bd.ByteWidth = sizeof( FSQVertex ) * 6;
-	bd.BindFlags = D3D11_BIND_VERTEX_BUFFER;
-	bd.CPUAccessFlags = 0u;
-	D3D11_SUBRESOURCE_DATA initData = {};
-	initData.pSysMem = vertices;
-	if( FAILED( hr = pDevice->CreateBuffer( &bd,&initData,&pVertexBuffer ) ) )
-	{
-		throw CHILI_GFX_EXCEPTION( hr,L"Creating vertex buffer" );
+		Surface frame = pPresenter->Map();
+		if( width != ScreenWidth || height != ScreenHeight )
+		{
+			CHILI_PROFILE_ZONE( "Upscale" );
+			scaler.Scale( sysBuffer,frame,upscaleFilter,pJobs );
+		}
+		else
+		{
+			// perform the copy line-by-line
+			sysBuffer.Present( frame.GetPitch() * sizeof( Color ),
+				reinterpret_cast<unsigned char*>(frame.GetBufferPtr()) );
+		}
+		if( onFrame )
+		{
+			onFrame( frame );
+		}
+		if( onOverlay )
+		{
+			onOverlay( frame );
+		}
 	}
+	pPresenter->Unmap();
+	CHILI_PROFILE_ZONE( "Present" );
+	pPresenter->Present();
+}
 
-	
-	//////////////////////////////////////////
-	// create input layout for fullscreen quad
-	const D3D11_INPUT_ELEMENT_DESC ied[] =
-	{
-		{ "POSITION",0,DXGI_FORMAT_R32G32B32_FLOAT,0,0,D3D11_INPUT_PER_VERTEX_DATA,0 },
-		{ "TEXCOORD",0,DXGI_FORMAT_R32G32_FLOAT,0,12,D3D11_INPUT_PER_VERTEX_DATA,0 }
-	};
-
-	// Ignore the intellisense error "namespace has no member"
-	if( FAILED( hr = pDevice->CreateInputLayout( ied,2,
-		FramebufferShaders::FramebufferVSBytecode,
-		sizeof( FramebufferShaders::FramebufferVSBytecode ),
-		&pInputLayout ) ) )
+void Graphics::BeginFrame()
+{
+	frameArena.Reset();
+	width = nextWidth;
+	height = nextHeight;
+	const bool reduced = width != ScreenWidth || height != ScreenHeight;
+	drawingToScreen = ZeroCopy && !reduced;
+	if( drawingToScreen )
 	{
-		throw CHILI_GFX_EXCEPTION( hr,L"Creating input layout" );
+		// draw straight into the presenter's frame memory
+		sysBuffer = pPresenter->Map();
 	}
-
-
-	////////////////////////////////////////////////////
-	// Create sampler state for fullscreen textured quad
-	D3D11_SAMPLER_DESC sampDesc = {};
-	sampDesc.Filter = D3D11_FILTER_MIN_MAG_MIP_POINT;
-	sampDesc.AddressU = D3D11_TEXTURE_ADDRESS_CLAMP;
-	sampDesc.AddressV = D3D11_TEXTURE_ADDRESS_CLAMP;
-	sampDesc.AddressW = D3D11_TEXTURE_ADDRESS_CLAMP;
-	sampDesc.ComparisonFunc = D3D11_COMPARISON_NEVER;
-	sampDesc.MinLOD = 0;
-	sampDesc.MaxLOD = D3D11_FLOAT32_MAX;
-	if( FAILED( hr = pDevice->CreateSamplerState( &sampDesc,&pSamplerState ) ) )
+	else if( reduced )
 	{
-		throw CHILI_GFX_EXCEPTION( hr,L"Creating sampler state" );
+		if( !renderTarget || renderTarget->GetWidth() != width || renderTarget->GetHeight() != height )
+		{
+			// give the old target back first so the pool can hand its buffer out again
+			renderTarget = SurfacePool::Lease();
+			renderTarget = surfacePool.Acquire( width,height );
+		}
+		sysBuffer = Surface::MakeView( renderTarget->GetBufferPtr(),width,height,renderTarget->GetPitch() );
 	}
-}
-
-Graphics::~Graphics()
-{
-	// clear the state of the device context before destruction
-	if( pImmediateContext ) pImmediateContext->ClearState();
-}
-
-void Graphics::EndFrame()
-{
-	HRESULT hr;
-
-	// lock and map the adapter memory for copying over the sysbuffer
-	if( FAILED( hr = pImmediateContext->Map( pSysBufferTexture.Get(),0u,
-		D3D11_MAP_WRITE_DISCARD,0u,&mappedSysBufferTexture ) ) )
+	else
 	{
-		throw CHILI_GFX_EXCEPTION( hr,L"Mapping sysbuffer" );
+		sysBuffer = Surface::MakeView( screenBuffer->GetBufferPtr(),ScreenWidth,ScreenHeight,
+			screenBuffer->GetPitch(),ScreenLayout );
 	}
-	// perform the copy line-by-line
-	sysBuffer.Present( mappedSysBufferTexture.RowPitch,
-		reinterpret_cast<BYTE*>(mappedSysBufferTexture.pData) );
-	// release the adapter memory
-	pImmediateContext->Unmap( pSysBufferTexture.Get(),0u );
-
-	// render offscreen scene texture to back buffer
-	pImmediateContext->IASetInputLayout( pInputLayout.Get() );
-	pImmediateContext->VSSetShader( pVertexShader.Get(),nullptr,0u );
-	pImmediateContext->PSSetShader( pPixelShader.Get(),nullptr,0u );
-	pImmediateContext->IASetPrimitiveTopology( D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST );
-	const UINT stride = sizeof( FSQVertex );
-	const UINT offset = 0u;
-	pImmediateContext->IASetVertexBuffers( 0u,1u,pVertexBuffer.GetAddressOf(),&stride,&offset );
-	pImmediateContext->PSSetShaderResources( 0u,1u,pSysBufferTextureView.GetAddressOf() );
-	pImmediateContext->PSSetSamplers( 0u,1u,pSamplerState.GetAddressOf() );
-	pImmediateContext->Draw( 6u,0u );
-
-	// flip back/front buffers
-	if( FAILED( hr = pSwapChain->Present( 1u,0u ) ) )
-	{
-		throw CHILI_GFX_EXCEPTION( hr,L"Presenting back buffer" );
-	}
-}
-
-void Graphics::BeginFrame()
-{
-	sysBuffer.Clear( Colors::Red );
-}
-
-
-//////////////////////////////////////////////////
-//           Graphics Exception
-Graphics::Exception::Exception( HRESULT hr,const std::wstring& note,const wchar_t* file,unsigned int line )
-	:
-	ChiliException( file,line,note ),
-	hr( hr )
-{}
-
-std::wstring Graphics::Exception::GetFullMessage() const
-{
-	const std::wstring empty = L"";
-	const std::wstring errorName = GetErrorName();
-	const std::wstring errorDesc = GetErrorDescription();
-	const std::wstring& note = GetNote();
-	const std::wstring location = GetLocation();
-	return    (!errorName.empty() ? std::wstring( L"Error: " ) + errorName + L"\n"
-		: empty)
-		+ (!errorDesc.empty() ? std::wstring( L"Description: " ) + errorDesc + L"\n"
-			: empty)
-		+ (!note.empty() ? std::wstring( L"Note: " ) + note + L"\n"
-			: empty)
-		+ (!location.empty() ? std::wstring( L"Location: " ) + location
-			: empty);
-}
-
-std::wstring Graphics::Exception::GetErrorName() const
-{
-	return DXGetErrorString( hr );
-}
-
-std::wstring Graphics::Exception::GetErrorDescription() const
-{
-	std::array<wchar_t,512> wideDescription;
-	DXGetErrorDescription( hr,wideDescription.data(),wideDescription.size() );
-	return wideDescription.data();
-}
-
-std::wstring Graphics::Exception::GetExceptionType() const
-{
-	return L"Chili Graphics Exception";
+	// deferred clear: only tiles the frame never draws to are filled, at present time
+	sysBuffer.FastClear( Colors::Red );
 }
 
 void Graphics::DrawLine( float x1,float y1,float x2,float y2,Color c )
@@ -384,6 +230,25 @@ void Graphics::DrawLine( float x1,float y1,float x2,float y2,Color c )
 
 void Graphics::DrawTriangle( const Vec2& v0,const Vec2& v1,const Vec2& v2,Color c )
 {
+	CHILI_PROFILE_ZONE( "DrawTriangle" );
+	Count( TrianglesSubmitted );
+	// nothing to fill if the triangle has no area or lies entirely off screen
+	const float minX = std::min( { v0.x,v1.x,v2.x } );
+	const float maxX = std::max( { v0.x,v1.x,v2.x } );
+	const float minY = std::min( { v0.y,v1.y,v2.y } );
+	const float maxY = std::max( { v0.y,v1.y,v2.y } );
+	if( (v1 - v0).x * (v2 - v0).y == (v1 - v0).y * (v2 - v0).x ||
+		maxX < 0.0f || maxY < 0.0f || minX >= float( width ) || minY >= float( height ) )
+	{
+		Count( TrianglesCulled );
+		return;
+	}
+	if( minX < 0.0f || minY < 0.0f || maxX > float( width ) || maxY > float( height ) )
+	{
+		Count( TrianglesClipped );
+	}
+	Count( TrianglesRasterized );
+
 	// using pointers so we can swap (for sorting purposes)
 	const Vec2* pv0 = &v0;
 	const Vec2* pv1 = &v1;
@@ -444,8 +309,8 @@ void Graphics::DrawFlatTopTriangle( const Vec2& v0,const Vec2& v1,const Vec2& v2
 	float m1 = (v2.x - v1.x) / (v2.y - v1.y);
 
 	// calculate start and end scanlines, start and end y coordinates to render in 
-	const int yStart = (int)ceil( v0.y - 0.5f );
-	const int yEnd = (int)ceil( v2.y - 0.5f ); // the scanline AFTER the last line drawn
+	const int yStart = std::max( (int)ceil( v0.y - 0.5f ),0 );
+	const int yEnd = std::min( (int)ceil( v2.y - 0.5f ),int( height ) ); // the scanline AFTER the last line drawn
 
 	for( int y = yStart; y < yEnd; y++ )
 	{
@@ -479,10 +344,7 @@ void Graphics::DrawFlatTopTriangle( const Vec2& v0,const Vec2& v1,const Vec2& v2
 		const int xStart = (int)ceil( px0 - 0.5f );
 		const int xEnd = (int)ceil( px1 - 0.5f ); // the pixel AFTER the last pixel drawn
 
-		for( int x = xStart; x < xEnd; x++ )
-		{
-			PutPixel( x,y,c );
-		}
+		DrawSpan( y,xStart,xEnd,c );
 	}
 }
 
@@ -493,8 +355,8 @@ void Graphics::DrawFlatBottomTriangle( const Vec2& v0,const Vec2& v1,const Vec2&
 	float m1 = (v2.x - v0.x) / (v2.y - v0.y);
 
 	// calculate start and end scanlines
-	const int yStart = (int)ceil( v0.y - 0.5f );
-	const int yEnd = (int)ceil( v2.y - 0.5f ); // the scanline AFTER the last line drawn
+	const int yStart = std::max( (int)ceil( v0.y - 0.5f ),0 );
+	const int yEnd = std::min( (int)ceil( v2.y - 0.5f ),int( height ) ); // the scanline AFTER the last line drawn
 
 	for( int y = yStart; y < yEnd; y++ )
 	{
@@ -507,9 +369,184 @@ void Graphics::DrawFlatBottomTriangle( const Vec2& v0,const Vec2& v1,const Vec2&
 		const int xStart = (int)ceil( px0 - 0.5f );
 		const int xEnd = (int)ceil( px1 - 0.5f ); // the pixel AFTER the last pixel drawn
 
+		DrawSpan( y,xStart,xEnd,c );
+	}
+}
+
+void Graphics::DrawSpan( int y,int xStart,int xEnd,Color c )
+{
+	xStart = std::max( xStart,0 );
+	xEnd = std::min( xEnd,int( width ) );
+	if( xEnd <= xStart )
+	{
+		return;
+	}
+	Count( PixelsWritten,xEnd - xStart );
+	if( !writeCounts.empty() )
+	{
+		unsigned short* const pCounts = &writeCounts[y * width];
 		for( int x = xStart; x < xEnd; x++ )
 		{
-			PutPixel( x,y,c );
+			pCounts[x]++;
 		}
 	}
-}
\ No newline at end of file
+	for( int x = xStart; x < xEnd; x++ )
+	{
+		PutPixel( x,y,c );
+	}
+}
+
+void Graphics::SetResolution( unsigned int widthIn,unsigned int heightIn )
+{
+	nextWidth = std::min( std::max( widthIn,1u ),ScreenWidth );
+	nextHeight = std::min( std::max( heightIn,1u ),ScreenHeight );
+}
+
+void Graphics::DrawSprite( int x,int y,const RectI& srcRect,const RectI& clip,const Surface& sprite,
+	Surface::BlendMode mode,Color key )
+{
+	CountDrawn( sysBuffer.Blit( x,y,srcRect,sprite,clip,mode,key ) );
+}
+
+void Graphics::CountDrawn( const RectI& drawn )
+{
+	if( drawn.GetWidth() <= 0 || drawn.GetHeight() <= 0 )
+	{
+		return;
+	}
+	Count( PixelsWritten,static_cast<unsigned long long>( drawn.GetWidth() ) * drawn.GetHeight() );
+	if( !writeCounts.empty() )
+	{
+		for( int y = drawn.top; y < drawn.bottom; y++ )
+		{
+			unsigned short* const pCounts = &writeCounts[y * width];
+			for( int x = drawn.left; x < drawn.right; x++ )
+			{
+				pCounts[x]++;
+			}
+		}
+	}
+}
+
+void Graphics::DrawSprites( const std::vector<Sprite>& sprites )
+{
+	CHILI_PROFILE_ZONE( "DrawSprites" );
+	// sort pointers (scratch for this frame only) by surface, then by position in sprites
+	const Sprite** const pOrder = frameArena.Allocate<const Sprite*>( sprites.size() );
+	for( size_t i = 0u; i < sprites.size(); i++ )
+	{
+		pOrder[i] = &sprites[i];
+	}
+	std::sort( pOrder,pOrder + sprites.size(),[]( const Sprite* a,const Sprite* b )
+	{
+		return a->pSurface != b->pSurface ? std::less<const Surface*>()( a->pSurface,b->pSurface ) : a < b;
+	} );
+	const RectI screen = GetScreenRect();
+	for( size_t i = 0u; i < sprites.size(); i++ )
+	{
+		const Sprite& s = *pOrder[i];
+		DrawSprite( s.x,s.y,s.srcRect,screen,*s.pSurface,s.mode,s.key );
+	}
+}
+
+void Graphics::DrawString( Surface& target,int x,int y,const BitmapFont::TextLayout& text,
+	const BitmapFont& font,Color color )
+{
+	const RectI clip = { 0,int( target.GetHeight() ),0,int( target.GetWidth() ) };
+	const Surface& atlas = font.GetAtlas();
+	for( const BitmapFont::Quad& q : text.quads )
+	{
+		target.Blit( x + q.x,y + q.y,q.srcRect,atlas,clip,Surface::BlendMode::Tint,color );
+	}
+}
+
+void Graphics::SetOverdrawHeatmap( bool enabled )
+{
+	if( enabled )
+	{
+		writeCounts.resize( ScreenWidth * ScreenHeight,0u );
+	}
+	else
+	{
+		writeCounts.clear();
+		writeCounts.shrink_to_fit();
+	}
+}
+
+void Graphics::SetFrameCallback( std::function<void( const Surface& )> callback )
+{
+	onFrame = std::move( callback );
+}
+
+void Graphics::SetOverlay( std::function<void( Surface& )> overlay )
+{
+	onOverlay = std::move( overlay );
+}
+
+void Graphics::DrawOverdrawHeatmap()
+{
+	// black for untouched, then blue -> cyan -> green -> yellow -> red as writes approach HeatmapMaxWrites
+	const Color ramp[] = { Colors::Blue,Colors::Cyan,Colors::Green,Colors::Yellow,Colors::Red };
+	const unsigned int nSteps = sizeof( ramp ) / sizeof( *ramp ) - 1u;
+	unsigned long long nCovered = 0u;
+	for( unsigned int y = 0u; y < height; y++ )
+	{
+		for( unsigned int x = 0u; x < width; x++ )
+		{
+			unsigned short& count = writeCounts[y * width + x];
+			if( count == 0u )
+			{
+				sysBuffer.PutPixel( x,y,Colors::Black );
+				continue;
+			}
+			nCovered++;
+			const unsigned int nWrites = count < HeatmapMaxWrites ? count : HeatmapMaxWrites;
+			const float t = float( nWrites - 1u ) / float( HeatmapMaxWrites - 1u ) * float( nSteps );
+			const unsigned int i = std::min( static_cast<unsigned int>( t ),nSteps - 1u );
+			const float a = t - float( i );
+			const Color c0 = ramp[i];
+			const Color c1 = ramp[i + 1u];
+			sysBuffer.PutPixel( x,y,{
+				static_cast<unsigned char>( float( c0.GetR() ) + (float( c1.GetR() ) - float( c0.GetR() )) * a ),
+				static_cast<unsigned char>( float( c0.GetG() ) + (float( c1.GetG() ) - float( c0.GetG() )) * a ),
+				static_cast<unsigned char>( float( c0.GetB() ) + (float( c1.GetB() ) - float( c0.GetB() )) * a ) } );
+			count = 0u;
+		}
+	}
+	frameStats.pixelsCovered = nCovered;
+}
+
+void Graphics::UpdateRasterStats()
+{
+	RasterStats totals;
+	{
+		RasterCounterRegistry& reg = *pCounters;
+		std::lock_guard<std::mutex> lock( reg.mutex );
+		for( const auto& c : reg.counters )
+		{
+			const auto value = [&c]( RasterCounter counter )
+			{
+				return c.second->values[counter].load( std::memory_order_relaxed );
+			};
+			totals.trianglesSubmitted += value( TrianglesSubmitted );
+			totals.trianglesCulled += value( TrianglesCulled );
+			totals.trianglesClipped += value( TrianglesClipped );
+			totals.trianglesRasterized += value( TrianglesRasterized );
+			totals.pixelsWritten += value( PixelsWritten );
+		}
+	}
+	frameStats.trianglesSubmitted = totals.trianglesSubmitted - statTotals.trianglesSubmitted;
+	frameStats.trianglesCulled = totals.trianglesCulled - statTotals.trianglesCulled;
+	frameStats.trianglesClipped = totals.trianglesClipped - statTotals.trianglesClipped;
+	frameStats.trianglesRasterized = totals.trianglesRasterized - statTotals.trianglesRasterized;
+	frameStats.pixelsWritten = totals.pixelsWritten - statTotals.pixelsWritten;
+	frameStats.pixelsCovered = 0u;
+	frameStats.pixelsRendered = static_cast<unsigned long long>( width ) * height;
+	statTotals = totals;
+}
+
+float Graphics::RasterStats::GetAverageOverdraw() const
+{
+	const unsigned long long nPixels = pixelsCovered != 0u ? pixelsCovered : pixelsRendered;
+	return float( pixelsWritten ) / float( nPixels );
+}
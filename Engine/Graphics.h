@@ -19,44 +19,101 @@
 *	along with The Chili DirectX Framework.  If not, see <http://www.gnu.org/licenses/>.  *
 ******************************************************************************************/
 #pragma once
-#include <d3d11.h>
-#include <wrl.h>
-#include "GDIPlusManager.h"
-#include "ChiliException.h"
+#include "Presenter.h"
 #include "Surface.h"
+#include "SurfacePool.h"
+#include "FrameArena.h"
+#include "SurfaceScaler.h"
+#include "BitmapFont.h"
 #include "Colors.h"
 #include "Vec2.h"
+#include <memory>
+#include <vector>
+#include <functional>
 
-#define CHILI_GFX_EXCEPTION( hr,note ) Graphics::Exception( hr,note,_CRT_WIDE(__FILE__),__LINE__ )
+class JobSystem;
 
 class Graphics
 {
 public:
-	class Exception : public ChiliException
-	{
-	public:
-		Exception( HRESULT hr,const std::wstring& note,const wchar_t* file,unsigned int line );
-		std::wstring GetErrorName() const;
-		std::wstring GetErrorDescription() const;
-		virtual std::wstring GetFullMessage() const override;
-		virtual std::wstring GetExceptionType() const override;
-	private:
-		HRESULT hr;
+	// rasterizer work done during one frame
+	struct RasterStats
+	{
+		unsigned long long trianglesSubmitted = 0u;
+		// degenerate or entirely off screen
+		unsigned long long trianglesCulled = 0u;
+		// partly off screen, drawn cut to the screen edges
+		unsigned long long trianglesClipped = 0u;
+		unsigned long long trianglesRasterized = 0u;
+		unsigned long long pixelsWritten = 0u;
+		// distinct pixels written; only counted while the overdraw heatmap is on
+		unsigned long long pixelsCovered = 0u;
+		// size of the frame at the resolution it was rendered at, before any upscale
+		unsigned long long pixelsRendered = static_cast<unsigned long long>( ScreenWidth ) * ScreenHeight;
+		// writes per covered pixel, or per rendered pixel when coverage wasn't counted
+		float GetAverageOverdraw() const;
 	};
-private:
-	// vertex format for the framebuffer fullscreen textured quad
-	struct FSQVertex
+	// one DrawSprite call, for drawing many at once with DrawSprites
+	struct Sprite
 	{
-		float x,y,z;		// position
-		float u,v;			// texcoords
+		int x;
+		int y;
+		RectI srcRect;
+		const Surface* pSurface;
+		Surface::BlendMode mode = Surface::BlendMode::Opaque;
+		Color key = Colors::Magenta;
 	};
 public:
-	Graphics( class HWNDKey& key );
+	Graphics( std::unique_ptr<Presenter> pPresenter );
 	Graphics( const Graphics& ) = delete;
 	Graphics& operator=( const Graphics& ) = delete;
 	void EndFrame();
 	void BeginFrame();
 	void DrawTriangle( const Vec2& v0,const Vec2& v1,const Vec2& v2,Color c );
+	// srcRect of sprite with its top left corner at (x,y), clipped to the screen (see Surface::Blit)
+	void DrawSprite( int x,int y,const RectI& srcRect,const Surface& sprite,
+		Surface::BlendMode mode = Surface::BlendMode::Opaque,Color key = Colors::Magenta )
+	{
+		DrawSprite( x,y,srcRect,GetScreenRect(),sprite,mode,key );
+	}
+	// as above, also clipped to clip
+	void DrawSprite( int x,int y,const RectI& srcRect,const RectI& clip,const Surface& sprite,
+		Surface::BlendMode mode = Surface::BlendMode::Opaque,Color key = Colors::Magenta );
+	// draws sprites grouped by source surface, so each surface's pixels are still in cache for
+	// the next sprite; sprites sharing a surface keep their order, but sprites of different
+	// surfaces may be drawn in any order relative to each other
+	void DrawSprites( const std::vector<Sprite>& sprites );
+	// text laid out by font, with its top left corner at (x,y), tinted color and clipped to
+	// target; the glyphs all come from font's small atlas, which stays in cache throughout
+	// draws into any surface (e.g. a frame handed to the overlay) and counts nothing
+	static void DrawString( Surface& target,int x,int y,const BitmapFont::TextLayout& text,
+		const BitmapFont& font,Color color );
+	static RectI GetScreenRect()
+	{
+		return { 0,int( ScreenHeight ),0,int( ScreenWidth ) };
+	}
+	// size of the surface drawn to this frame: the screen, or less when rendering at a reduced
+	// resolution that EndFrame upscales to the screen
+	unsigned int GetWidth() const
+	{
+		return width;
+	}
+	unsigned int GetHeight() const
+	{
+		return height;
+	}
+	// takes effect at the next BeginFrame; clamped to [1,ScreenWidth] x [1,ScreenHeight]
+	void SetResolution( unsigned int width,unsigned int height );
+	void SetUpscaleFilter( SurfaceScaler::Filter filter )
+	{
+		upscaleFilter = filter;
+	}
+	// upscaling is split over pJobs' threads (owned by the rendering thread) when set,
+	// and done on the rendering thread alone otherwise
+	void SetJobSystem( JobSystem* pJobsIn )
+	{
+		pJobs = pJobsIn;
+	}
 	void DrawLine( const Vec2& p1,const Vec2& p2,Color c )
 	{
 		DrawLine( p1.x,p1.y,p2.x,p2.y,c );
@@ -64,32 +121,93 @@ public:
 	void DrawLine( float x1,float y1,float x2,float y2,Color c );
 	void PutPixel( int x,int y,int r,int g,int b )
 	{
-		PutPixel( x,y,{ unsigned char( r ),unsigned char( g ),unsigned char( b ) } );
+		PutPixel( x,y,{ (unsigned char)r,(unsigned char)g,(unsigned char)b } );
 	}
 	void PutPixel( int x,int y,Color c )
 	{
 		sysBuffer.PutPixel( x,y,c );
 	}
 	~Graphics();
+	// counters of the last completed frame
+	const RasterStats& GetRasterStats() const
+	{
+		return frameStats;
+	}
+	// transient render targets, recycled rather than allocated each frame
+	SurfacePool& GetSurfacePool()
+	{
+		return surfacePool;
+	}
+	const SurfacePool& GetSurfacePool() const
+	{
+		return surfacePool;
+	}
+	// scratch memory for the current frame, reset by BeginFrame
+	FrameArena& GetFrameArena()
+	{
+		return frameArena;
+	}
+	const FrameArena& GetFrameArena() const
+	{
+		return frameArena;
+	}
+	// when enabled, frames show how many times each pixel was written instead of their contents
+	void SetOverdrawHeatmap( bool enabled );
+	// called with every finished frame, on the rendering thread just before it is presented
+	void SetFrameCallback( std::function<void( const Surface& )> callback );
+	// draws over every frame on the rendering thread once it is at screen resolution (after
+	// any upscale) and after the frame callback, so captures and the raster counters miss it
+	void SetOverlay( std::function<void( Surface& )> overlay );
 private:
 	void DrawFlatTopTriangle( const Vec2& v0,const Vec2& v1,const Vec2& v2,Color c );
 	void DrawFlatBottomTriangle( const Vec2& v0,const Vec2& v1,const Vec2& v2,Color c );
+	// pixels [xStart,xEnd) of scanline y, clamped to the surface
+	void DrawSpan( int y,int xStart,int xEnd,Color c );
+	// adds n to one of this instance's raster counters (see Graphics.cpp), from any thread
+	void Count( unsigned int counter,unsigned long long n = 1u );
+	// counts the pixels of a rectangle just drawn (empty if nothing was)
+	void CountDrawn( const RectI& drawn );
+	void DrawOverdrawHeatmap();
+	void UpdateRasterStats();
 private:
-	GDIPlusManager										gdipMan;
-	Microsoft::WRL::ComPtr<IDXGISwapChain>				pSwapChain;
-	Microsoft::WRL::ComPtr<ID3D11Device>				pDevice;
-	Microsoft::WRL::ComPtr<ID3D11DeviceContext>			pImmediateContext;
-	Microsoft::WRL::ComPtr<ID3D11RenderTargetView>		pRenderTargetView;
-	Microsoft::WRL::ComPtr<ID3D11Texture2D>				pSysBufferTexture;
-	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView>	pSysBufferTextureView;
-	Microsoft::WRL::ComPtr<ID3D11PixelShader>			pPixelShader;
-	Microsoft::WRL::ComPtr<ID3D11VertexShader>			pVertexShader;
-	Microsoft::WRL::ComPtr<ID3D11Buffer>				pVertexBuffer;
-	Microsoft::WRL::ComPtr<ID3D11InputLayout>			pInputLayout;
-	Microsoft::WRL::ComPtr<ID3D11SamplerState>			pSamplerState;
-	D3D11_MAPPED_SUBRESOURCE							mappedSysBufferTexture;
+	struct RasterCounterRegistry;
+	std::unique_ptr<Presenter>							pPresenter;
+	// what this frame draws to, valid from BeginFrame to EndFrame: a view of the presenter's
+	// memory (ZeroCopy at full resolution), of screenBuffer, or of renderTarget
 	Surface												sysBuffer;
+	unsigned int										width = ScreenWidth;
+	unsigned int										height = ScreenHeight;
+	// applied by the next BeginFrame
+	unsigned int										nextWidth = ScreenWidth;
+	unsigned int										nextHeight = ScreenHeight;
+	// whether sysBuffer is the presenter's memory this frame
+	bool												drawingToScreen = false;
+	// this instance's counters, one set per thread that has drawn with it
+	std::unique_ptr<RasterCounterRegistry>				pCounters;
+	// running totals at the end of the previous frame, and the difference over the last frame
+	RasterStats											statTotals;
+	RasterStats											frameStats;
+	// per pixel write counts of the current frame; empty unless the heatmap is on
+	std::vector<unsigned short>							writeCounts;
+	std::function<void( const Surface& )>				onFrame;
+	std::function<void( Surface& )>						onOverlay;
+	SurfacePool											surfacePool;
+	FrameArena											frameArena;
+	// full resolution frames are drawn here when they can't go straight to the presenter
+	SurfacePool::Lease									screenBuffer;
+	// reduced resolution frames are drawn here; reacquired only when the resolution changes
+	SurfacePool::Lease									renderTarget;
+	SurfaceScaler										scaler;
+	SurfaceScaler::Filter								upscaleFilter = SurfaceScaler::Filter::Bilinear;
+	JobSystem*											pJobs = nullptr;
 public:
 	static constexpr unsigned int ScreenWidth = 640u;
 	static constexpr unsigned int ScreenHeight = 640u;
+	// Tiled keeps rasterizer writes block-local at the cost of a detile in Present
+	static constexpr Surface::Layout ScreenLayout = Surface::Layout::Linear;
+	// render directly into the memory handed out by the presenter instead of
+	// copying sysBuffer over at the end of the frame (presenter memory is linear)
+	static constexpr bool ZeroCopy = ScreenLayout == Surface::Layout::Linear;
+	// write count shown at full heat
+	static constexpr unsigned int HeatmapMaxWrites = 8u;
 };
\ No newline at end of file
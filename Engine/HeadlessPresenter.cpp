@@ -0,0 +1,62 @@
+/******************************************************************************************
+*	Chili DirectX Framework Version 16.10.01											  *
+*	HeadlessPresenter.cpp																  *
+*	Copyright 2016 PlanetChili <http://www.planetchili.net>								  *
+*																						  *
+*	This file is part of The Chili DirectX Framework.									  *
+*																						  *
+*	The Chili DirectX Framework is free software: you can redistribute it and/or modify	  *
+*	it under the terms of the GNU General Public License as published by				  *
+*	the Free Software Foundation, either version 3 of the License, or					  *
+*	(at your option) any later version.													  *
+*																						  *
+*	The Chili DirectX Framework is distributed in the hope that it will be useful,		  *
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of						  *
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the						  *
+*	GNU General Public License for more details.										  *
+*																						  *
+*	You should have received a copy of the GNU General Public License					  *
+*	along with The Chili DirectX Framework.  If not, see <http://www.gnu.org/licenses/>.  *
+******************************************************************************************/
+#include "HeadlessPresenter.h"
+
+HeadlessPresenter::HeadlessPresenter( unsigned int width,unsigned int height,unsigned int ringSize )
+{
+	assert( ringSize > 0u );
+	ring.reserve( ringSize );
+	for( unsigned int i = 0u; i < ringSize; i++ )
+	{
+		ring.emplace_back( width,height,Surface::RowAlignment::CacheLine );
+	}
+}
+
+Surface HeadlessPresenter::Map()
+{
+	Surface& frame = ring[mapped];
+	return Surface::MakeView( frame.GetBufferPtr(),frame.GetWidth(),frame.GetHeight(),frame.GetPitch() );
+}
+
+void HeadlessPresenter::Unmap()
+{
+	presented = mapped;
+	mapped = (mapped + 1u) % ring.size();
+}
+
+void HeadlessPresenter::Present()
+{
+	frameCount++;
+	if( onPresent )
+	{
+		onPresent( ring[presented] );
+	}
+}
+
+const Surface& HeadlessPresenter::GetLastFrame() const
+{
+	return ring[presented];
+}
+
+void HeadlessPresenter::SetPresentCallback( std::function<void( const Surface& )> callback )
+{
+	onPresent = std::move( callback );
+}
@@ -0,0 +1,50 @@
+/******************************************************************************************
+*	Chili DirectX Framework Version 16.10.01											  *
+*	HeadlessPresenter.h																	  *
+*	Copyright 2016 PlanetChili <http://www.planetchili.net>								  *
+*																						  *
+*	This file is part of The Chili DirectX Framework.									  *
+*																						  *
+*	The Chili DirectX Framework is free software: you can redistribute it and/or modify	  *
+*	it under the terms of the GNU General Public License as published by				  *
+*	the Free Software Foundation, either version 3 of the License, or					  *
+*	(at your option) any later version.													  *
+*																						  *
+*	The Chili DirectX Framework is distributed in the hope that it will be useful,		  *
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of						  *
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the						  *
+*	GNU General Public License for more details.										  *
+*																						  *
+*	You should have received a copy of the GNU General Public License					  *
+*	along with The Chili DirectX Framework.  If not, see <http://www.gnu.org/licenses/>.  *
+******************************************************************************************/
+#pragma once
+
+#include "Presenter.h"
+#include <vector>
+#include <functional>
+
+// presenter with no window, for running the renderer offscreen (and off Windows)
+// frames are written straight into a ring of surfaces that stays valid after present
+class HeadlessPresenter : public Presenter
+{
+public:
+	HeadlessPresenter( unsigned int width,unsigned int height,unsigned int ringSize = 2u );
+	Surface Map() override;
+	void Unmap() override;
+	void Present() override;
+	// most recently presented frame
+	const Surface& GetLastFrame() const;
+	unsigned long long GetFrameCount() const
+	{
+		return frameCount;
+	}
+	// called with every frame as it is presented
+	void SetPresentCallback( std::function<void( const Surface& )> callback );
+private:
+	std::vector<Surface> ring;
+	size_t mapped = 0u;
+	size_t presented = 0u;
+	unsigned long long frameCount = 0u;
+	std::function<void( const Surface& )> onPresent;
+};
@@ -0,0 +1,225 @@
+/******************************************************************************************
+*	Chili DirectX Framework Version 16.10.01											  *
+*	ImageCheck.cpp																		  *
+*	Copyright 2016 PlanetChili <http://www.planetchili.net>								  *
+*																						  *
+*	This file is part of The Chili DirectX Framework.									  *
+*																						  *
+*	The Chili DirectX Framework is free software: you can redistribute it and/or modify	  *
+*	it under the terms of the GNU General Public License as published by				  *
+*	the Free Software Foundation, either version 3 of the License, or					  *
+*	(at your option) any later version.													  *
+*																						  *
+*	The Chili DirectX Framework is distributed in the hope that it will be useful,		  *
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of						  *
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the						  *
+*	GNU General Public License for more details.										  *
+*																						  *
+*	You should have received a copy of the GNU General Public License					  *
+*	along with The Chili DirectX Framework.  If not, see <http://www.gnu.org/licenses/>.  *
+******************************************************************************************/
+#include "ImageCheck.h"
+#include "Surface.h"
+#include "ImageDecoder.h"
+#include "MappedFile.h"
+#include "JobSystem.h"
+#include <sstream>
+#include <vector>
+#include <algorithm>
+
+namespace
+{
+	const wchar_t* const formats[] = { L"bmp",L"tga",L"ppm",L"qoi" };
+	// odd widths leave scalar tails after the vector loops and padding at the end of BMP rows
+	const struct
+	{
+		unsigned int width;
+		unsigned int height;
+	} sizes[] = { { 1u,1u },{ 3u,5u },{ 17u,9u },{ 33u,31u },{ 64u,7u },{ 7u,64u } };
+
+	// noise with runs of repeated colors, so QOI's run and index ops come up as well as literals
+	Surface MakeImage( unsigned int width,unsigned int height,unsigned int seed )
+	{
+		Surface image( width,height );
+		unsigned int rng = seed;
+		Color c;
+		for( unsigned int y = 0u; y < height; y++ )
+		{
+			for( unsigned int x = 0u; x < width; x++ )
+			{
+				rng = rng * 1664525u + 1013904223u;
+				if( (rng >> 28) < 10u )
+				{
+					c = Color( static_cast<unsigned char>( rng >> 4 ),static_cast<unsigned char>( rng >> 12 ),
+						static_cast<unsigned char>( rng >> 20 ) );
+				}
+				image.PutPixel( x,y,c );
+			}
+		}
+		return image;
+	}
+
+	// size and color channels only; none of the formats keep the X channel
+	bool SameImage( const Surface& a,const Surface& b )
+	{
+		if( a.GetWidth() != b.GetWidth() || a.GetHeight() != b.GetHeight() )
+		{
+			return false;
+		}
+		for( unsigned int y = 0u; y < a.GetHeight(); y++ )
+		{
+			for( unsigned int x = 0u; x < a.GetWidth(); x++ )
+			{
+				const Color ca = a.GetPixel( x,y );
+				const Color cb = b.GetPixel( x,y );
+				if( ca.GetR() != cb.GetR() || ca.GetG() != cb.GetG() || ca.GetB() != cb.GetB() )
+				{
+					return false;
+				}
+			}
+		}
+		return true;
+	}
+
+	enum class Outcome
+	{
+		Decoded,
+		Rejected,
+		// anything but Surface::Exception escaped the decoder
+		Unexpected
+	};
+
+	// decodes a copy of exactly the given bytes, so reading past them is caught by memory checkers
+	Outcome TryDecode( const unsigned char* pData,size_t size,Surface* pDecoded = nullptr )
+	{
+		const std::vector<unsigned char> bytes( pData,pData + size );
+		try
+		{
+			Surface s = DecodeImage( bytes.data(),bytes.size(),L"image check" );
+			if( pDecoded )
+			{
+				*pDecoded = std::move( s );
+			}
+			return Outcome::Decoded;
+		}
+		catch( const Surface::Exception& )
+		{
+			return Outcome::Rejected;
+		}
+		catch( ... )
+		{
+			return Outcome::Unexpected;
+		}
+	}
+}
+
+bool RunImageCheck( const std::wstring& dir,std::wstring& report )
+{
+	JobSystem jobs;
+	std::wostringstream out;
+	bool passed = true;
+	for( const wchar_t* format : formats )
+	{
+		std::wostringstream problems;
+		// round trip every size, one file at a time and then all together
+		std::vector<Surface> originals;
+		std::vector<std::wstring> names;
+		unsigned int seed = 1u;
+		for( const auto& size : sizes )
+		{
+			originals.push_back( MakeImage( size.width,size.height,seed++ ) );
+			// forward slashes work on Windows as well
+			names.push_back( dir + L"/image_check_" + std::to_wstring( size.width ) + L"x" +
+				std::to_wstring( size.height ) + L"." + format );
+			try
+			{
+				originals.back().Save( names.back() );
+				if( !SameImage( Surface::FromFile( names.back() ),originals.back() ) )
+				{
+					problems << L"\n    " << size.width << L"x" << size.height << L": loaded pixels differ";
+				}
+			}
+			catch( const Surface::Exception& e )
+			{
+				problems << L"\n    " << size.width << L"x" << size.height << L": " << e.GetNote();
+			}
+		}
+		try
+		{
+			const std::vector<Surface> loaded = Surface::FromFiles( names,jobs );
+			for( size_t i = 0u; i < loaded.size(); i++ )
+			{
+				if( !SameImage( loaded[i],originals[i] ) )
+				{
+					problems << L"\n    FromFiles: " << names[i] << L" differs";
+				}
+			}
+		}
+		catch( const Surface::Exception& e )
+		{
+			problems << L"\n    FromFiles: " << e.GetNote();
+		}
+
+		// damage the largest file; a cut may only go unnoticed if all it removed was padding
+		size_t nTruncations = 0u;
+		size_t nCorruptions = 0u;
+		const MappedFile file( names[3] );
+		if( !file )
+		{
+			problems << L"\n    could not reopen " << names[3];
+		}
+		else
+		{
+			const unsigned char* const pData = file.GetData();
+			const size_t fileSize = file.GetSize();
+			std::vector<size_t> lengths;
+			for( size_t n = 0u; n < std::min( fileSize,size_t( 64u ) ); n++ )
+			{
+				lengths.push_back( n );
+			}
+			for( size_t k = 1u; k < 32u; k++ )
+			{
+				lengths.push_back( fileSize * k / 32u );
+			}
+			lengths.push_back( fileSize - 1u );
+			for( size_t n : lengths )
+			{
+				Surface decoded( 1u,1u );
+				const Outcome outcome = TryDecode( pData,n,&decoded );
+				nTruncations++;
+				if( outcome == Outcome::Unexpected ||
+					(outcome == Outcome::Decoded && !SameImage( decoded,originals[3] )) )
+				{
+					problems << L"\n    cut to " << n << L" of " << fileSize << L" bytes: "
+						<< (outcome == Outcome::Unexpected ? L"unexpected exception" : L"accepted");
+				}
+			}
+			std::vector<unsigned char> bytes( pData,pData + fileSize );
+			const unsigned char fills[] = { 0x00u,0xFFu };
+			for( size_t i = 0u; i < std::min( fileSize,size_t( 64u ) ); i++ )
+			{
+				for( unsigned char value : fills )
+				{
+					const unsigned char original = bytes[i];
+					bytes[i] = value;
+					nCorruptions++;
+					if( TryDecode( bytes.data(),bytes.size() ) == Outcome::Unexpected )
+					{
+						problems << L"\n    byte " << i << L" set to " << static_cast<unsigned int>( value )
+							<< L": unexpected exception";
+					}
+					bytes[i] = original;
+				}
+			}
+		}
+
+		const std::wstring formatProblems = problems.str();
+		out << format << L": " << sizeof( sizes ) / sizeof( *sizes ) << L" sizes round tripped, "
+			<< nTruncations << L" truncations and " << nCorruptions << L" corrupt headers tried"
+			<< (formatProblems.empty() ? L" ok" : L" FAILED") << formatProblems << L"\n";
+		passed = passed && formatProblems.empty();
+	}
+	out << (passed ? L"\nAll formats ok.\n" : L"\nSome formats failed.\n");
+	report = out.str();
+	return passed;
+}
@@ -0,0 +1,31 @@
+/******************************************************************************************
+*	Chili DirectX Framework Version 16.10.01											  *
+*	ImageCheck.h																		  *
+*	Copyright 2016 PlanetChili <http://www.planetchili.net>								  *
+*																						  *
+*	This file is part of The Chili DirectX Framework.									  *
+*																						  *
+*	The Chili DirectX Framework is free software: you can redistribute it and/or modify	  *
+*	it under the terms of the GNU General Public License as published by				  *
+*	the Free Software Foundation, either version 3 of the License, or					  *
+*	(at your option) any later version.													  *
+*																						  *
+*	The Chili DirectX Framework is distributed in the hope that it will be useful,		  *
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of						  *
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the						  *
+*	GNU General Public License for more details.										  *
+*																						  *
+*	You should have received a copy of the GNU General Public License					  *
+*	along with The Chili DirectX Framework.  If not, see <http://www.gnu.org/licenses/>.  *
+******************************************************************************************/
+#pragma once
+
+#include <string>
+
+// checks the image encoder and decoders against each other for every format Surface::Save
+// writes (BMP, TGA, PPM, QOI): images of odd sizes are saved into dir and must load back
+// (through FromFile and FromFiles) with the same pixels; then every prefix of the header and a
+// spread of prefixes through the pixel data must be rejected with Surface::Exception, and
+// header bytes overwritten with 0x00 or 0xFF must either decode or be rejected that way
+// report gets a line per format; returns false if anything failed
+bool RunImageCheck( const std::wstring& dir,std::wstring& report );
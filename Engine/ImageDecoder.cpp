@@ -0,0 +1,569 @@
+/******************************************************************************************
+*	Chili DirectX Framework Version 16.10.01											  *
+*	ImageDecoder.cpp																	  *
+*	Copyright 2016 PlanetChili <http://www.planetchili.net>								  *
+*																						  *
+*	This file is part of The Chili DirectX Framework.									  *
+*																						  *
+*	The Chili DirectX Framework is free software: you can redistribute it and/or modify	  *
+*	it under the terms of the GNU General Public License as published by				  *
+*	the Free Software Foundation, either version 3 of the License, or					  *
+*	(at your option) any later version.													  *
+*																						  *
+*	The Chili DirectX Framework is distributed in the hope that it will be useful,		  *
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of						  *
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the						  *
+*	GNU General Public License for more details.										  *
+*																						  *
+*	You should have received a copy of the GNU General Public License					  *
+*	along with The Chili DirectX Framework.  If not, see <http://www.gnu.org/licenses/>.  *
+******************************************************************************************/
+#include "ImageDecoder.h"
+#include "ChiliException.h"
+#include <sstream>
+#include <algorithm>
+#include <cstring>
+#include <cctype>
+#include <vector>
+#include <emmintrin.h>
+#if defined( __AVX__ ) || defined( __SSSE3__ )
+#include <tmmintrin.h>
+#endif
+
+namespace
+{
+	// larger than any sane texture, and small enough that pitch * height can't overflow
+	constexpr unsigned int maxDimension = 16384u;
+
+	std::wstring Message( const std::wstring& name,const wchar_t* problem )
+	{
+		std::wstringstream ss;
+		ss << L"Loading image [" << name << L"]: " << problem;
+		return ss.str();
+	}
+
+	unsigned int U16LE( const unsigned char* p )
+	{
+		return p[0] | (p[1] << 8);
+	}
+	unsigned int U32LE( const unsigned char* p )
+	{
+		return p[0] | (p[1] << 8) | (p[2] << 16) | (static_cast<unsigned int>( p[3] ) << 24);
+	}
+	unsigned int U32BE( const unsigned char* p )
+	{
+		return (static_cast<unsigned int>( p[0] ) << 24) | (p[1] << 16) | (p[2] << 8) | p[3];
+	}
+
+	// row converters from file pixel order into Color (B,G,R,X in memory)
+
+	// 3 byte B,G,R pixels (BMP, TGA)
+	void ConvertBGR( const unsigned char* pSrc,Color* pDst,unsigned int count )
+	{
+		unsigned int i = 0u;
+#if defined( __AVX__ ) || defined( __SSSE3__ )
+		// already in the right order, each pixel just gains an opaque fourth byte
+		const __m128i shuffle = _mm_setr_epi8( 0,1,2,-1,3,4,5,-1,6,7,8,-1,9,10,11,-1 );
+		const __m128i alpha = _mm_set1_epi32( static_cast<int>( 0xFF000000u ) );
+		// each load takes 16 bytes to use 12, so stop while a whole load still fits in the row
+		for( ; i + 6u <= count; i += 4u )
+		{
+			const __m128i src = _mm_loadu_si128( reinterpret_cast<const __m128i*>(pSrc + 3u * i) );
+			_mm_storeu_si128( reinterpret_cast<__m128i*>(pDst + i),_mm_or_si128( _mm_shuffle_epi8( src,shuffle ),alpha ) );
+		}
+#endif
+		for( ; i < count; i++ )
+		{
+			pDst[i] = Color( 255u,pSrc[3u * i + 2u],pSrc[3u * i + 1u],pSrc[3u * i] );
+		}
+	}
+
+	// 3 byte R,G,B pixels (PPM)
+	void ConvertRGB( const unsigned char* pSrc,Color* pDst,unsigned int count )
+	{
+		unsigned int i = 0u;
+#if defined( __AVX__ ) || defined( __SSSE3__ )
+		const __m128i shuffle = _mm_setr_epi8( 2,1,0,-1,5,4,3,-1,8,7,6,-1,11,10,9,-1 );
+		const __m128i alpha = _mm_set1_epi32( static_cast<int>( 0xFF000000u ) );
+		for( ; i + 6u <= count; i += 4u )
+		{
+			const __m128i src = _mm_loadu_si128( reinterpret_cast<const __m128i*>(pSrc + 3u * i) );
+			_mm_storeu_si128( reinterpret_cast<__m128i*>(pDst + i),_mm_or_si128( _mm_shuffle_epi8( src,shuffle ),alpha ) );
+		}
+#endif
+		for( ; i < count; i++ )
+		{
+			pDst[i] = Color( 255u,pSrc[3u * i],pSrc[3u * i + 1u],pSrc[3u * i + 2u] );
+		}
+	}
+
+	// 4 byte B,G,R,A pixels (BMP, TGA); forceOpaque when the fourth byte is only padding
+	void ConvertBGRA( const unsigned char* pSrc,Color* pDst,unsigned int count,bool forceOpaque )
+	{
+		if( !forceOpaque )
+		{
+			memcpy( static_cast<void*>( pDst ),pSrc,sizeof( Color ) * count );
+			return;
+		}
+		unsigned int i = 0u;
+		const __m128i alpha = _mm_set1_epi32( static_cast<int>( 0xFF000000u ) );
+		for( ; i + 4u <= count; i += 4u )
+		{
+			const __m128i src = _mm_loadu_si128( reinterpret_cast<const __m128i*>(pSrc + 4u * i) );
+			_mm_storeu_si128( reinterpret_cast<__m128i*>(pDst + i),_mm_or_si128( src,alpha ) );
+		}
+		for( ; i < count; i++ )
+		{
+			pDst[i] = Color( U32LE( pSrc + 4u * i ) | 0xFF000000u );
+		}
+	}
+
+	// 1 byte gray pixels (TGA, PGM)
+	void ConvertGray( const unsigned char* pSrc,Color* pDst,unsigned int count )
+	{
+		unsigned int i = 0u;
+		// interleave gray with itself, then with 0xFF, giving G,G,G,FF per pixel
+		const __m128i ones = _mm_set1_epi8( -1 );
+		for( ; i + 16u <= count; i += 16u )
+		{
+			const __m128i g = _mm_loadu_si128( reinterpret_cast<const __m128i*>(pSrc + i) );
+			const __m128i gg0 = _mm_unpacklo_epi8( g,g );
+			const __m128i gg1 = _mm_unpackhi_epi8( g,g );
+			const __m128i ga0 = _mm_unpacklo_epi8( g,ones );
+			const __m128i ga1 = _mm_unpackhi_epi8( g,ones );
+			__m128i* const pOut = reinterpret_cast<__m128i*>(pDst + i);
+			_mm_storeu_si128( pOut,_mm_unpacklo_epi16( gg0,ga0 ) );
+			_mm_storeu_si128( pOut + 1,_mm_unpackhi_epi16( gg0,ga0 ) );
+			_mm_storeu_si128( pOut + 2,_mm_unpacklo_epi16( gg1,ga1 ) );
+			_mm_storeu_si128( pOut + 3,_mm_unpackhi_epi16( gg1,ga1 ) );
+		}
+		for( ; i < count; i++ )
+		{
+			pDst[i] = Color( 255u,pSrc[i],pSrc[i],pSrc[i] );
+		}
+	}
+
+	bool DimensionsOk( unsigned int width,unsigned int height )
+	{
+		return width != 0u && height != 0u && width <= maxDimension && height <= maxDimension;
+	}
+
+	Surface DecodeBmp( const unsigned char* pData,size_t size,const std::wstring& name )
+	{
+		if( size < 14u + 40u )
+		{
+			throw Surface::Exception( _CRT_WIDE( __FILE__ ),__LINE__,Message( name,L"truncated BMP header." ) );
+		}
+		const unsigned int dataOffset = U32LE( pData + 10 );
+		const unsigned int headerSize = U32LE( pData + 14 );
+		const int signedWidth = static_cast<int>( U32LE( pData + 18 ) );
+		const int signedHeight = static_cast<int>( U32LE( pData + 22 ) );
+		const unsigned int bitCount = U16LE( pData + 28 );
+		const unsigned int compression = U32LE( pData + 30 );
+		// negative height means rows are stored top to bottom
+		const bool topDown = signedHeight < 0;
+		const unsigned int width = signedWidth > 0 ? static_cast<unsigned int>( signedWidth ) : 0u;
+		const unsigned int height = signedHeight == 0 || signedHeight < -int( maxDimension ) ? 0u :
+			static_cast<unsigned int>( topDown ? -signedHeight : signedHeight );
+		if( headerSize < 40u || size_t( 14u ) + headerSize > size || !DimensionsOk( width,height ) )
+		{
+			throw Surface::Exception( _CRT_WIDE( __FILE__ ),__LINE__,Message( name,L"invalid BMP header." ) );
+		}
+
+		// BI_RGB, or BI_BITFIELDS with the masks of plain 32 bit BGRA
+		constexpr unsigned int biRgb = 0u;
+		constexpr unsigned int biBitfields = 3u;
+		bool forceOpaque = true;
+		if( compression == biBitfields && bitCount == 32u )
+		{
+			// masks follow a 40 byte header, and sit at the same place inside larger ones
+			if( size < 14u + 40u + 12u ||
+				U32LE( pData + 54 ) != 0x00FF0000u || U32LE( pData + 58 ) != 0x0000FF00u || U32LE( pData + 62 ) != 0x000000FFu )
+			{
+				throw Surface::Exception( _CRT_WIDE( __FILE__ ),__LINE__,Message( name,L"unsupported BMP channel masks." ) );
+			}
+			forceOpaque = headerSize < 56u || U32LE( pData + 66 ) != 0xFF000000u;
+		}
+		else if( compression != biRgb || (bitCount != 8u && bitCount != 24u && bitCount != 32u) )
+		{
+			throw Surface::Exception( _CRT_WIDE( __FILE__ ),__LINE__,Message( name,L"unsupported BMP pixel format." ) );
+		}
+
+		// rows are padded to 4 bytes; the last one may be missing its padding
+		const size_t stride = (size_t( width ) * bitCount + 31u) / 32u * 4u;
+		const size_t rowBytes = size_t( width ) * bitCount / 8u;
+		if( dataOffset > size || size - dataOffset < rowBytes || (size - dataOffset - rowBytes) / stride < height - 1u )
+		{
+			throw Surface::Exception( _CRT_WIDE( __FILE__ ),__LINE__,Message( name,L"truncated BMP pixel data." ) );
+		}
+
+		Color palette[256] = {};
+		if( bitCount == 8u )
+		{
+			const unsigned int colorsUsed = U32LE( pData + 46 );
+			const unsigned int nColors = colorsUsed == 0u || colorsUsed > 256u ? 256u : colorsUsed;
+			const size_t paletteOffset = size_t( 14u ) + headerSize;
+			if( paletteOffset + size_t( nColors ) * 4u > size )
+			{
+				throw Surface::Exception( _CRT_WIDE( __FILE__ ),__LINE__,Message( name,L"truncated BMP palette." ) );
+			}
+			for( unsigned int i = 0u; i < nColors; i++ )
+			{
+				palette[i] = Color( U32LE( pData + paletteOffset + 4u * i ) | 0xFF000000u );
+			}
+		}
+
+		Surface surface( width,height,Surface::RowAlignment::CacheLine );
+		Color* const pPixels = surface.GetBufferPtr();
+		const unsigned int pitch = surface.GetPitch();
+		for( unsigned int y = 0u; y < height; y++ )
+		{
+			const unsigned char* const pRow = pData + dataOffset + stride * (topDown ? y : height - 1u - y);
+			Color* const pDst = pPixels + size_t( pitch ) * y;
+			switch( bitCount )
+			{
+			case 8u:
+				for( unsigned int x = 0u; x < width; x++ )
+				{
+					pDst[x] = palette[pRow[x]];
+				}
+				break;
+			case 24u:
+				ConvertBGR( pRow,pDst,width );
+				break;
+			default:
+				ConvertBGRA( pRow,pDst,width,forceOpaque );
+				break;
+			}
+		}
+		return surface;
+	}
+
+	// TGA has no signature, so this checks that the header is one we can decode
+	bool IsTga( const unsigned char* pData,size_t size )
+	{
+		if( size < 18u )
+		{
+			return false;
+		}
+		const unsigned int colorMapType = pData[1];
+		const unsigned int imageType = pData[2];
+		const unsigned int depth = pData[16];
+		const bool trueColor = (imageType == 2u || imageType == 10u) && (depth == 24u || depth == 32u);
+		const bool gray = (imageType == 3u || imageType == 11u) && depth == 8u;
+		return colorMapType <= 1u && (trueColor || gray) && DimensionsOk( U16LE( pData + 12 ),U16LE( pData + 14 ) );
+	}
+
+	Surface DecodeTga( const unsigned char* pData,size_t size,const std::wstring& name )
+	{
+		const unsigned int idLength = pData[0];
+		const unsigned int colorMapType = pData[1];
+		const unsigned int imageType = pData[2];
+		const unsigned int colorMapLength = U16LE( pData + 5 );
+		const unsigned int colorMapEntryBits = pData[7];
+		const unsigned int width = U16LE( pData + 12 );
+		const unsigned int height = U16LE( pData + 14 );
+		const unsigned int bytesPerPixel = pData[16] / 8u;
+		const unsigned int descriptor = pData[17];
+		// bit 5 set means rows are stored top to bottom, bit 4 right to left
+		const bool topDown = (descriptor & 0x20u) != 0u;
+		if( (descriptor & 0x10u) != 0u )
+		{
+			throw Surface::Exception( _CRT_WIDE( __FILE__ ),__LINE__,Message( name,L"right-to-left TGA is not supported." ) );
+		}
+		// a 32 bit image without alpha bits declared just has padding there
+		const bool forceOpaque = (descriptor & 0x0Fu) == 0u;
+		// true color images may still carry a color map, which is skipped
+		const size_t dataOffset = 18u + idLength + (colorMapType == 1u ? size_t( colorMapLength ) * ((colorMapEntryBits + 7u) / 8u) : 0u);
+		const size_t imageBytes = size_t( width ) * height * bytesPerPixel;
+		if( dataOffset > size )
+		{
+			throw Surface::Exception( _CRT_WIDE( __FILE__ ),__LINE__,Message( name,L"truncated TGA header." ) );
+		}
+
+		const unsigned char* pImage = pData + dataOffset;
+		// RLE packets may run across rows, so expand the whole image before converting
+		std::vector<unsigned char> expanded;
+		if( imageType == 10u || imageType == 11u )
+		{
+			expanded.resize( imageBytes );
+			size_t in = dataOffset;
+			size_t out = 0u;
+			while( out < imageBytes )
+			{
+				if( in >= size )
+				{
+					throw Surface::Exception( _CRT_WIDE( __FILE__ ),__LINE__,Message( name,L"truncated TGA pixel data." ) );
+				}
+				const unsigned int packet = pData[in++];
+				const size_t count = std::min( size_t( (packet & 0x7Fu) + 1u ),(imageBytes - out) / bytesPerPixel );
+				// high bit: one pixel repeated, otherwise count literal pixels
+				const size_t packetBytes = (packet & 0x80u) != 0u ? bytesPerPixel : count * bytesPerPixel;
+				if( packetBytes > size - in )
+				{
+					throw Surface::Exception( _CRT_WIDE( __FILE__ ),__LINE__,Message( name,L"truncated TGA pixel data." ) );
+				}
+				if( (packet & 0x80u) != 0u )
+				{
+					for( size_t i = 0u; i < count; i++ )
+					{
+						memcpy( &expanded[out + i * bytesPerPixel],pData + in,bytesPerPixel );
+					}
+				}
+				else
+				{
+					memcpy( &expanded[out],pData + in,packetBytes );
+				}
+				in += packetBytes;
+				out += count * bytesPerPixel;
+			}
+			pImage = expanded.data();
+		}
+		else if( imageBytes > size - dataOffset )
+		{
+			throw Surface::Exception( _CRT_WIDE( __FILE__ ),__LINE__,Message( name,L"truncated TGA pixel data." ) );
+		}
+
+		Surface surface( width,height,Surface::RowAlignment::CacheLine );
+		Color* const pPixels = surface.GetBufferPtr();
+		const unsigned int pitch = surface.GetPitch();
+		const size_t stride = size_t( width ) * bytesPerPixel;
+		for( unsigned int y = 0u; y < height; y++ )
+		{
+			const unsigned char* const pRow = pImage + stride * (topDown ? y : height - 1u - y);
+			Color* const pDst = pPixels + size_t( pitch ) * y;
+			switch( bytesPerPixel )
+			{
+			case 1u:
+				ConvertGray( pRow,pDst,width );
+				break;
+			case 3u:
+				ConvertBGR( pRow,pDst,width );
+				break;
+			default:
+				ConvertBGRA( pRow,pDst,width,forceOpaque );
+				break;
+			}
+		}
+		return surface;
+	}
+
+	// reads the next decimal number of a netpbm header, skipping whitespace and comments;
+	// returns false if there isn't one
+	bool ReadPnmNumber( const unsigned char* pData,size_t size,size_t& pos,unsigned int& value )
+	{
+		while( pos < size && (isspace( pData[pos] ) || pData[pos] == '#') )
+		{
+			if( pData[pos] == '#' )
+			{
+				while( pos < size && pData[pos] != '\n' )
+				{
+					pos++;
+				}
+			}
+			else
+			{
+				pos++;
+			}
+		}
+		if( pos == size || !isdigit( pData[pos] ) )
+		{
+			return false;
+		}
+		value = 0u;
+		for( ; pos < size && isdigit( pData[pos] ); pos++ )
+		{
+			// anything this long is far past maxDimension anyway
+			value = std::min( value * 10u + (pData[pos] - '0'),0x7FFFFFFFu / 10u );
+		}
+		return true;
+	}
+
+	Surface DecodePnm( const unsigned char* pData,size_t size,const std::wstring& name )
+	{
+		const bool gray = pData[1] == '5';
+		size_t pos = 2u;
+		unsigned int width = 0u;
+		unsigned int height = 0u;
+		unsigned int maxValue = 0u;
+		if( !ReadPnmNumber( pData,size,pos,width ) || !ReadPnmNumber( pData,size,pos,height ) ||
+			!ReadPnmNumber( pData,size,pos,maxValue ) || pos == size || !isspace( pData[pos] ) ||
+			!DimensionsOk( width,height ) )
+		{
+			throw Surface::Exception( _CRT_WIDE( __FILE__ ),__LINE__,Message( name,L"invalid PPM header." ) );
+		}
+		// exactly one whitespace byte separates the header from the pixels
+		pos++;
+		if( maxValue == 0u || maxValue > 255u )
+		{
+			throw Surface::Exception( _CRT_WIDE( __FILE__ ),__LINE__,Message( name,L"only 8 bit PPM is supported." ) );
+		}
+		const unsigned int bytesPerPixel = gray ? 1u : 3u;
+		const size_t stride = size_t( width ) * bytesPerPixel;
+		if( stride * height > size - pos )
+		{
+			throw Surface::Exception( _CRT_WIDE( __FILE__ ),__LINE__,Message( name,L"truncated PPM pixel data." ) );
+		}
+
+		Surface surface( width,height,Surface::RowAlignment::CacheLine );
+		Color* const pPixels = surface.GetBufferPtr();
+		const unsigned int pitch = surface.GetPitch();
+		// samples below 8 bits are stretched to the full range through a table
+		unsigned char scale[256];
+		for( unsigned int v = 0u; v < 256u; v++ )
+		{
+			scale[v] = static_cast<unsigned char>( std::min( v,maxValue ) * 255u / maxValue );
+		}
+		for( unsigned int y = 0u; y < height; y++ )
+		{
+			const unsigned char* const pRow = pData + pos + stride * y;
+			Color* const pDst = pPixels + size_t( pitch ) * y;
+			if( maxValue != 255u )
+			{
+				for( unsigned int x = 0u; x < width; x++ )
+				{
+					const unsigned char* const p = pRow + x * bytesPerPixel;
+					pDst[x] = gray ? Color( 255u,scale[p[0]],scale[p[0]],scale[p[0]] ) :
+						Color( 255u,scale[p[0]],scale[p[1]],scale[p[2]] );
+				}
+			}
+			else if( gray )
+			{
+				ConvertGray( pRow,pDst,width );
+			}
+			else
+			{
+				ConvertRGB( pRow,pDst,width );
+			}
+		}
+		return surface;
+	}
+
+	// see qoiformat.org; the format is a single sequential stream, so it decodes pixel by pixel
+	Surface DecodeQoi( const unsigned char* pData,size_t size,const std::wstring& name )
+	{
+		constexpr size_t headerSize = 14u;
+		constexpr size_t endMarkerSize = 8u;
+		if( size < headerSize + endMarkerSize )
+		{
+			throw Surface::Exception( _CRT_WIDE( __FILE__ ),__LINE__,Message( name,L"truncated QOI header." ) );
+		}
+		const unsigned int width = U32BE( pData + 4 );
+		const unsigned int height = U32BE( pData + 8 );
+		const unsigned int channels = pData[12];
+		if( !DimensionsOk( width,height ) || (channels != 3u && channels != 4u) )
+		{
+			throw Surface::Exception( _CRT_WIDE( __FILE__ ),__LINE__,Message( name,L"invalid QOI header." ) );
+		}
+
+		Surface surface( width,height,Surface::RowAlignment::CacheLine );
+		Color* const pPixels = surface.GetBufferPtr();
+		const unsigned int pitch = surface.GetPitch();
+		// previously seen pixels, by hash
+		Color index[64] = {};
+		unsigned char r = 0u;
+		unsigned char g = 0u;
+		unsigned char b = 0u;
+		unsigned char a = 255u;
+		unsigned int run = 0u;
+		size_t pos = headerSize;
+		const size_t end = size - endMarkerSize;
+		for( unsigned int y = 0u; y < height; y++ )
+		{
+			Color* const pDst = pPixels + size_t( pitch ) * y;
+			for( unsigned int x = 0u; x < width; x++ )
+			{
+				if( run > 0u )
+				{
+					run--;
+					pDst[x] = Color( a,r,g,b );
+					continue;
+				}
+				if( pos >= end )
+				{
+					throw Surface::Exception( _CRT_WIDE( __FILE__ ),__LINE__,Message( name,L"truncated QOI pixel data." ) );
+				}
+				const unsigned int op = pData[pos++];
+				if( op == 0xFEu || op == 0xFFu )
+				{
+					// literal RGB or RGBA
+					if( end - pos < (op == 0xFFu ? 4u : 3u) )
+					{
+						throw Surface::Exception( _CRT_WIDE( __FILE__ ),__LINE__,Message( name,L"truncated QOI pixel data." ) );
+					}
+					r = pData[pos++];
+					g = pData[pos++];
+					b = pData[pos++];
+					if( op == 0xFFu )
+					{
+						a = pData[pos++];
+					}
+				}
+				else
+				{
+					switch( op >> 6 )
+					{
+					case 0u:
+					{
+						const Color c = index[op];
+						r = c.GetR();
+						g = c.GetG();
+						b = c.GetB();
+						a = c.GetA();
+						break;
+					}
+					case 1u:
+						// small difference from the previous pixel, biased by 2
+						r = static_cast<unsigned char>( r + ((op >> 4) & 0x03u) - 2u );
+						g = static_cast<unsigned char>( g + ((op >> 2) & 0x03u) - 2u );
+						b = static_cast<unsigned char>( b + (op & 0x03u) - 2u );
+						break;
+					case 2u:
+					{
+						// green difference, with red and blue relative to it
+						if( pos >= end )
+						{
+							throw Surface::Exception( _CRT_WIDE( __FILE__ ),__LINE__,Message( name,L"truncated QOI pixel data." ) );
+						}
+						const unsigned int next = pData[pos++];
+						const unsigned int dg = (op & 0x3Fu) - 32u;
+						r = static_cast<unsigned char>( r + dg - 8u + ((next >> 4) & 0x0Fu) );
+						g = static_cast<unsigned char>( g + dg );
+						b = static_cast<unsigned char>( b + dg - 8u + (next & 0x0Fu) );
+						break;
+					}
+					default:
+						// this pixel plus up to 61 more of the same
+						run = op & 0x3Fu;
+						break;
+					}
+				}
+				const Color c( a,r,g,b );
+				index[(r * 3u + g * 5u + b * 7u + a * 11u) % 64u] = c;
+				pDst[x] = c;
+			}
+		}
+		return surface;
+	}
+}
+
+Surface DecodeImage( const unsigned char* pData,size_t size,const std::wstring& name )
+{
+	if( size >= 2u && pData[0] == 'B' && pData[1] == 'M' )
+	{
+		return DecodeBmp( pData,size,name );
+	}
+	if( size >= 4u && memcmp( pData,"qoif",4u ) == 0 )
+	{
+		return DecodeQoi( pData,size,name );
+	}
+	if( size >= 2u && pData[0] == 'P' && (pData[1] == '5' || pData[1] == '6') )
+	{
+		return DecodePnm( pData,size,name );
+	}
+	if( IsTga( pData,size ) )
+	{
+		return DecodeTga( pData,size,name );
+	}
+	throw Surface::Exception( _CRT_WIDE( __FILE__ ),__LINE__,Message( name,L"unrecognized image format." ) );
+}
@@ -0,0 +1,33 @@
+/******************************************************************************************
+*	Chili DirectX Framework Version 16.10.01											  *
+*	ImageDecoder.h																		  *
+*	Copyright 2016 PlanetChili <http://www.planetchili.net>								  *
+*																						  *
+*	This file is part of The Chili DirectX Framework.									  *
+*																						  *
+*	The Chili DirectX Framework is free software: you can redistribute it and/or modify	  *
+*	it under the terms of the GNU General Public License as published by				  *
+*	the Free Software Foundation, either version 3 of the License, or					  *
+*	(at your option) any later version.													  *
+*																						  *
+*	The Chili DirectX Framework is distributed in the hope that it will be useful,		  *
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of						  *
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the						  *
+*	GNU General Public License for more details.										  *
+*																						  *
+*	You should have received a copy of the GNU General Public License					  *
+*	along with The Chili DirectX Framework.  If not, see <http://www.gnu.org/licenses/>.  *
+******************************************************************************************/
+#pragma once
+
+#include "Surface.h"
+#include <string>
+
+// decodes an image held entirely in memory, picking the format from its contents:
+//   BMP  uncompressed 8 (palette), 24 and 32 bit
+//   TGA  true color (24/32 bit) and grayscale, raw or RLE
+//   PPM  binary P6 (and P5 grayscale), up to 8 bits per channel
+//   QOI  3 and 4 channel
+// formats without alpha come out opaque; name is only used in error messages
+// throws Surface::Exception if the data is malformed or in an unsupported variant
+Surface DecodeImage( const unsigned char* pData,size_t size,const std::wstring& name );
@@ -0,0 +1,316 @@
+/******************************************************************************************
+*	Chili DirectX Framework Version 16.10.01											  *
+*	ImageEncoder.cpp																	  *
+*	Copyright 2016 PlanetChili <http://www.planetchili.net>								  *
+*																						  *
+*	This file is part of The Chili DirectX Framework.									  *
+*																						  *
+*	The Chili DirectX Framework is free software: you can redistribute it and/or modify	  *
+*	it under the terms of the GNU General Public License as published by				  *
+*	the Free Software Foundation, either version 3 of the License, or					  *
+*	(at your option) any later version.													  *
+*																						  *
+*	The Chili DirectX Framework is distributed in the hope that it will be useful,		  *
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of						  *
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the						  *
+*	GNU General Public License for more details.										  *
+*																						  *
+*	You should have received a copy of the GNU General Public License					  *
+*	along with The Chili DirectX Framework.  If not, see <http://www.gnu.org/licenses/>.  *
+******************************************************************************************/
+#include "ImageEncoder.h"
+#include "Surface.h"
+#include "FileWriter.h"
+#include <sstream>
+#include <vector>
+#include <algorithm>
+#include <cwctype>
+#include <emmintrin.h>
+#if defined( __AVX__ ) || defined( __SSSE3__ )
+#include <tmmintrin.h>
+#endif
+
+namespace
+{
+	enum class Format
+	{
+		Bmp,
+		Tga,
+		Ppm,
+		Qoi,
+		Unknown
+	};
+
+	Format FormatFromExtension( const std::wstring& filename )
+	{
+		const size_t dot = filename.rfind( L'.' );
+		if( dot == std::wstring::npos )
+		{
+			return Format::Unknown;
+		}
+		std::wstring ext = filename.substr( dot + 1u );
+		for( wchar_t& c : ext )
+		{
+			c = static_cast<wchar_t>( towlower( c ) );
+		}
+		if( ext == L"bmp" )
+		{
+			return Format::Bmp;
+		}
+		if( ext == L"tga" )
+		{
+			return Format::Tga;
+		}
+		if( ext == L"ppm" )
+		{
+			return Format::Ppm;
+		}
+		if( ext == L"qoi" )
+		{
+			return Format::Qoi;
+		}
+		return Format::Unknown;
+	}
+
+	std::wstring Message( const std::wstring& filename,const wchar_t* problem )
+	{
+		std::wstringstream ss;
+		ss << L"Saving surface to [" << filename << L"]: " << problem;
+		return ss.str();
+	}
+
+	void PutU16LE( unsigned char* p,unsigned int v )
+	{
+		p[0] = static_cast<unsigned char>( v );
+		p[1] = static_cast<unsigned char>( v >> 8 );
+	}
+	void PutU32LE( unsigned char* p,unsigned int v )
+	{
+		PutU16LE( p,v );
+		PutU16LE( p + 2,v >> 16 );
+	}
+	void PutU32BE( unsigned char* p,unsigned int v )
+	{
+		p[0] = static_cast<unsigned char>( v >> 24 );
+		p[1] = static_cast<unsigned char>( v >> 16 );
+		p[2] = static_cast<unsigned char>( v >> 8 );
+		p[3] = static_cast<unsigned char>( v );
+	}
+
+	// bytes past the end of a packed row that PackBGR/PackRGB may scribble on
+	constexpr unsigned int packSlack = 4u;
+
+	// Color row to 3 byte B,G,R pixels (BMP, TGA)
+	void PackBGR( const Color* pSrc,unsigned char* pDst,unsigned int count )
+	{
+		unsigned int i = 0u;
+#if defined( __AVX__ ) || defined( __SSSE3__ )
+		// Color is already B,G,R,X in memory; squeeze out every fourth byte
+		const __m128i shuffle = _mm_setr_epi8( 0,1,2,4,5,6,8,9,10,12,13,14,-1,-1,-1,-1 );
+		for( ; i + 4u <= count; i += 4u )
+		{
+			const __m128i src = _mm_loadu_si128( reinterpret_cast<const __m128i*>(pSrc + i) );
+			_mm_storeu_si128( reinterpret_cast<__m128i*>(pDst + 3u * i),_mm_shuffle_epi8( src,shuffle ) );
+		}
+#endif
+		for( ; i < count; i++ )
+		{
+			pDst[3u * i] = pSrc[i].GetB();
+			pDst[3u * i + 1u] = pSrc[i].GetG();
+			pDst[3u * i + 2u] = pSrc[i].GetR();
+		}
+	}
+
+	// Color row to 3 byte R,G,B pixels (PPM)
+	void PackRGB( const Color* pSrc,unsigned char* pDst,unsigned int count )
+	{
+		unsigned int i = 0u;
+#if defined( __AVX__ ) || defined( __SSSE3__ )
+		const __m128i shuffle = _mm_setr_epi8( 2,1,0,6,5,4,10,9,8,14,13,12,-1,-1,-1,-1 );
+		for( ; i + 4u <= count; i += 4u )
+		{
+			const __m128i src = _mm_loadu_si128( reinterpret_cast<const __m128i*>(pSrc + i) );
+			_mm_storeu_si128( reinterpret_cast<__m128i*>(pDst + 3u * i),_mm_shuffle_epi8( src,shuffle ) );
+		}
+#endif
+		for( ; i < count; i++ )
+		{
+			pDst[3u * i] = pSrc[i].GetR();
+			pDst[3u * i + 1u] = pSrc[i].GetG();
+			pDst[3u * i + 2u] = pSrc[i].GetB();
+		}
+	}
+
+	void WriteBmp( FileWriter& out,const Color* pPixels,unsigned int width,unsigned int height,unsigned int pitch )
+	{
+		// rows are padded to 4 bytes and stored bottom to top
+		const unsigned int stride = (width * 3u + 3u) & ~3u;
+		unsigned char header[14 + 40] = {};
+		header[0] = 'B';
+		header[1] = 'M';
+		PutU32LE( header + 2,static_cast<unsigned int>( sizeof( header ) ) + stride * height );
+		PutU32LE( header + 10,static_cast<unsigned int>( sizeof( header ) ) );
+		PutU32LE( header + 14,40u );
+		PutU32LE( header + 18,width );
+		PutU32LE( header + 22,height );
+		PutU16LE( header + 26,1u );
+		PutU16LE( header + 28,24u );
+		PutU32LE( header + 34,stride * height );
+		out.Write( header,sizeof( header ) );
+		std::vector<unsigned char> row( stride + packSlack,0u );
+		for( unsigned int y = height; y-- > 0u; )
+		{
+			PackBGR( pPixels + size_t( pitch ) * y,row.data(),width );
+			// the shuffle may have spilled into the padding
+			std::fill( row.begin() + width * 3u,row.end(),static_cast<unsigned char>( 0u ) );
+			out.Write( row.data(),stride );
+		}
+	}
+
+	void WriteTga( FileWriter& out,const Color* pPixels,unsigned int width,unsigned int height,unsigned int pitch )
+	{
+		unsigned char header[18] = {};
+		// uncompressed true color
+		header[2] = 2u;
+		PutU16LE( header + 12,width );
+		PutU16LE( header + 14,height );
+		header[16] = 24u;
+		// rows stored top to bottom
+		header[17] = 0x20u;
+		out.Write( header,sizeof( header ) );
+		std::vector<unsigned char> row( width * 3u + packSlack );
+		for( unsigned int y = 0u; y < height; y++ )
+		{
+			PackBGR( pPixels + size_t( pitch ) * y,row.data(),width );
+			out.Write( row.data(),width * 3u );
+		}
+	}
+
+	void WritePpm( FileWriter& out,const Color* pPixels,unsigned int width,unsigned int height,unsigned int pitch )
+	{
+		const std::string header = "P6\n" + std::to_string( width ) + " " + std::to_string( height ) + "\n255\n";
+		out.Write( header.data(),header.size() );
+		std::vector<unsigned char> row( width * 3u + packSlack );
+		for( unsigned int y = 0u; y < height; y++ )
+		{
+			PackRGB( pPixels + size_t( pitch ) * y,row.data(),width );
+			out.Write( row.data(),width * 3u );
+		}
+	}
+
+	// see qoiformat.org; alpha is always written as opaque, so the RGBA op never comes up
+	void WriteQoi( FileWriter& out,const Color* pPixels,unsigned int width,unsigned int height,unsigned int pitch )
+	{
+		unsigned char header[14] = { 'q','o','i','f' };
+		PutU32BE( header + 4,width );
+		PutU32BE( header + 8,height );
+		header[12] = 3u;
+		header[13] = 0u;
+		out.Write( header,sizeof( header ) );
+
+		// worst case is 4 bytes per pixel, plus a run carried in from the previous row
+		std::vector<unsigned char> ops( width * 4u + 1u );
+		Color index[64] = {};
+		Color prev = Color( 255u,0u,0u,0u );
+		unsigned int run = 0u;
+		for( unsigned int y = 0u; y < height; y++ )
+		{
+			const Color* const pRow = pPixels + size_t( pitch ) * y;
+			unsigned char* p = ops.data();
+			for( unsigned int x = 0u; x < width; x++ )
+			{
+				const Color c = Color( pRow[x].dword | 0xFF000000u );
+				if( c.dword == prev.dword )
+				{
+					// runs are stored biased by 1, and 62 and 63 would clash with the RGB(A) ops
+					if( ++run == 62u )
+					{
+						*p++ = static_cast<unsigned char>( 0xC0u | (run - 1u) );
+						run = 0u;
+					}
+					continue;
+				}
+				if( run > 0u )
+				{
+					*p++ = static_cast<unsigned char>( 0xC0u | (run - 1u) );
+					run = 0u;
+				}
+				const unsigned int hash = (c.GetR() * 3u + c.GetG() * 5u + c.GetB() * 7u + 255u * 11u) % 64u;
+				if( index[hash].dword == c.dword )
+				{
+					*p++ = static_cast<unsigned char>( hash );
+				}
+				else
+				{
+					index[hash] = c;
+					// wrapping differences from the previous pixel
+					const int dr = static_cast<signed char>( c.GetR() - prev.GetR() );
+					const int dg = static_cast<signed char>( c.GetG() - prev.GetG() );
+					const int db = static_cast<signed char>( c.GetB() - prev.GetB() );
+					const int drg = dr - dg;
+					const int dbg = db - dg;
+					if( dr >= -2 && dr <= 1 && dg >= -2 && dg <= 1 && db >= -2 && db <= 1 )
+					{
+						*p++ = static_cast<unsigned char>( 0x40 | ((dr + 2) << 4) | ((dg + 2) << 2) | (db + 2) );
+					}
+					else if( dg >= -32 && dg <= 31 && drg >= -8 && drg <= 7 && dbg >= -8 && dbg <= 7 )
+					{
+						*p++ = static_cast<unsigned char>( 0x80 | (dg + 32) );
+						*p++ = static_cast<unsigned char>( ((drg + 8) << 4) | (dbg + 8) );
+					}
+					else
+					{
+						*p++ = 0xFEu;
+						*p++ = c.GetR();
+						*p++ = c.GetG();
+						*p++ = c.GetB();
+					}
+				}
+				prev = c;
+			}
+			out.Write( ops.data(),static_cast<size_t>( p - ops.data() ) );
+		}
+		if( run > 0u )
+		{
+			const unsigned char op = static_cast<unsigned char>( 0xC0u | (run - 1u) );
+			out.Write( &op,1u );
+		}
+		const unsigned char endMarker[8] = { 0u,0u,0u,0u,0u,0u,0u,1u };
+		out.Write( endMarker,sizeof( endMarker ) );
+	}
+}
+
+void EncodeImage( const Color* pPixels,unsigned int width,unsigned int height,unsigned int pitch,
+	const std::wstring& filename )
+{
+	const Format format = FormatFromExtension( filename );
+	if( format == Format::Unknown )
+	{
+		throw Surface::Exception( _CRT_WIDE( __FILE__ ),__LINE__,Message( filename,L"unknown image format." ) );
+	}
+	FileWriter out( filename );
+	if( !out )
+	{
+		throw Surface::Exception( _CRT_WIDE( __FILE__ ),__LINE__,Message( filename,L"failed to open file." ) );
+	}
+	switch( format )
+	{
+	case Format::Bmp:
+		WriteBmp( out,pPixels,width,height,pitch );
+		break;
+	case Format::Tga:
+		WriteTga( out,pPixels,width,height,pitch );
+		break;
+	case Format::Ppm:
+		WritePpm( out,pPixels,width,height,pitch );
+		break;
+	default:
+		WriteQoi( out,pPixels,width,height,pitch );
+		break;
+	}
+	out.Flush();
+	if( !out )
+	{
+		throw Surface::Exception( _CRT_WIDE( __FILE__ ),__LINE__,Message( filename,L"failed to save." ) );
+	}
+}
@@ -0,0 +1,30 @@
+/******************************************************************************************
+*	Chili DirectX Framework Version 16.10.01											  *
+*	ImageEncoder.h																		  *
+*	Copyright 2016 PlanetChili <http://www.planetchili.net>								  *
+*																						  *
+*	This file is part of The Chili DirectX Framework.									  *
+*																						  *
+*	The Chili DirectX Framework is free software: you can redistribute it and/or modify	  *
+*	it under the terms of the GNU General Public License as published by				  *
+*	the Free Software Foundation, either version 3 of the License, or					  *
+*	(at your option) any later version.													  *
+*																						  *
+*	The Chili DirectX Framework is distributed in the hope that it will be useful,		  *
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of						  *
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the						  *
+*	GNU General Public License for more details.										  *
+*																						  *
+*	You should have received a copy of the GNU General Public License					  *
+*	along with The Chili DirectX Framework.  If not, see <http://www.gnu.org/licenses/>.  *
+******************************************************************************************/
+#pragma once
+
+#include "Colors.h"
+#include <string>
+
+// writes width x height pixels (rows pitch pixels apart) to filename, in the format named by
+// its extension: .bmp (24 bit), .tga (uncompressed 24 bit), .ppm (binary P6) or .qoi (3 channel)
+// the X channel is not saved; throws Surface::Exception for an unknown extension or a failed write
+void EncodeImage( const Color* pPixels,unsigned int width,unsigned int height,unsigned int pitch,
+	const std::wstring& filename );
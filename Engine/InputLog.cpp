@@ -0,0 +1,204 @@
+/******************************************************************************************
+*	Chili DirectX Framework Version 16.10.01											  *
+*	InputLog.cpp																		  *
+*	Copyright 2016 PlanetChili <http://www.planetchili.net>								  *
+*																						  *
+*	This file is part of The Chili DirectX Framework.									  *
+*																						  *
+*	The Chili DirectX Framework is free software: you can redistribute it and/or modify	  *
+*	it under the terms of the GNU General Public License as published by				  *
+*	the Free Software Foundation, either version 3 of the License, or					  *
+*	(at your option) any later version.													  *
+*																						  *
+*	The Chili DirectX Framework is distributed in the hope that it will be useful,		  *
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of						  *
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the						  *
+*	GNU General Public License for more details.										  *
+*																						  *
+*	You should have received a copy of the GNU General Public License					  *
+*	along with The Chili DirectX Framework.  If not, see <http://www.gnu.org/licenses/>.  *
+******************************************************************************************/
+#include "InputLog.h"
+#include "Keyboard.h"
+#include "Mouse.h"
+#include <fstream>
+#include <algorithm>
+#include <assert.h>
+
+namespace
+{
+	// fixed little endian encoding so logs are portable between builds
+	void WriteU32( std::ofstream& file,unsigned int v )
+	{
+		const char bytes[4] = { char( v & 0xFFu ),char( (v >> 8) & 0xFFu ),char( (v >> 16) & 0xFFu ),char( (v >> 24) & 0xFFu ) };
+		file.write( bytes,sizeof( bytes ) );
+	}
+	void WriteU16( std::ofstream& file,unsigned short v )
+	{
+		const char bytes[2] = { char( v & 0xFFu ),char( (v >> 8) & 0xFFu ) };
+		file.write( bytes,sizeof( bytes ) );
+	}
+	unsigned int ReadU32( std::ifstream& file )
+	{
+		unsigned char bytes[4] = {};
+		file.read( reinterpret_cast<char*>(bytes),sizeof( bytes ) );
+		return bytes[0] | (bytes[1] << 8) | (bytes[2] << 16) | (static_cast<unsigned int>( bytes[3] ) << 24);
+	}
+	unsigned short ReadU16( std::ifstream& file )
+	{
+		unsigned char bytes[2] = {};
+		file.read( reinterpret_cast<char*>(bytes),sizeof( bytes ) );
+		return static_cast<unsigned short>( bytes[0] | (bytes[1] << 8) );
+	}
+	std::wstring Widen( const std::string& str )
+	{
+		return std::wstring( str.begin(),str.end() );
+	}
+}
+
+InputLog::~InputLog()
+{
+	Detach();
+}
+
+void InputLog::Attach( Keyboard& kbd,Mouse& mouse )
+{
+	Detach();
+	pKbd = &kbd;
+	pMouse = &mouse;
+	kbd.pRecordLog = this;
+	mouse.pRecordLog = this;
+}
+
+void InputLog::Detach()
+{
+	if( pKbd )
+	{
+		pKbd->pRecordLog = nullptr;
+		pMouse->pRecordLog = nullptr;
+		pKbd = nullptr;
+		pMouse = nullptr;
+	}
+}
+
+void InputLog::Record( Type type,unsigned char code,int x,int y )
+{
+	entries.push_back( { nFrames,type,code,static_cast<short>( x ),static_cast<short>( y ) } );
+}
+
+void InputLog::Replay( unsigned int frame,Keyboard& kbd,Mouse& mouse )
+{
+	assert( replayPos == entries.size() || entries[replayPos].frame >= frame );
+	for( ; replayPos < entries.size() && entries[replayPos].frame == frame; replayPos++ )
+	{
+		const Entry& e = entries[replayPos];
+		switch( e.type )
+		{
+		case Type::KeyPress:
+			kbd.OnKeyPressed( e.code );
+			break;
+		case Type::KeyRelease:
+			kbd.OnKeyReleased( e.code );
+			break;
+		case Type::Char:
+			kbd.OnChar( static_cast<char>( e.code ) );
+			break;
+		case Type::MouseMove:
+			mouse.OnMouseMove( e.x,e.y );
+			break;
+		case Type::MouseEnter:
+			mouse.OnMouseEnter();
+			break;
+		case Type::MouseLeave:
+			mouse.OnMouseLeave();
+			break;
+		case Type::LPress:
+			mouse.OnLeftPressed( e.x,e.y );
+			break;
+		case Type::LRelease:
+			mouse.OnLeftReleased( e.x,e.y );
+			break;
+		case Type::RPress:
+			mouse.OnRightPressed( e.x,e.y );
+			break;
+		case Type::RRelease:
+			mouse.OnRightReleased( e.x,e.y );
+			break;
+		case Type::WheelUp:
+			mouse.OnWheelUp( e.x,e.y );
+			break;
+		case Type::WheelDown:
+			mouse.OnWheelDown( e.x,e.y );
+			break;
+		case Type::RawDelta:
+			mouse.OnRawDelta( e.x,e.y );
+			break;
+		}
+	}
+}
+
+void InputLog::Save( const std::string& filename ) const
+{
+	std::ofstream file( filename,std::ios::binary );
+	if( !file )
+	{
+		throw Exception( _CRT_WIDE( __FILE__ ),__LINE__,L"Unable to open input log for writing: " + Widen( filename ) );
+	}
+	WriteU32( file,magic );
+	WriteU32( file,version );
+	WriteU32( file,nFrames );
+	WriteU32( file,static_cast<unsigned int>( entries.size() ) );
+	for( const Entry& e : entries )
+	{
+		WriteU32( file,e.frame );
+		const char typeAndCode[2] = { static_cast<char>( e.type ),static_cast<char>( e.code ) };
+		file.write( typeAndCode,sizeof( typeAndCode ) );
+		WriteU16( file,static_cast<unsigned short>( e.x ) );
+		WriteU16( file,static_cast<unsigned short>( e.y ) );
+	}
+	if( !file )
+	{
+		throw Exception( _CRT_WIDE( __FILE__ ),__LINE__,L"Error writing input log: " + Widen( filename ) );
+	}
+}
+
+InputLog InputLog::Load( const std::string& filename )
+{
+	std::ifstream file( filename,std::ios::binary );
+	if( !file )
+	{
+		throw Exception( _CRT_WIDE( __FILE__ ),__LINE__,L"Unable to open input log: " + Widen( filename ) );
+	}
+	// older versions are a subset of the current one
+	if( ReadU32( file ) != magic || ReadU32( file ) > version )
+	{
+		throw Exception( _CRT_WIDE( __FILE__ ),__LINE__,L"Not a supported input log: " + Widen( filename ) );
+	}
+	InputLog log;
+	log.nFrames = ReadU32( file );
+	const unsigned int nEntries = ReadU32( file );
+	// don't trust the count to size the allocation up front
+	log.entries.reserve( std::min( nEntries,1u << 16 ) );
+	for( unsigned int i = 0u; i < nEntries && file; i++ )
+	{
+		Entry e;
+		e.frame = ReadU32( file );
+		char typeAndCode[2] = {};
+		file.read( typeAndCode,sizeof( typeAndCode ) );
+		e.type = static_cast<Type>( typeAndCode[0] );
+		e.code = static_cast<unsigned char>( typeAndCode[1] );
+		e.x = static_cast<short>( ReadU16( file ) );
+		e.y = static_cast<short>( ReadU16( file ) );
+		if( e.type > Type::RawDelta || e.frame >= log.nFrames ||
+			(!log.entries.empty() && e.frame < log.entries.back().frame) )
+		{
+			throw Exception( _CRT_WIDE( __FILE__ ),__LINE__,L"Corrupt input log: " + Widen( filename ) );
+		}
+		log.entries.push_back( e );
+	}
+	if( !file )
+	{
+		throw Exception( _CRT_WIDE( __FILE__ ),__LINE__,L"Truncated input log: " + Widen( filename ) );
+	}
+	return log;
+}
@@ -0,0 +1,111 @@
+/******************************************************************************************
+*	Chili DirectX Framework Version 16.10.01											  *
+*	InputLog.h																			  *
+*	Copyright 2016 PlanetChili <http://www.planetchili.net>								  *
+*																						  *
+*	This file is part of The Chili DirectX Framework.									  *
+*																						  *
+*	The Chili DirectX Framework is free software: you can redistribute it and/or modify	  *
+*	it under the terms of the GNU General Public License as published by				  *
+*	the Free Software Foundation, either version 3 of the License, or					  *
+*	(at your option) any later version.													  *
+*																						  *
+*	The Chili DirectX Framework is distributed in the hope that it will be useful,		  *
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of						  *
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the						  *
+*	GNU General Public License for more details.										  *
+*																						  *
+*	You should have received a copy of the GNU General Public License					  *
+*	along with The Chili DirectX Framework.  If not, see <http://www.gnu.org/licenses/>.  *
+******************************************************************************************/
+#pragma once
+
+#include "ChiliException.h"
+#include <string>
+#include <vector>
+
+class Keyboard;
+class Mouse;
+
+// compact binary log of keyboard and mouse events, each tagged with the frame it arrived in
+// attach it to a keyboard and mouse to record, then replay it frame by frame through the
+// same event handlers the window uses
+class InputLog
+{
+public:
+	class Exception : public ChiliException
+	{
+	public:
+		using ChiliException::ChiliException;
+		virtual std::wstring GetFullMessage() const override { return GetNote() + L"\nAt: " + GetLocation(); }
+		virtual std::wstring GetExceptionType() const override { return L"Input Log Exception"; }
+	};
+	enum class Type : unsigned char
+	{
+		KeyPress,
+		KeyRelease,
+		Char,
+		MouseMove,
+		MouseEnter,
+		MouseLeave,
+		LPress,
+		LRelease,
+		RPress,
+		RRelease,
+		WheelUp,
+		WheelDown,
+		RawDelta
+	};
+	struct Entry
+	{
+		unsigned int frame;
+		Type type;
+		// key code or character for keyboard events
+		unsigned char code;
+		// cursor position for mouse events, motion for RawDelta
+		short x;
+		short y;
+	};
+public:
+	InputLog() = default;
+	InputLog( const InputLog& ) = delete;
+	InputLog& operator=( const InputLog& ) = delete;
+	InputLog( InputLog&& ) = default;
+	InputLog& operator=( InputLog&& ) = default;
+	// stops recording if still attached
+	~InputLog();
+	// record every event kbd and mouse receive until Detach
+	void Attach( Keyboard& kbd,Mouse& mouse );
+	void Detach();
+	// call once per frame while recording; events are tagged with the current frame
+	void NextFrame()
+	{
+		nFrames++;
+	}
+	void Record( Type type,unsigned char code,int x = 0,int y = 0 );
+	// feed the events recorded during frame into kbd and mouse
+	// frames must be replayed in increasing order
+	void Replay( unsigned int frame,Keyboard& kbd,Mouse& mouse );
+	// frames covered by the log, including trailing ones without events
+	unsigned int GetFrameCount() const
+	{
+		return nFrames;
+	}
+	const std::vector<Entry>& GetEntries() const
+	{
+		return entries;
+	}
+	void Save( const std::string& filename ) const;
+	static InputLog Load( const std::string& filename );
+private:
+	// 'C','H','I','L' packed little endian
+	static constexpr unsigned int magic = 0x4C494843u;
+	// version 2 added RawDelta
+	static constexpr unsigned int version = 2u;
+	std::vector<Entry> entries;
+	unsigned int nFrames = 0u;
+	// next entry to replay
+	size_t replayPos = 0u;
+	Keyboard* pKbd = nullptr;
+	Mouse* pMouse = nullptr;
+};
@@ -0,0 +1,89 @@
+/******************************************************************************************
+*	Chili DirectX Framework Version 16.10.01											  *
+*	JobBenchmark.cpp																	  *
+*	Copyright 2016 PlanetChili <http://www.planetchili.net>								  *
+*																						  *
+*	This file is part of The Chili DirectX Framework.									  *
+*																						  *
+*	The Chili DirectX Framework is free software: you can redistribute it and/or modify	  *
+*	it under the terms of the GNU General Public License as published by				  *
+*	the Free Software Foundation, either version 3 of the License, or					  *
+*	(at your option) any later version.													  *
+*																						  *
+*	The Chili DirectX Framework is distributed in the hope that it will be useful,		  *
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of						  *
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the						  *
+*	GNU General Public License for more details.										  *
+*																						  *
+*	You should have received a copy of the GNU General Public License					  *
+*	along with The Chili DirectX Framework.  If not, see <http://www.gnu.org/licenses/>.  *
+******************************************************************************************/
+#include "JobBenchmark.h"
+#include "JobSystem.h"
+#include <chrono>
+#include <sstream>
+#include <algorithm>
+
+namespace
+{
+	typedef std::chrono::steady_clock Clock;
+	typedef JobSystem::Job Job;
+
+	void Spin( std::chrono::nanoseconds duration )
+	{
+		const auto end = Clock::now() + duration;
+		while( Clock::now() < end )
+		{}
+	}
+
+	// runs nJobs children of a root job in batches that fit the per-thread job pool
+	// returns jobs per second
+	template<typename F>
+	double MeasureJobs( JobSystem& jobs,unsigned int nJobs,const F& body )
+	{
+		const unsigned int batchSize = JobSystem::maxJobsPerThread / 2u;
+		const auto start = Clock::now();
+		for( unsigned int done = 0u; done < nJobs; done += batchSize )
+		{
+			Job* const root = jobs.CreateJob( []() {} );
+			const unsigned int n = std::min( batchSize,nJobs - done );
+			for( unsigned int i = 0u; i < n; i++ )
+			{
+				jobs.Run( jobs.CreateJob( body,root ) );
+			}
+			jobs.Run( root );
+			jobs.Wait( root );
+		}
+		const std::chrono::duration<double> elapsed = Clock::now() - start;
+		return double( nJobs ) / elapsed.count();
+	}
+
+	// same amount of work split by ParallelFor, to show what adaptive grain buys back
+	template<typename F>
+	double MeasureParallelFor( JobSystem& jobs,unsigned int nItems,const F& body )
+	{
+		const auto start = Clock::now();
+		jobs.ParallelFor( 0u,nItems,[&body]( size_t ) { body(); } );
+		const std::chrono::duration<double> elapsed = Clock::now() - start;
+		return double( nItems ) / elapsed.count();
+	}
+}
+
+std::wstring RunJobBenchmark()
+{
+	JobSystem jobs;
+	const auto empty = []() {};
+	const auto busy = []() { Spin( std::chrono::microseconds( 1 ) ); };
+	// warm up threads and job pools before timing anything
+	MeasureJobs( jobs,10000u,empty );
+
+	std::wostringstream report;
+	report << std::fixed;
+	report.precision( 2 );
+	report << L"Threads: " << jobs.GetThreadCount() << L"\n\n";
+	report << L"Empty jobs: " << MeasureJobs( jobs,1000000u,empty ) / 1.0e6 << L" M jobs/s\n";
+	report << L"1 us jobs: " << MeasureJobs( jobs,200000u,busy ) / 1.0e6 << L" M jobs/s\n";
+	report << L"\nParallelFor, empty body: " << MeasureParallelFor( jobs,1000000u,empty ) / 1.0e6 << L" M items/s\n";
+	report << L"ParallelFor, 1 us body: " << MeasureParallelFor( jobs,200000u,busy ) / 1.0e6 << L" M items/s\n";
+	return report.str();
+}
@@ -0,0 +1,253 @@
+/******************************************************************************************
+*	Chili DirectX Framework Version 16.10.01											  *
+*	JobSystem.cpp																		  *
+*	Copyright 2016 PlanetChili <http://www.planetchili.net>								  *
+*																						  *
+*	This file is part of The Chili DirectX Framework.									  *
+*																						  *
+*	The Chili DirectX Framework is free software: you can redistribute it and/or modify	  *
+*	it under the terms of the GNU General Public License as published by				  *
+*	the Free Software Foundation, either version 3 of the License, or					  *
+*	(at your option) any later version.													  *
+*																						  *
+*	The Chili DirectX Framework is distributed in the hope that it will be useful,		  *
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of						  *
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the						  *
+*	GNU General Public License for more details.										  *
+*																						  *
+*	You should have received a copy of the GNU General Public License					  *
+*	along with The Chili DirectX Framework.  If not, see <http://www.gnu.org/licenses/>.  *
+******************************************************************************************/
+#include "JobSystem.h"
+
+namespace
+{
+	// context of the calling thread, if it belongs to a JobSystem
+	thread_local void* tlsContext = nullptr;
+	// job being executed by the calling thread
+	thread_local JobSystem::Job* tlsCurrentJob = nullptr;
+}
+
+void JobSystem::WorkStealingQueue::Push( Job* job )
+{
+	const long long b = bottom.load( std::memory_order_relaxed );
+	assert( b - top.load( std::memory_order_relaxed ) < (long long)maxJobsPerThread );
+	// release on the slot publishes the job contents to whoever takes it
+	jobs[b & (maxJobsPerThread - 1u)].store( job,std::memory_order_release );
+	bottom.store( b + 1,std::memory_order_release );
+}
+
+JobSystem::Job* JobSystem::WorkStealingQueue::Pop()
+{
+	const long long b = bottom.load( std::memory_order_relaxed ) - 1;
+	bottom.store( b,std::memory_order_relaxed );
+	std::atomic_thread_fence( std::memory_order_seq_cst );
+	long long t = top.load( std::memory_order_relaxed );
+	if( t > b )
+	{
+		// empty
+		bottom.store( b + 1,std::memory_order_relaxed );
+		return nullptr;
+	}
+	Job* job = jobs[b & (maxJobsPerThread - 1u)].load( std::memory_order_relaxed );
+	if( t == b )
+	{
+		// last job left, race any thieves for it
+		if( !top.compare_exchange_strong( t,t + 1,std::memory_order_seq_cst,std::memory_order_relaxed ) )
+		{
+			job = nullptr;
+		}
+		bottom.store( b + 1,std::memory_order_relaxed );
+	}
+	return job;
+}
+
+JobSystem::Job* JobSystem::WorkStealingQueue::Steal()
+{
+	long long t = top.load( std::memory_order_acquire );
+	std::atomic_thread_fence( std::memory_order_seq_cst );
+	const long long b = bottom.load( std::memory_order_acquire );
+	if( t >= b )
+	{
+		return nullptr;
+	}
+	Job* const job = jobs[t & (maxJobsPerThread - 1u)].load( std::memory_order_acquire );
+	if( !top.compare_exchange_strong( t,t + 1,std::memory_order_seq_cst,std::memory_order_relaxed ) )
+	{
+		// lost to the owner or another thief
+		return nullptr;
+	}
+	return job;
+}
+
+JobSystem::ThreadContext::ThreadContext()
+	:
+	jobStorage( std::make_unique<unsigned char[]>( (maxJobsPerThread + 1u) * sizeof( Job ) ) )
+{
+	void* p = jobStorage.get();
+	size_t space = (maxJobsPerThread + 1u) * sizeof( Job );
+	jobPool = static_cast<Job*>(std::align( sizeof( Job ),maxJobsPerThread * sizeof( Job ),p,space ));
+	for( unsigned int i = 0u; i < maxJobsPerThread; i++ )
+	{
+		new (&jobPool[i]) Job();
+	}
+}
+
+JobSystem::JobSystem( unsigned int nWorkers )
+{
+	static_assert( (maxJobsPerThread & (maxJobsPerThread - 1u)) == 0u,"queue size must be a power of two" );
+	assert( tlsContext == nullptr );
+	for( unsigned int i = 0u; i <= nWorkers; i++ )
+	{
+		contexts.push_back( std::make_unique<ThreadContext>() );
+		contexts.back()->rng = i * 2654435761u + 1u;
+	}
+	tlsContext = contexts[0].get();
+	for( unsigned int i = 1u; i <= nWorkers; i++ )
+	{
+		workers.emplace_back( &JobSystem::WorkerLoop,this,i );
+	}
+}
+
+JobSystem::~JobSystem()
+{
+	stopping = true;
+	{
+		std::lock_guard<std::mutex> lock( sleepMutex );
+		sleepCv.notify_all();
+	}
+	for( auto& w : workers )
+	{
+		w.join();
+	}
+	tlsContext = nullptr;
+}
+
+void JobSystem::Run( Job* job )
+{
+	GetContext().queue.Push( job );
+	if( nSleeping.load( std::memory_order_relaxed ) > 0 )
+	{
+		sleepCv.notify_one();
+	}
+}
+
+void JobSystem::Wait( const Job* job )
+{
+	while( !job->IsFinished() )
+	{
+		if( Job* const next = GetJob() )
+		{
+			Execute( *next );
+		}
+		else
+		{
+			std::this_thread::yield();
+		}
+	}
+}
+
+JobSystem::Job* JobSystem::AllocateJob( Job* parent )
+{
+	ThreadContext& ctx = GetContext();
+	Job* const job = &ctx.jobPool[ctx.nAllocated++ & (maxJobsPerThread - 1u)];
+	// slot must not be recycled while still in use
+	assert( job->unfinished.load( std::memory_order_acquire ) == 0 );
+	job->parent = parent;
+	job->unfinished.store( 1,std::memory_order_relaxed );
+	if( parent )
+	{
+		parent->unfinished.fetch_add( 1,std::memory_order_relaxed );
+	}
+	return job;
+}
+
+JobSystem::Job* JobSystem::GetJob()
+{
+	ThreadContext& ctx = GetContext();
+	if( Job* const job = ctx.queue.Pop() )
+	{
+		return job;
+	}
+	// own queue is empty, try to steal from a random victim
+	ctx.rng ^= ctx.rng << 13u;
+	ctx.rng ^= ctx.rng >> 17u;
+	ctx.rng ^= ctx.rng << 5u;
+	const size_t nContexts = contexts.size();
+	const size_t start = ctx.rng % nContexts;
+	for( size_t i = 0u; i < nContexts; i++ )
+	{
+		ThreadContext& victim = *contexts[(start + i) % nContexts];
+		if( &victim == &ctx )
+		{
+			continue;
+		}
+		if( Job* const job = victim.queue.Steal() )
+		{
+			return job;
+		}
+	}
+	return nullptr;
+}
+
+void JobSystem::Execute( Job& job )
+{
+	Job* const prev = tlsCurrentJob;
+	tlsCurrentJob = &job;
+	job.function( job );
+	tlsCurrentJob = prev;
+	Finish( &job );
+}
+
+void JobSystem::Finish( Job* job )
+{
+	// last one out finishes the parent as well
+	// (parent is read first: once unfinished hits zero the slot may be recycled)
+	while( job )
+	{
+		Job* const parent = job->parent;
+		if( job->unfinished.fetch_sub( 1,std::memory_order_acq_rel ) != 1 )
+		{
+			break;
+		}
+		job = parent;
+	}
+}
+
+void JobSystem::WorkerLoop( unsigned int index )
+{
+	tlsContext = contexts[index].get();
+	unsigned int misses = 0u;
+	while( !stopping.load( std::memory_order_relaxed ) )
+	{
+		if( Job* const job = GetJob() )
+		{
+			Execute( *job );
+			misses = 0u;
+		}
+		else if( ++misses < spinsBeforeSleep )
+		{
+			std::this_thread::yield();
+		}
+		else
+		{
+			// timeout covers a Run that slipped in between the check and the wait
+			std::unique_lock<std::mutex> lock( sleepMutex );
+			nSleeping++;
+			sleepCv.wait_for( lock,std::chrono::milliseconds( 1 ) );
+			nSleeping--;
+			misses = 0u;
+		}
+	}
+}
+
+JobSystem::ThreadContext& JobSystem::GetContext()
+{
+	assert( tlsContext != nullptr );
+	return *static_cast<ThreadContext*>(tlsContext);
+}
+
+JobSystem::Job* JobSystem::GetCurrentJob()
+{
+	return tlsCurrentJob;
+}
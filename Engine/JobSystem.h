@@ -0,0 +1,190 @@
+/******************************************************************************************
+*	Chili DirectX Framework Version 16.10.01											  *
+*	JobSystem.h																			  *
+*	Copyright 2016 PlanetChili <http://www.planetchili.net>								  *
+*																						  *
+*	This file is part of The Chili DirectX Framework.									  *
+*																						  *
+*	The Chili DirectX Framework is free software: you can redistribute it and/or modify	  *
+*	it under the terms of the GNU General Public License as published by				  *
+*	the Free Software Foundation, either version 3 of the License, or					  *
+*	(at your option) any later version.													  *
+*																						  *
+*	The Chili DirectX Framework is distributed in the hope that it will be useful,		  *
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of						  *
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the						  *
+*	GNU General Public License for more details.										  *
+*																						  *
+*	You should have received a copy of the GNU General Public License					  *
+*	along with The Chili DirectX Framework.  If not, see <http://www.gnu.org/licenses/>.  *
+******************************************************************************************/
+#pragma once
+
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <new>
+#include <utility>
+#include <type_traits>
+#include <algorithm>
+#include <assert.h>
+
+// fixed pool of worker threads with per-thread work-stealing deques
+// jobs can be made children of another job; waiting on a job waits for it and all
+// of its children, and the waiting thread runs other jobs in the meantime
+// only the thread that created the JobSystem and the workers themselves may create,
+// run and wait on jobs
+class JobSystem
+{
+public:
+	class Job;
+	typedef void( *JobFunction )( Job& job );
+	// cache line sized, so the callable stored in it must fit in the leftover space
+	class Job
+	{
+		friend class JobSystem;
+	public:
+		bool IsFinished() const
+		{
+			return unfinished.load( std::memory_order_acquire ) == 0;
+		}
+	private:
+		// function,parent and unfinished take up three pointer-sized slots
+		static constexpr size_t dataSize = 64u - 3u * sizeof( void* );
+		JobFunction function;
+		Job* parent;
+		// this job plus its unfinished children
+		std::atomic<int> unfinished;
+		alignas( void* ) unsigned char data[dataSize];
+	};
+	static_assert( sizeof( Job ) == 64u,"job must fill exactly one cache line" );
+private:
+	// Chase-Lev deque: the owning thread pushes and pops at the bottom, thieves take from the top
+	class WorkStealingQueue
+	{
+	public:
+		void Push( Job* job );
+		Job* Pop();
+		Job* Steal();
+	private:
+		std::atomic<long long> top{ 0 };
+		std::atomic<long long> bottom{ 0 };
+		std::unique_ptr<std::atomic<Job*>[]> jobs = std::make_unique<std::atomic<Job*>[]>( maxJobsPerThread );
+	};
+	// everything one thread needs to create and schedule jobs
+	struct ThreadContext
+	{
+		ThreadContext();
+		WorkStealingQueue queue;
+		// ring of job slots, reused once maxJobsPerThread more jobs have been created
+		// (jobPool points into jobStorage, aligned so no job straddles two cache lines)
+		std::unique_ptr<unsigned char[]> jobStorage;
+		Job* jobPool;
+		unsigned int nAllocated = 0u;
+		unsigned int rng = 0u;
+	};
+public:
+	// workers in addition to the creating thread; defaults to one per remaining hardware thread
+	JobSystem( unsigned int nWorkers = std::max( std::thread::hardware_concurrency(),2u ) - 1u );
+	JobSystem( const JobSystem& ) = delete;
+	JobSystem& operator=( const JobSystem& ) = delete;
+	~JobSystem();
+	// job that will call f(); if parent is given, parent won't finish until this job has
+	// (f is stored inside the job, so it must be small: capture by reference where possible)
+	template<typename F>
+	Job* CreateJob( F&& f,Job* parent = nullptr )
+	{
+		typedef typename std::decay<F>::type Func;
+		static_assert( sizeof( Func ) <= Job::dataSize,"job callable too big; capture less by value" );
+		static_assert( alignof( Func ) <= alignof( void* ),"job callable over-aligned" );
+		Job* const job = AllocateJob( parent );
+		new (job->data) Func( std::forward<F>( f ) );
+		job->function = []( Job& j )
+		{
+			Func& func = *reinterpret_cast<Func*>(j.data);
+			func();
+			func.~Func();
+		};
+		return job;
+	}
+	// queue a job for execution
+	void Run( Job* job );
+	// execute jobs until job (and all its children) have finished
+	void Wait( const Job* job );
+	// call body( i ) for every i in [first,last); grain is the smallest number of
+	// indices handed to one job and grows with the range so scheduling cost stays small
+	template<typename F>
+	void ParallelFor( size_t first,size_t last,const F& body,size_t minGrain = 1u )
+	{
+		if( last <= first )
+		{
+			return;
+		}
+		const size_t count = last - first;
+		// aim for a few chunks per thread so stealing can balance uneven work
+		const size_t grain = std::max( minGrain,count / (size_t( GetThreadCount() ) * chunksPerThread) );
+		if( count <= grain )
+		{
+			for( size_t i = first; i < last; i++ )
+			{
+				body( i );
+			}
+			return;
+		}
+		Job* const root = CreateJob( [this,first,last,grain,&body]()
+		{
+			SplitRange( first,last,grain,body );
+		} );
+		Run( root );
+		Wait( root );
+	}
+	// workers plus the creating thread
+	unsigned int GetThreadCount() const
+	{
+		return static_cast<unsigned int>( contexts.size() );
+	}
+	static constexpr unsigned int maxJobsPerThread = 4096u;
+private:
+	// runs inside a job; the split off halves become its children
+	template<typename F>
+	void SplitRange( size_t first,size_t last,size_t grain,const F& body )
+	{
+		Job* const parent = GetCurrentJob();
+		// hand off the upper halves as jobs, keep subdividing the lower half here
+		while( last - first > grain )
+		{
+			const size_t mid = first + (last - first) / 2u;
+			Job* const job = CreateJob( [this,mid,last,grain,&body]()
+			{
+				SplitRange( mid,last,grain,body );
+			},parent );
+			Run( job );
+			last = mid;
+		}
+		for( size_t i = first; i < last; i++ )
+		{
+			body( i );
+		}
+	}
+	Job* AllocateJob( Job* parent );
+	Job* GetJob();
+	void Execute( Job& job );
+	void Finish( Job* job );
+	void WorkerLoop( unsigned int index );
+	ThreadContext& GetContext();
+	static Job* GetCurrentJob();
+private:
+	static constexpr size_t chunksPerThread = 4u;
+	// failed attempts to find work before a worker goes to sleep
+	static constexpr unsigned int spinsBeforeSleep = 256u;
+	// index 0 belongs to the creating thread
+	std::vector<std::unique_ptr<ThreadContext>> contexts;
+	std::vector<std::thread> workers;
+	std::atomic<bool> stopping{ false };
+	std::atomic<int> nSleeping{ 0 };
+	std::mutex sleepMutex;
+	std::condition_variable sleepCv;
+};
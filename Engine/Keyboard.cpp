@@ -19,58 +19,51 @@
  *	along with The Chili DirectX Framework.  If not, see <http://www.gnu.org/licenses/>.  *
  ******************************************************************************************/
 #include "Keyboard.h"
+#include "InputLog.h"
+
+Keyboard::Keyboard( size_t bufferSize )
+	:
+	keybuffer( bufferSize ),
+	charbuffer( bufferSize )
+{}
 
 bool Keyboard::KeyIsPressed( unsigned char keycode ) const
 {
-	return keystates[keycode];
+	return keystates[keycode].load( std::memory_order_relaxed );
 }
 
 Keyboard::Event Keyboard::ReadKey()
 {
-	if( keybuffer.size() > 0u )
-	{
-		Keyboard::Event e = keybuffer.front();
-		keybuffer.pop();
-		return e;
-	}
-	else
-	{
-		return Keyboard::Event();
-	}
+	Keyboard::Event e;
+	keybuffer.Pop( e );
+	return e;
 }
 
 bool Keyboard::KeyIsEmpty() const
 {
-	return keybuffer.empty();
+	return keybuffer.IsEmpty();
 }
 
 char Keyboard::ReadChar()
 {
-	if( charbuffer.size() > 0u )
-	{
-		unsigned char charcode = charbuffer.front();
-		charbuffer.pop();
-		return charcode;
-	}
-	else
-	{
-		return 0;
-	}
+	char charcode = 0;
+	charbuffer.Pop( charcode );
+	return charcode;
 }
 
 bool Keyboard::CharIsEmpty() const
 {
-	return charbuffer.empty();
+	return charbuffer.IsEmpty();
 }
 
 void Keyboard::FlushKey()
 {
-	std::swap( keybuffer,std::queue<Event>() );
+	keybuffer.Clear();
 }
 
 void Keyboard::FlushChar()
 {
-	std::swap( charbuffer,std::queue<char>() );
+	charbuffer.Clear();
 }
 
 void Keyboard::Flush()
@@ -79,6 +72,11 @@ void Keyboard::Flush()
 	FlushChar();
 }
 
+size_t Keyboard::GetDroppedEvents() const
+{
+	return keybuffer.GetDropped() + charbuffer.GetDropped();
+}
+
 void Keyboard::EnableAutorepeat()
 {
 	autorepeatEnabled = true;
@@ -96,30 +94,29 @@ bool Keyboard::AutorepeatIsEnabled() const
 
 void Keyboard::OnKeyPressed( unsigned char keycode )
 {
-	keystates[ keycode ] = true;	
-	keybuffer.push( Keyboard::Event( Keyboard::Event::Press,keycode ) );
-	TrimBuffer( keybuffer );
+	if( pRecordLog )
+	{
+		pRecordLog->Record( InputLog::Type::KeyPress,keycode );
+	}
+	keystates[keycode].store( true,std::memory_order_relaxed );
+	keybuffer.Push( Keyboard::Event( Keyboard::Event::Press,keycode ) );
 }
 
 void Keyboard::OnKeyReleased( unsigned char keycode )
 {
-	keystates[ keycode ] = false;
-	keybuffer.push( Keyboard::Event( Keyboard::Event::Release,keycode ) );
-	TrimBuffer( keybuffer );
+	if( pRecordLog )
+	{
+		pRecordLog->Record( InputLog::Type::KeyRelease,keycode );
+	}
+	keystates[keycode].store( false,std::memory_order_relaxed );
+	keybuffer.Push( Keyboard::Event( Keyboard::Event::Release,keycode ) );
 }
 
 void Keyboard::OnChar( char character )
 {
-	charbuffer.push( character );
-	TrimBuffer( charbuffer );
-}
-
-template<typename T>
-void Keyboard::TrimBuffer( std::queue<T>& buffer )
-{
-	while( buffer.size() > bufferSize )
+	if( pRecordLog )
 	{
-		buffer.pop();
+		pRecordLog->Record( InputLog::Type::Char,static_cast<unsigned char>( character ) );
 	}
+	charbuffer.Push( character );
 }
-
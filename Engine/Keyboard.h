@@ -19,12 +19,15 @@
  *	along with The Chili DirectX Framework.  If not, see <http://www.gnu.org/licenses/>.  *
  ******************************************************************************************/
 #pragma once
-#include <queue>
-#include <bitset>
+#include "SpscRing.h"
+#include <atomic>
+
+class InputLog;
 
 class Keyboard
 {
 	friend class MainWindow;
+	friend class InputLog;
 public:
 	class Event
 	{
@@ -67,7 +70,8 @@ public:
 		}
 	};
 public:
-	Keyboard() = default;
+	// bufferSize is how many events may queue up unread before new ones are dropped
+	explicit Keyboard( size_t bufferSize = defaultBufferSize );
 	Keyboard( const Keyboard& ) = delete;
 	Keyboard& operator=( const Keyboard& ) = delete;
 	bool KeyIsPressed( unsigned char keycode ) const;
@@ -78,6 +82,8 @@ public:
 	void FlushKey();
 	void FlushChar();
 	void Flush();
+	// key and char events lost because their buffer was full
+	size_t GetDroppedEvents() const;
 	void EnableAutorepeat();
 	void DisableAutorepeat();
 	bool AutorepeatIsEnabled() const;
@@ -85,13 +91,16 @@ private:
 	void OnKeyPressed( unsigned char keycode );
 	void OnKeyReleased( unsigned char keycode );
 	void OnChar( char character );
-	template<typename T>
-	void TrimBuffer( std::queue<T>& buffer );
+public:
+	static constexpr size_t defaultBufferSize = 64u;
 private:
 	static constexpr unsigned int nKeys = 256u;
-	static constexpr unsigned int bufferSize = 4u;
-	bool autorepeatEnabled = false;
-	std::bitset<nKeys> keystates;
-	std::queue<Event> keybuffer;
-	std::queue<char> charbuffer;
+	// the On* handlers may run on a different thread (the window's) than the readers,
+	// so state is atomic and events pass through single-producer/single-consumer rings
+	std::atomic<bool> autorepeatEnabled{ false };
+	std::atomic<bool> keystates[nKeys] = {};
+	SpscRing<Event> keybuffer;
+	SpscRing<char> charbuffer;
+	// set while an input log is recording this keyboard
+	InputLog* pRecordLog = nullptr;
 };
\ No newline at end of file
@@ -21,18 +21,153 @@
 #include "MainWindow.h"
 #include "Game.h"
 #include "ChiliException.h"
+#include "JobBenchmark.h"
+#include "InputLog.h"
+#include "Replay.h"
+#include "GoldenTest.h"
+#include "RasterBenchmark.h"
+#include "SinCosCheck.h"
+#include "ImageCheck.h"
+#include <fstream>
+
+namespace
+{
+	// the word (or "quoted string") following flag on the command line, empty if flag is absent
+	std::wstring GetArgValue( const std::wstring& args,const std::wstring& flag )
+	{
+		size_t pos = args.find( flag );
+		if( pos == std::wstring::npos )
+		{
+			return {};
+		}
+		pos = args.find_first_not_of( L' ',pos + flag.size() );
+		if( pos == std::wstring::npos )
+		{
+			return {};
+		}
+		if( args[pos] == L'"' )
+		{
+			const size_t end = args.find( L'"',pos + 1u );
+			return args.substr( pos + 1u,end == std::wstring::npos ? std::wstring::npos : end - pos - 1u );
+		}
+		return args.substr( pos,args.find( L' ',pos ) - pos );
+	}
+	// file names and reports are plain ascii
+	std::string Narrow( const std::wstring& str )
+	{
+		std::string narrow;
+		for( wchar_t c : str )
+		{
+			narrow.push_back( static_cast<char>( c ) );
+		}
+		return narrow;
+	}
+	// headless runs write their report to a file when asked to, so they can run unattended
+	void ShowReport( const std::wstring& title,const std::wstring& report,const std::wstring& reportFile )
+	{
+		if( reportFile.empty() )
+		{
+			MessageBox( nullptr,report.c_str(),title.c_str(),MB_OK );
+		}
+		else
+		{
+			std::ofstream( Narrow( reportFile ) ) << Narrow( title ) << "\n" << Narrow( report );
+		}
+	}
+}
 
 int WINAPI wWinMain( HINSTANCE hInst,HINSTANCE,LPWSTR pArgs,INT )
 {
+	// headless modes: replay input through the game, check the rasterizer against golden images,
+	// benchmark it, or check FastSinCos or the image formats
+	const std::wstring args( pArgs );
+	const std::wstring replayFile = GetArgValue( args,L"--replay" );
+	const std::wstring goldenDir = GetArgValue( args,L"--golden" );
+	const bool benchRaster = args.find( L"--bench-raster" ) != std::wstring::npos;
+	const bool checkSinCos = args.find( L"--check-sincos" ) != std::wstring::npos;
+	// the images it writes and reads back go into this directory
+	const std::wstring imageCheckDir = GetArgValue( args,L"--check-images" );
+	if( !replayFile.empty() || !goldenDir.empty() || benchRaster || checkSinCos || !imageCheckDir.empty() )
+	{
+		const std::wstring reportFile = GetArgValue( args,L"--report" );
+		try
+		{
+			if( !replayFile.empty() )
+			{
+				ShowReport( L"Replay",RunReplay( Narrow( replayFile ),GetArgValue( args,L"--video" ) ),reportFile );
+				return 0;
+			}
+			if( benchRaster )
+			{
+				ShowReport( L"Rasterizer Benchmark",RunRasterBenchmark(),reportFile );
+				return 0;
+			}
+			std::wstring report;
+			if( checkSinCos )
+			{
+				const bool passed = RunSinCosCheck( report );
+				ShowReport( L"FastSinCos Check",report,reportFile );
+				return passed ? 0 : 1;
+			}
+			if( !imageCheckDir.empty() )
+			{
+				const bool passed = RunImageCheck( imageCheckDir,report );
+				ShowReport( L"Image Format Check",report,reportFile );
+				return passed ? 0 : 1;
+			}
+			const bool passed = RunGoldenTests( goldenDir,args.find( L"--update" ) != std::wstring::npos,report );
+			ShowReport( L"Golden Image Test",report,reportFile );
+			return passed ? 0 : 1;
+		}
+		catch( const ChiliException& e )
+		{
+			ShowReport( e.GetExceptionType(),e.GetFullMessage(),reportFile );
+		}
+		catch( const std::exception& e )
+		{
+			const std::string whatStr( e.what() );
+			ShowReport( L"Unhandled STL Exception",std::wstring( whatStr.begin(),whatStr.end() ),reportFile );
+		}
+		return 1;
+	}
+
 	try
 	{
 		MainWindow wnd( hInst,pArgs );		
 		try
 		{
-			Game theGame( wnd );
+			// report job scheduling throughput instead of running the game
+			if( wnd.GetArgs().find( L"--bench-jobs" ) != std::wstring::npos )
+			{
+				wnd.ShowMessageBox( L"Job System Benchmark",RunJobBenchmark() );
+				return 0;
+			}
+			// recording runs in lockstep so that replaying reproduces exactly what was shown
+			const std::wstring recordFile = GetArgValue( wnd.GetArgs(),L"--record" );
+			Game theGame( wnd,recordFile.empty() ? Game::Mode::RealTime : Game::Mode::Lockstep );
+			InputLog log;
+			if( !recordFile.empty() )
+			{
+				log.Attach( wnd.kbd,wnd.mouse );
+			}
+			const std::wstring videoFile = GetArgValue( wnd.GetArgs(),L"--video" );
+			if( !videoFile.empty() )
+			{
+				theGame.StartVideo( videoFile );
+			}
 			while( wnd.ProcessMessage() )
 			{
 				theGame.Go();
+				log.NextFrame();
+			}
+			if( !recordFile.empty() )
+			{
+				log.Detach();
+				log.Save( Narrow( recordFile ) );
+			}
+			if( !videoFile.empty() )
+			{
+				wnd.ShowMessageBox( L"Video Capture",theGame.StopVideo().ToString() );
 			}
 		}
 		catch( const ChiliException& e )
@@ -58,6 +58,18 @@ MainWindow::MainWindow( HINSTANCE hInst,wchar_t * pArgs )
 						 L"Failed to get valid window handle." );
 	}
 
+	// raw mouse input (WM_INPUT) reports motion at the device's rate, without acceleration
+	RAWINPUTDEVICE rid;
+	rid.usUsagePage = 0x01; // generic desktop
+	rid.usUsage = 0x02; // mouse
+	rid.dwFlags = 0;
+	rid.hwndTarget = hWnd;
+	if( RegisterRawInputDevices( &rid,1,sizeof( rid ) ) == FALSE )
+	{
+		throw Exception( _CRT_WIDE( __FILE__ ),__LINE__,
+						 L"Failed to register raw mouse input." );
+	}
+
 	// show and update
 	ShowWindow( hWnd,SW_SHOWDEFAULT );
 	UpdateWindow( hWnd );
@@ -221,6 +233,31 @@ LRESULT MainWindow::HandleMsg( HWND hWnd,UINT msg,WPARAM wParam,LPARAM lParam )
 		}
 		break;
 	}
+	case WM_INPUT:
+	{
+		UINT size = 0u;
+		if( GetRawInputData( reinterpret_cast<HRAWINPUT>(lParam),RID_INPUT,nullptr,&size,sizeof( RAWINPUTHEADER ) ) != 0u )
+		{
+			break;
+		}
+		// buffer only ever grows, so steady state input does not allocate
+		if( rawBuffer.size() < size )
+		{
+			rawBuffer.resize( size );
+		}
+		if( GetRawInputData( reinterpret_cast<HRAWINPUT>(lParam),RID_INPUT,rawBuffer.data(),&size,sizeof( RAWINPUTHEADER ) ) != size )
+		{
+			break;
+		}
+		const RAWINPUT& ri = *reinterpret_cast<const RAWINPUT*>(rawBuffer.data());
+		// absolute devices (tablets, remote desktop) have no meaningful relative motion
+		if( ri.header.dwType == RIM_TYPEMOUSE && (ri.data.mouse.usFlags & MOUSE_MOVE_ABSOLUTE) == 0 &&
+			(ri.data.mouse.lLastX != 0 || ri.data.mouse.lLastY != 0) )
+		{
+			mouse.OnRawDelta( ri.data.mouse.lLastX,ri.data.mouse.lLastY );
+		}
+		break;
+	}
 	// ************ END MOUSE MESSAGES ************ //
 	}
 
@@ -25,11 +25,12 @@
 #include "Mouse.h"
 #include "ChiliException.h"
 #include <string>
+#include <vector>
 
-// for granting special access to hWnd only for Graphics constructor
+// for granting special access to hWnd only for the window presenter
 class HWNDKey
 {
-	friend Graphics::Graphics( HWNDKey& );
+	friend class D3DPresenter;
 public:
 	HWNDKey( const HWNDKey& ) = delete;
 	HWNDKey& operator=( HWNDKey& ) = delete;
@@ -78,4 +79,6 @@ private:
 	static constexpr wchar_t* wndClassName = L"Chili DirectX Framework Window";
 	HINSTANCE hInst = nullptr;
 	std::wstring args;
+	// scratch space for WM_INPUT data
+	std::vector<BYTE> rawBuffer;
 };
\ No newline at end of file
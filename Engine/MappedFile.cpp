@@ -0,0 +1,109 @@
+/******************************************************************************************
+*	Chili DirectX Framework Version 16.10.01											  *
+*	MappedFile.cpp																		  *
+*	Copyright 2016 PlanetChili <http://www.planetchili.net>								  *
+*																						  *
+*	This file is part of The Chili DirectX Framework.									  *
+*																						  *
+*	The Chili DirectX Framework is free software: you can redistribute it and/or modify	  *
+*	it under the terms of the GNU General Public License as published by				  *
+*	the Free Software Foundation, either version 3 of the License, or					  *
+*	(at your option) any later version.													  *
+*																						  *
+*	The Chili DirectX Framework is distributed in the hope that it will be useful,		  *
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of						  *
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the						  *
+*	GNU General Public License for more details.										  *
+*																						  *
+*	You should have received a copy of the GNU General Public License					  *
+*	along with The Chili DirectX Framework.  If not, see <http://www.gnu.org/licenses/>.  *
+******************************************************************************************/
+#include "MappedFile.h"
+#include <cstdint>
+#ifdef _WIN32
+#define FULL_WINTARD
+#include "ChiliWin.h"
+#else
+#include "Utf8.h"
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+MappedFile::MappedFile( const std::wstring& filename )
+{
+	const HANDLE file = CreateFileW( filename.c_str(),GENERIC_READ,FILE_SHARE_READ,nullptr,
+		OPEN_EXISTING,FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN,nullptr );
+	if( file == INVALID_HANDLE_VALUE )
+	{
+		return;
+	}
+	hFile = file;
+	LARGE_INTEGER fileSize;
+	// empty files can't be mapped; treat them like missing ones
+	if( GetFileSizeEx( file,&fileSize ) == FALSE || fileSize.QuadPart == 0 ||
+		static_cast<unsigned long long>( fileSize.QuadPart ) > static_cast<unsigned long long>( SIZE_MAX ) )
+	{
+		return;
+	}
+	hMapping = CreateFileMappingW( file,nullptr,PAGE_READONLY,0,0,nullptr );
+	if( hMapping == nullptr )
+	{
+		return;
+	}
+	pData = static_cast<const unsigned char*>( MapViewOfFile( hMapping,FILE_MAP_READ,0,0,0 ) );
+	if( pData != nullptr )
+	{
+		size = static_cast<size_t>( fileSize.QuadPart );
+	}
+}
+
+MappedFile::~MappedFile()
+{
+	if( pData != nullptr )
+	{
+		UnmapViewOfFile( pData );
+	}
+	if( hMapping != nullptr )
+	{
+		CloseHandle( hMapping );
+	}
+	if( hFile != nullptr )
+	{
+		CloseHandle( hFile );
+	}
+}
+#else
+MappedFile::MappedFile( const std::wstring& filename )
+{
+	const int fd = open( ToUtf8( filename ).c_str(),O_RDONLY );
+	if( fd < 0 )
+	{
+		return;
+	}
+	struct stat info;
+	// empty files can't be mapped; treat them like missing ones
+	if( fstat( fd,&info ) == 0 && S_ISREG( info.st_mode ) && info.st_size > 0 )
+	{
+		void* const p = mmap( nullptr,static_cast<size_t>( info.st_size ),PROT_READ,MAP_PRIVATE,fd,0 );
+		if( p != MAP_FAILED )
+		{
+			madvise( p,static_cast<size_t>( info.st_size ),MADV_SEQUENTIAL );
+			pData = static_cast<const unsigned char*>( p );
+			size = static_cast<size_t>( info.st_size );
+		}
+	}
+	// the mapping keeps its own reference to the file
+	close( fd );
+}
+
+MappedFile::~MappedFile()
+{
+	if( pData != nullptr )
+	{
+		munmap( const_cast<unsigned char*>( pData ),size );
+	}
+}
+#endif
@@ -0,0 +1,53 @@
+/******************************************************************************************
+*	Chili DirectX Framework Version 16.10.01											  *
+*	MappedFile.h																		  *
+*	Copyright 2016 PlanetChili <http://www.planetchili.net>								  *
+*																						  *
+*	This file is part of The Chili DirectX Framework.									  *
+*																						  *
+*	The Chili DirectX Framework is free software: you can redistribute it and/or modify	  *
+*	it under the terms of the GNU General Public License as published by				  *
+*	the Free Software Foundation, either version 3 of the License, or					  *
+*	(at your option) any later version.													  *
+*																						  *
+*	The Chili DirectX Framework is distributed in the hope that it will be useful,		  *
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of						  *
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the						  *
+*	GNU General Public License for more details.										  *
+*																						  *
+*	You should have received a copy of the GNU General Public License					  *
+*	along with The Chili DirectX Framework.  If not, see <http://www.gnu.org/licenses/>.  *
+******************************************************************************************/
+#pragma once
+
+#include <string>
+
+// read-only view of a whole file, mapped into memory so parsing it never copies
+// through a stream; like std::ifstream, check it with operator bool after opening
+class MappedFile
+{
+public:
+	explicit MappedFile( const std::wstring& filename );
+	MappedFile( const MappedFile& ) = delete;
+	MappedFile& operator=( const MappedFile& ) = delete;
+	~MappedFile();
+	explicit operator bool() const
+	{
+		return pData != nullptr;
+	}
+	const unsigned char* GetData() const
+	{
+		return pData;
+	}
+	size_t GetSize() const
+	{
+		return size;
+	}
+private:
+	const unsigned char* pData = nullptr;
+	size_t size = 0u;
+#ifdef _WIN32
+	void* hFile = nullptr;
+	void* hMapping = nullptr;
+#endif
+};
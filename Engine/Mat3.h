@@ -114,6 +114,23 @@ public:
 			(T)0.0,-sinTheta, cosTheta,
 		};
 	}
+	// RotationX( thetaX ) * RotationY( thetaY ) * RotationZ( thetaZ ), with one sin and cos per
+	// angle and the product written out rather than multiplied
+	static _Mat3 RotationXYZ( T thetaX,T thetaY,T thetaZ )
+	{
+		return RotationXYZ( sin( thetaX ),cos( thetaX ),sin( thetaY ),cos( thetaY ),sin( thetaZ ),cos( thetaZ ) );
+	}
+	// as above from sines and cosines already at hand, e.g. from a batch FastSinCos (SinCos.h)
+	static _Mat3 RotationXYZ( T sinX,T cosX,T sinY,T cosY,T sinZ,T cosZ )
+	{
+		const T sxsy = sinX * sinY;
+		const T cxsy = cosX * sinY;
+		return{
+			cosY * cosZ,               cosY * sinZ,               -sinY,
+			sxsy * cosZ - cosX * sinZ, sxsy * sinZ + cosX * cosZ, sinX * cosY,
+			cxsy * cosZ + sinX * sinZ, cxsy * sinZ - sinX * cosZ, cosX * cosY
+		};
+	}
 public:
 	// [ row ][ col ]
 	T elements[3][3];
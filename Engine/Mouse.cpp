@@ -20,7 +20,14 @@
  ******************************************************************************************/
 #include "Mouse.h"
 #include "Vec2.h"
+#include "InputLog.h"
+#include <algorithm>
 
+Mouse::Mouse( size_t bufferSize )
+	:
+	buffer( bufferSize ),
+	rawHistory( rawHistorySize )
+{}
 
 Vei2 Mouse::GetPos() const
 {
@@ -54,90 +61,164 @@ bool Mouse::IsInWindow() const
 
 Mouse::Event Mouse::Read()
 {
-	if( buffer.size() > 0u )
+	Mouse::Event e;
+	buffer.Pop( e );
+	return e;
+}
+
+void Mouse::Flush()
+{
+	buffer.Clear();
+}
+
+size_t Mouse::GetDroppedEvents() const
+{
+	return buffer.GetDropped();
+}
+
+Vei2 Mouse::ReadRawDelta()
+{
+	const unsigned long long packed = rawDelta.exchange( 0u,std::memory_order_relaxed );
+	return { static_cast<int>( static_cast<unsigned int>( packed >> 32 ) ),
+		static_cast<int>( static_cast<unsigned int>( packed ) ) };
+}
+
+void Mouse::EnableRawHistory()
+{
+	rawHistoryEnabled = true;
+}
+
+void Mouse::DisableRawHistory()
+{
+	rawHistoryEnabled = false;
+	rawHistory.Clear();
+}
+
+bool Mouse::ReadRawHistory( RawDelta& delta )
+{
+	return rawHistory.Pop( delta );
+}
+
+void Mouse::OnRawDelta( int dx,int dy )
+{
+	// a single report never moves this far; clamping keeps the log and history (16 bit) exact
+	dx = std::min( std::max( dx,-32768 ),32767 );
+	dy = std::min( std::max( dy,-32768 ),32767 );
+	if( pRecordLog )
 	{
-		Mouse::Event e = buffer.front();
-		buffer.pop();
-		return e;
+		pRecordLog->Record( InputLog::Type::RawDelta,0u,dx,dy );
 	}
-	else
+	// only this thread adds, but the reader may take the sum at any time
+	unsigned long long packed = rawDelta.load( std::memory_order_relaxed );
+	while( true )
 	{
-		return Mouse::Event();
+		const int sumX = static_cast<int>( static_cast<unsigned int>( packed >> 32 ) ) + dx;
+		const int sumY = static_cast<int>( static_cast<unsigned int>( packed ) ) + dy;
+		if( rawDelta.compare_exchange_weak( packed,PackDelta( sumX,sumY ),std::memory_order_relaxed ) )
+		{
+			break;
+		}
+	}
+	if( rawHistoryEnabled.load( std::memory_order_relaxed ) )
+	{
+		rawHistory.Push( { static_cast<short>( dx ),static_cast<short>( dy ) } );
 	}
 }
 
-void Mouse::Flush()
+unsigned long long Mouse::PackDelta( int dx,int dy )
 {
-	std::swap( buffer,std::queue<Event>() );
+	return (static_cast<unsigned long long>( static_cast<unsigned int>( dx ) ) << 32) |
+		static_cast<unsigned int>( dy );
 }
 
 void Mouse::OnMouseLeave()
 {
+	if( pRecordLog )
+	{
+		pRecordLog->Record( InputLog::Type::MouseLeave,0u );
+	}
 	isInWindow = false;
 }
 
 void Mouse::OnMouseEnter()
 {
+	if( pRecordLog )
+	{
+		pRecordLog->Record( InputLog::Type::MouseEnter,0u );
+	}
 	isInWindow = true;
 }
 
 void Mouse::OnMouseMove( int newx,int newy )
 {
+	if( pRecordLog )
+	{
+		pRecordLog->Record( InputLog::Type::MouseMove,0u,newx,newy );
+	}
 	x = newx;
 	y = newy;
 
-	buffer.push( Mouse::Event( Mouse::Event::Move,*this ) );
-	TrimBuffer();
+	buffer.Push( Mouse::Event( Mouse::Event::Move,*this ) );
 }
 
 void Mouse::OnLeftPressed( int x,int y )
 {
+	if( pRecordLog )
+	{
+		pRecordLog->Record( InputLog::Type::LPress,0u,x,y );
+	}
 	leftIsPressed = true;
 
-	buffer.push( Mouse::Event( Mouse::Event::LPress,*this ) );
-	TrimBuffer();
+	buffer.Push( Mouse::Event( Mouse::Event::LPress,*this ) );
 }
 
 void Mouse::OnLeftReleased( int x,int y )
 {
+	if( pRecordLog )
+	{
+		pRecordLog->Record( InputLog::Type::LRelease,0u,x,y );
+	}
 	leftIsPressed = false;
 
-	buffer.push( Mouse::Event( Mouse::Event::LRelease,*this ) );
-	TrimBuffer();
+	buffer.Push( Mouse::Event( Mouse::Event::LRelease,*this ) );
 }
 
 void Mouse::OnRightPressed( int x,int y )
 {
+	if( pRecordLog )
+	{
+		pRecordLog->Record( InputLog::Type::RPress,0u,x,y );
+	}
 	rightIsPressed = true;
 
-	buffer.push( Mouse::Event( Mouse::Event::RPress,*this ) );
-	TrimBuffer();
+	buffer.Push( Mouse::Event( Mouse::Event::RPress,*this ) );
 }
 
 void Mouse::OnRightReleased( int x,int y )
 {
+	if( pRecordLog )
+	{
+		pRecordLog->Record( InputLog::Type::RRelease,0u,x,y );
+	}
 	rightIsPressed = false;
 
-	buffer.push( Mouse::Event( Mouse::Event::RRelease,*this ) );
-	TrimBuffer();
+	buffer.Push( Mouse::Event( Mouse::Event::RRelease,*this ) );
 }
 
 void Mouse::OnWheelUp( int x,int y )
 {
-	buffer.push( Mouse::Event( Mouse::Event::WheelUp,*this ) );
-	TrimBuffer();
+	if( pRecordLog )
+	{
+		pRecordLog->Record( InputLog::Type::WheelUp,0u,x,y );
+	}
+	buffer.Push( Mouse::Event( Mouse::Event::WheelUp,*this ) );
 }
 
 void Mouse::OnWheelDown( int x,int y )
 {
-	buffer.push( Mouse::Event( Mouse::Event::WheelDown,*this ) );
-	TrimBuffer();
-}
-
-void Mouse::TrimBuffer()
-{
-	while( buffer.size() > bufferSize )
+	if( pRecordLog )
 	{
-		buffer.pop();
+		pRecordLog->Record( InputLog::Type::WheelDown,0u,x,y );
 	}
-}
\ No newline at end of file
+	buffer.Push( Mouse::Event( Mouse::Event::WheelDown,*this ) );
+}
@@ -19,13 +19,23 @@
  *	along with The Chili DirectX Framework.  If not, see <http://www.gnu.org/licenses/>.  *
  ******************************************************************************************/
 #pragma once
-#include <queue>
+#include "SpscRing.h"
 #include "Vec2.h"
+#include <atomic>
+
+class InputLog;
 
 class Mouse
 {
 	friend class MainWindow;
+	friend class InputLog;
 public:
+	// one raw motion report, in device counts (not affected by pointer acceleration or screen edges)
+	struct RawDelta
+	{
+		short x;
+		short y;
+	};
 	class Event
 	{
 	public:
@@ -93,7 +103,8 @@ public:
 		}
 	};
 public:
-	Mouse() = default;
+	// bufferSize is how many events may queue up unread before new ones are dropped
+	explicit Mouse( size_t bufferSize = defaultBufferSize );
 	Mouse( const Mouse& ) = delete;
 	Mouse& operator=( const Mouse& ) = delete;
 	Vei2 GetPos() const;
@@ -105,9 +116,19 @@ public:
 	Mouse::Event Read();
 	bool IsEmpty() const
 	{
-		return buffer.empty();
+		return buffer.IsEmpty();
 	}
 	void Flush();
+	// events lost because the buffer was full
+	size_t GetDroppedEvents() const;
+	// raw motion summed since the previous call; meant to be read once per frame
+	Vei2 ReadRawDelta();
+	// when enabled, the individual raw reports summed by ReadRawDelta are also kept
+	// (up to rawHistorySize of them) for consumers that care about timing within a frame
+	void EnableRawHistory();
+	void DisableRawHistory();
+	// oldest raw report not yet read from the history; false if there is none
+	bool ReadRawHistory( RawDelta& delta );
 private:
 	void OnMouseMove( int x,int y );
 	void OnMouseLeave();
@@ -118,13 +139,24 @@ private:
 	void OnRightReleased( int x,int y );
 	void OnWheelUp( int x,int y );
 	void OnWheelDown( int x,int y );
-	void TrimBuffer();
+	void OnRawDelta( int dx,int dy );
+	static unsigned long long PackDelta( int dx,int dy );
+public:
+	static constexpr size_t defaultBufferSize = 256u;
+	static constexpr size_t rawHistorySize = 1024u;
 private:
-	static constexpr unsigned int bufferSize = 4u;
-	int x = 0;
-	int y = 0;
-	bool leftIsPressed = false;
-	bool rightIsPressed = false;
-	bool isInWindow = false;
-	std::queue<Event> buffer;
+	// the On* handlers may run on a different thread (the window's) than the readers,
+	// so state is atomic and events pass through a single-producer/single-consumer ring
+	std::atomic<int> x{ 0 };
+	std::atomic<int> y{ 0 };
+	std::atomic<bool> leftIsPressed{ false };
+	std::atomic<bool> rightIsPressed{ false };
+	std::atomic<bool> isInWindow{ false };
+	SpscRing<Event> buffer;
+	// summed raw motion, x in the high and y in the low 32 bits so both are taken together
+	std::atomic<unsigned long long> rawDelta{ 0u };
+	std::atomic<bool> rawHistoryEnabled{ false };
+	SpscRing<RawDelta> rawHistory;
+	// set while an input log is recording this mouse
+	InputLog* pRecordLog = nullptr;
 };
\ No newline at end of file
@@ -0,0 +1,104 @@
+/******************************************************************************************
+*	Chili DirectX Framework Version 16.10.01											  *
+*	PerfHud.cpp																			  *
+*	Copyright 2016 PlanetChili <http://www.planetchili.net>								  *
+*																						  *
+*	This file is part of The Chili DirectX Framework.									  *
+*																						  *
+*	The Chili DirectX Framework is free software: you can redistribute it and/or modify	  *
+*	it under the terms of the GNU General Public License as published by				  *
+*	the Free Software Foundation, either version 3 of the License, or					  *
+*	(at your option) any later version.													  *
+*																						  *
+*	The Chili DirectX Framework is distributed in the hope that it will be useful,		  *
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of						  *
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the						  *
+*	GNU General Public License for more details.										  *
+*																						  *
+*	You should have received a copy of the GNU General Public License					  *
+*	along with The Chili DirectX Framework.  If not, see <http://www.gnu.org/licenses/>.  *
+******************************************************************************************/
+#include "PerfHud.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+
+void PerfHud::AddFrame( const FrameTimes& times )
+{
+	newest = (newest + 1u) % graphFrames;
+	history[newest] = times.frameMs;
+	last = times;
+}
+
+void PerfHud::Draw( Surface& frame,const Graphics& gfx )
+{
+	const auto start = std::chrono::steady_clock::now();
+	static const std::string frameText = "frame";
+	static const std::string statText =
+		"update\ntransform\nraster\npresent\ntriangles\nclipped\npixels\nresolution\npool\narena\nhud";
+	const BitmapFont::TextLayout& frameLabel = font.GetCached( frameText );
+	const BitmapFont::TextLayout& statLabels = font.GetCached( statText );
+	const int left = margin + padding;
+	const int top = margin + padding;
+	// the graph sits between the frame line and the stage lines
+	const int graphTop = top + BitmapFont::LineHeight;
+	const int statsTop = graphTop + graphHeight + BitmapFont::LineHeight - BitmapFont::GlyphHeight;
+	const int valuesLeft = left + labelColumns * BitmapFont::Advance;
+	// a bar after each stage's time (a 10 character value)
+	const int barsLeft = valuesLeft + 11 * BitmapFont::Advance;
+
+	const Graphics::RasterStats& raster = gfx.GetRasterStats();
+	const SurfacePool::Stats pool = gfx.GetSurfacePool().GetStats();
+	const FrameArena::Stats arena = gfx.GetFrameArena().GetStats();
+	const float maxMs = *std::max_element( std::begin( history ),std::end( history ) );
+	const float mib = 1.0f / float( 1u << 20 );
+	char text[384];
+	snprintf( text,sizeof( text ),"%6.2f ms %5.1f fps max %.1f",
+		last.frameMs,last.frameMs > 0.0f ? 1000.0f / last.frameMs : 0.0f,maxMs );
+	font.Layout( text,frameValue );
+	snprintf( text,sizeof( text ),
+		"%7.3f ms\n%7.3f ms\n%7.3f ms\n%7.3f ms\n"
+		"%llu of %llu\n%llu, %llu culled\n%llu, overdraw %.2f\n%ux%u\n"
+		"%.1f of %.1f MiB\n%zu of %zu KiB\n%7.3f ms",
+		last.updateMs,last.transformMs,last.rasterMs,last.presentMs,
+		raster.trianglesRasterized,raster.trianglesSubmitted,raster.trianglesClipped,raster.trianglesCulled,
+		raster.pixelsWritten,raster.GetAverageOverdraw(),gfx.GetWidth(),gfx.GetHeight(),
+		float( pool.bytesLeased ) * mib,float( pool.bytesLeased + pool.bytesPooled ) * mib,
+		arena.used >> 10,arena.capacity >> 10,drawMs );
+	font.Layout( text,statValues );
+
+	// backdrop wide enough for everything on it
+	const int right = std::max( { valuesLeft + frameValue.width,valuesLeft + statValues.width,
+		barsLeft + stageBarMax,left + int( graphFrames ) } ) + padding;
+	const RectI screen = Graphics::GetScreenRect();
+	frame.FillRect( { margin,statsTop + statLabels.height + padding,margin,right },screen,Color( 24u,24u,32u ) );
+	Graphics::DrawString( frame,left,top,frameLabel,font,Colors::LightGray );
+	Graphics::DrawString( frame,valuesLeft,top,frameValue,font,Colors::White );
+	Graphics::DrawString( frame,left,statsTop,statLabels,font,Colors::LightGray );
+	Graphics::DrawString( frame,valuesLeft,statsTop,statValues,font,Colors::White );
+
+	// graph, oldest frame on the left, with a line across at the budget
+	const int graphBottom = graphTop + graphHeight;
+	for( unsigned int i = 0u; i < graphFrames; i++ )
+	{
+		const float ms = history[(newest + 1u + i) % graphFrames];
+		const int barHeight = std::min( int( ms / graphMaxMs * float( graphHeight ) + 0.5f ),graphHeight );
+		const Color c = ms <= budgetMs ? Colors::Green : ms <= 2.0f * budgetMs ? Colors::Yellow : Colors::Red;
+		const int x = left + int( i );
+		frame.FillRect( { graphBottom - barHeight,graphBottom,x,x + 1 },screen,c );
+	}
+	const int budgetY = graphBottom - int( budgetMs / graphMaxMs * float( graphHeight ) + 0.5f );
+	frame.FillRect( { budgetY,budgetY + 1,left,left + int( graphFrames ) },screen,Colors::Gray );
+
+	// stage bars, each in the stage's color
+	const float stageMs[] = { last.updateMs,last.transformMs,last.rasterMs,last.presentMs };
+	const Color stageColors[] = { Colors::Cyan,Colors::Green,Colors::Yellow,Colors::Magenta };
+	for( unsigned int i = 0u; i < sizeof( stageMs ) / sizeof( *stageMs ); i++ )
+	{
+		const int y = statsTop + int( i ) * BitmapFont::LineHeight;
+		const int length = std::min( int( stageMs[i] * stagePixelsPerMs + 0.5f ),stageBarMax );
+		frame.FillRect( { y,y + BitmapFont::GlyphHeight - 1,barsLeft,barsLeft + std::max( length,1 ) },screen,
+			stageColors[i] );
+	}
+	drawMs = std::chrono::duration<float,std::milli>( std::chrono::steady_clock::now() - start ).count();
+}
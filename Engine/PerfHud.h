@@ -0,0 +1,78 @@
+/******************************************************************************************
+*	Chili DirectX Framework Version 16.10.01											  *
+*	PerfHud.h																			  *
+*	Copyright 2016 PlanetChili <http://www.planetchili.net>								  *
+*																						  *
+*	This file is part of The Chili DirectX Framework.									  *
+*																						  *
+*	The Chili DirectX Framework is free software: you can redistribute it and/or modify	  *
+*	it under the terms of the GNU General Public License as published by				  *
+*	the Free Software Foundation, either version 3 of the License, or					  *
+*	(at your option) any later version.													  *
+*																						  *
+*	The Chili DirectX Framework is distributed in the hope that it will be useful,		  *
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of						  *
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the						  *
+*	GNU General Public License for more details.										  *
+*																						  *
+*	You should have received a copy of the GNU General Public License					  *
+*	along with The Chili DirectX Framework.  If not, see <http://www.gnu.org/licenses/>.  *
+******************************************************************************************/
+#pragma once
+
+#include "Graphics.h"
+#include "BitmapFont.h"
+
+// performance overlay drawn over the top left of the frame: a scrolling graph of frame times,
+// the time of each stage of the last frame, the rasterizer's counters, engine memory in use,
+// and what drawing the overlay itself cost the frame before
+// it is drawn on the presented frame as a Graphics overlay, so it stays sharp whatever the
+// render resolution and stays out of the counters it shows
+class PerfHud
+{
+public:
+	// how long the parts of one frame took, in ms
+	struct FrameTimes
+	{
+		// start of the previous frame to start of this one
+		float frameMs = 0.0f;
+		// the latest simulation step, which may have run on another thread
+		float updateMs = 0.0f;
+		float transformMs = 0.0f;
+		float rasterMs = 0.0f;
+		// the previous frame's EndFrame (upscale, copy, overlay and hand off), as this one's isn't done yet
+		float presentMs = 0.0f;
+	};
+public:
+	PerfHud() = default;
+	PerfHud( const PerfHud& ) = delete;
+	PerfHud& operator=( const PerfHud& ) = delete;
+	// feed every frame, shown or not, so the graph has history the moment it is shown
+	void AddFrame( const FrameTimes& times );
+	// draws onto frame (at screen resolution) what gfx reports; meant for Graphics::SetOverlay
+	void Draw( Surface& frame,const Graphics& gfx );
+private:
+	// frames in the graph, one pixel column each
+	static constexpr unsigned int graphFrames = 128u;
+	static constexpr int graphHeight = 32;
+	// frame time at the top of the graph
+	static constexpr float graphMaxMs = 50.0f;
+	// graph bars are green up to this, yellow up to twice this, red beyond
+	static constexpr float budgetMs = 1000.0f / 60.0f;
+	// stage bar length per ms, and longest stage bar
+	static constexpr float stagePixelsPerMs = 16.0f;
+	static constexpr int stageBarMax = 64;
+	static constexpr int margin = 4;
+	static constexpr int padding = 4;
+	// characters before the values column
+	static constexpr int labelColumns = 11;
+	BitmapFont font;
+	float history[graphFrames] = {};
+	// index of the newest sample in history
+	unsigned int newest = 0u;
+	FrameTimes last;
+	float drawMs = 0.0f;
+	// laid out anew every frame, reusing their storage
+	BitmapFont::TextLayout frameValue;
+	BitmapFont::TextLayout statValues;
+};
@@ -0,0 +1,36 @@
+/******************************************************************************************
+*	Chili DirectX Framework Version 16.10.01											  *
+*	Presenter.h																			  *
+*	Copyright 2016 PlanetChili <http://www.planetchili.net>								  *
+*																						  *
+*	This file is part of The Chili DirectX Framework.									  *
+*																						  *
+*	The Chili DirectX Framework is free software: you can redistribute it and/or modify	  *
+*	it under the terms of the GNU General Public License as published by				  *
+*	the Free Software Foundation, either version 3 of the License, or					  *
+*	(at your option) any later version.													  *
+*																						  *
+*	The Chili DirectX Framework is distributed in the hope that it will be useful,		  *
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of						  *
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the						  *
+*	GNU General Public License for more details.										  *
+*																						  *
+*	You should have received a copy of the GNU General Public License					  *
+*	along with The Chili DirectX Framework.  If not, see <http://www.gnu.org/licenses/>.  *
+******************************************************************************************/
+#pragma once
+
+#include "Surface.h"
+
+// backend that takes finished frames from Graphics and gets them onto the screen
+// (or wherever else they need to go)
+class Presenter
+{
+public:
+	virtual ~Presenter() = default;
+	// writable memory for the next frame; the returned view is only valid until Unmap
+	virtual Surface Map() = 0;
+	virtual void Unmap() = 0;
+	// show the most recently unmapped frame
+	virtual void Present() = 0;
+};
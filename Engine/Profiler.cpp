@@ -0,0 +1,281 @@
+/******************************************************************************************
+*	Chili DirectX Framework Version 16.10.01											  *
+*	Profiler.cpp																		  *
+*	Copyright 2016 PlanetChili <http://www.planetchili.net>								  *
+*																						  *
+*	This file is part of The Chili DirectX Framework.									  *
+*																						  *
+*	The Chili DirectX Framework is free software: you can redistribute it and/or modify	  *
+*	it under the terms of the GNU General Public License as published by				  *
+*	the Free Software Foundation, either version 3 of the License, or					  *
+*	(at your option) any later version.													  *
+*																						  *
+*	The Chili DirectX Framework is distributed in the hope that it will be useful,		  *
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of						  *
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the						  *
+*	GNU General Public License for more details.										  *
+*																						  *
+*	You should have received a copy of the GNU General Public License					  *
+*	along with The Chili DirectX Framework.  If not, see <http://www.gnu.org/licenses/>.  *
+******************************************************************************************/
+#include "Profiler.h"
+
+#if CHILI_PROFILE
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <memory>
+#include <mutex>
+
+namespace
+{
+	// fields are atomics only so that dumping while other threads record is well defined;
+	// relaxed loads and stores compile to plain moves
+	struct Event
+	{
+		std::atomic<const char*> name{ nullptr };
+		std::atomic<long long> start{ 0 };
+		std::atomic<long long> end{ 0 };
+	};
+	// written only by its own thread; readers detect slots overwritten while they were copying
+	struct ThreadBuffer
+	{
+		static constexpr unsigned long long capacity = 1u << 15;
+		unsigned int threadIndex = 0u;
+		// bumped before a slot is written
+		std::atomic<unsigned long long> nStarted{ 0u };
+		// bumped after a slot is written
+		std::atomic<unsigned long long> nFinished{ 0u };
+		std::unique_ptr<Event[]> events = std::make_unique<Event[]>( capacity );
+	};
+	struct Registry
+	{
+		std::mutex mutex;
+		// buffers outlive their threads so zones from finished threads can still be dumped
+		std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+		// frame end timestamps, written by the render thread
+		std::atomic<long long> frameEnds[Profiler::maxFrames + 1u];
+		std::atomic<unsigned long long> nFrames{ 0u };
+	};
+	Registry& GetRegistry()
+	{
+		static Registry registry;
+		return registry;
+	}
+	ThreadBuffer& GetThreadBuffer()
+	{
+		// registering takes the lock, but only once per thread
+		thread_local ThreadBuffer* const pBuffer = []()
+		{
+			Registry& reg = GetRegistry();
+			std::lock_guard<std::mutex> lock( reg.mutex );
+			reg.buffers.push_back( std::make_unique<ThreadBuffer>() );
+			reg.buffers.back()->threadIndex = static_cast<unsigned int>( reg.buffers.size() - 1u );
+			return reg.buffers.back().get();
+		}();
+		return *pBuffer;
+	}
+	struct Copy
+	{
+		const char* name;
+		long long start;
+		long long end;
+		unsigned int threadIndex;
+	};
+	// time span covered by the last nFrames complete frames; false if there are none yet
+	bool GetFrameWindow( unsigned int nFrames,std::vector<long long>& frameEnds )
+	{
+		const Registry& reg = GetRegistry();
+		const unsigned long long nMarked = reg.nFrames.load( std::memory_order_acquire );
+		const unsigned long long nAvailable = std::min<unsigned long long>( nMarked,Profiler::maxFrames + 1u );
+		if( nAvailable < 2u )
+		{
+			return false;
+		}
+		const unsigned long long nMarkers = std::min<unsigned long long>( nAvailable,nFrames + 1ull );
+		frameEnds.clear();
+		for( unsigned long long i = nMarked - nMarkers; i < nMarked; i++ )
+		{
+			frameEnds.push_back( reg.frameEnds[i % (Profiler::maxFrames + 1u)].load( std::memory_order_relaxed ) );
+		}
+		return true;
+	}
+	// every zone that started inside [begin,end) on any thread
+	std::vector<Copy> CollectEvents( long long begin,long long end )
+	{
+		Registry& reg = GetRegistry();
+		std::lock_guard<std::mutex> lock( reg.mutex );
+		std::vector<Copy> result;
+		for( const auto& pBuf : reg.buffers )
+		{
+			const ThreadBuffer& buf = *pBuf;
+			const unsigned long long nFinished = buf.nFinished.load( std::memory_order_acquire );
+			const unsigned long long first = nFinished > ThreadBuffer::capacity ? nFinished - ThreadBuffer::capacity : 0u;
+			const size_t nBefore = result.size();
+			for( unsigned long long i = first; i < nFinished; i++ )
+			{
+				const Event& e = buf.events[i & (ThreadBuffer::capacity - 1u)];
+				result.push_back( {
+					e.name.load( std::memory_order_relaxed ),
+					e.start.load( std::memory_order_relaxed ),
+					e.end.load( std::memory_order_relaxed ),
+					buf.threadIndex } );
+			}
+			// drop slots the owner started overwriting while we copied
+			std::atomic_thread_fence( std::memory_order_acquire );
+			const unsigned long long nStarted = buf.nStarted.load( std::memory_order_relaxed );
+			const unsigned long long firstValid = nStarted > ThreadBuffer::capacity ? nStarted - ThreadBuffer::capacity : 0u;
+			if( firstValid > first )
+			{
+				const size_t nInvalid = static_cast<size_t>( std::min( firstValid,nFinished ) - first );
+				result.erase( result.begin() + nBefore,result.begin() + nBefore + nInvalid );
+			}
+		}
+		result.erase( std::remove_if( result.begin(),result.end(),[begin,end]( const Copy& c )
+		{
+			return c.start < begin || c.start >= end;
+		} ),result.end() );
+		return result;
+	}
+	void WriteEscaped( std::ofstream& file,const char* str )
+	{
+		for( ; *str != '\0'; str++ )
+		{
+			if( *str == '"' || *str == '\\' )
+			{
+				file << '\\';
+			}
+			file << *str;
+		}
+	}
+}
+
+long long Profiler::Now()
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(
+		std::chrono::steady_clock::now().time_since_epoch() ).count();
+}
+
+void Profiler::Record( const char* name,long long start,long long end )
+{
+	ThreadBuffer& buf = GetThreadBuffer();
+	const unsigned long long n = buf.nFinished.load( std::memory_order_relaxed );
+	buf.nStarted.store( n + 1u,std::memory_order_relaxed );
+	std::atomic_thread_fence( std::memory_order_release );
+	Event& e = buf.events[n & (ThreadBuffer::capacity - 1u)];
+	e.name.store( name,std::memory_order_relaxed );
+	e.start.store( start,std::memory_order_relaxed );
+	e.end.store( end,std::memory_order_relaxed );
+	buf.nFinished.store( n + 1u,std::memory_order_release );
+}
+
+void Profiler::EndFrame()
+{
+	Registry& reg = GetRegistry();
+	const unsigned long long n = reg.nFrames.load( std::memory_order_relaxed );
+	reg.frameEnds[n % (maxFrames + 1u)].store( Now(),std::memory_order_relaxed );
+	reg.nFrames.store( n + 1u,std::memory_order_release );
+}
+
+std::vector<Profiler::ZoneStats> Profiler::GetSummary( unsigned int nFrames )
+{
+	std::vector<long long> frameEnds;
+	if( !GetFrameWindow( nFrames,frameEnds ) )
+	{
+		return {};
+	}
+	const size_t nWindowFrames = frameEnds.size() - 1u;
+	// per zone name, total time spent in each frame
+	std::map<std::string,std::vector<float>> totals;
+	for( const Copy& c : CollectEvents( frameEnds.front(),frameEnds.back() ) )
+	{
+		auto& frameTotals = totals[c.name];
+		frameTotals.resize( nWindowFrames,0.0f );
+		const size_t frame = std::upper_bound( frameEnds.begin(),frameEnds.end(),c.start ) - frameEnds.begin() - 1u;
+		frameTotals[frame] += float( c.end - c.start ) / 1.0e6f;
+	}
+	std::vector<ZoneStats> summary;
+	for( auto& t : totals )
+	{
+		std::vector<float>& ms = t.second;
+		std::sort( ms.begin(),ms.end() );
+		float sum = 0.0f;
+		for( float f : ms )
+		{
+			sum += f;
+		}
+		const size_t p99Index = static_cast<size_t>( std::ceil( 0.99f * float( ms.size() ) ) ) - 1u;
+		summary.push_back( { t.first,ms.front(),sum / float( ms.size() ),ms[p99Index] } );
+	}
+	std::sort( summary.begin(),summary.end(),[]( const ZoneStats& a,const ZoneStats& b )
+	{
+		return a.avg > b.avg;
+	} );
+	return summary;
+}
+
+bool Profiler::WriteTrace( const std::string& filename,unsigned int nFrames )
+{
+	std::vector<long long> frameEnds;
+	if( !GetFrameWindow( nFrames,frameEnds ) )
+	{
+		return false;
+	}
+	std::ofstream file( filename );
+	if( !file )
+	{
+		return false;
+	}
+	// trace timestamps are microseconds, relative to the start of the first frame
+	const long long origin = frameEnds.front();
+	const auto us = [origin]( long long t )
+	{
+		return double( t - origin ) / 1000.0;
+	};
+	file << std::fixed;
+	file.precision( 3 );
+	file << "{\"traceEvents\":[\n";
+	bool first = true;
+	for( const Copy& c : CollectEvents( frameEnds.front(),frameEnds.back() ) )
+	{
+		file << (first ? "" : ",\n") << "{\"name\":\"";
+		WriteEscaped( file,c.name );
+		file << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << c.threadIndex
+			<< ",\"ts\":" << us( c.start ) << ",\"dur\":" << us( c.end ) - us( c.start ) << "}";
+		first = false;
+	}
+	for( long long t : frameEnds )
+	{
+		file << (first ? "" : ",\n") << "{\"name\":\"Frame\",\"ph\":\"i\",\"s\":\"g\",\"pid\":1,\"tid\":0,\"ts\":" << us( t ) << "}";
+		first = false;
+	}
+	file << "\n]}\n";
+	return bool( file );
+}
+
+bool Profiler::WriteSummary( const std::string& filename,unsigned int nFrames )
+{
+	const std::vector<ZoneStats> summary = GetSummary( nFrames );
+	if( summary.empty() )
+	{
+		return false;
+	}
+	std::ofstream file( filename );
+	if( !file )
+	{
+		return false;
+	}
+	file << "zone                        min ms    avg ms    p99 ms\n" << std::fixed << std::setprecision( 3 );
+	for( const ZoneStats& z : summary )
+	{
+		file << std::left << std::setw( 24 ) << z.name << std::right
+			<< std::setw( 10 ) << z.min << std::setw( 10 ) << z.avg << std::setw( 10 ) << z.p99 << "\n";
+	}
+	return bool( file );
+}
+
+#endif
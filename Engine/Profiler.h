@@ -0,0 +1,94 @@
+/******************************************************************************************
+*	Chili DirectX Framework Version 16.10.01											  *
+*	Profiler.h																			  *
+*	Copyright 2016 PlanetChili <http://www.planetchili.net>								  *
+*																						  *
+*	This file is part of The Chili DirectX Framework.									  *
+*																						  *
+*	The Chili DirectX Framework is free software: you can redistribute it and/or modify	  *
+*	it under the terms of the GNU General Public License as published by				  *
+*	the Free Software Foundation, either version 3 of the License, or					  *
+*	(at your option) any later version.													  *
+*																						  *
+*	The Chili DirectX Framework is distributed in the hope that it will be useful,		  *
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of						  *
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the						  *
+*	GNU General Public License for more details.										  *
+*																						  *
+*	You should have received a copy of the GNU General Public License					  *
+*	along with The Chili DirectX Framework.  If not, see <http://www.gnu.org/licenses/>.  *
+******************************************************************************************/
+#pragma once
+
+// scoped zone profiler: each thread records zones into its own ring buffer without locking,
+// frames are delimited by CHILI_PROFILE_FRAME() on the render thread
+// build with CHILI_PROFILE defined to 1 to enable; otherwise every macro expands to nothing
+#ifndef CHILI_PROFILE
+#define CHILI_PROFILE 0
+#endif
+
+#if CHILI_PROFILE
+
+#include <atomic>
+#include <string>
+#include <vector>
+
+class Profiler
+{
+public:
+	// records [construction,destruction) as a zone named name on the calling thread
+	// name must outlive the profiler (use string literals)
+	class Zone
+	{
+	public:
+		explicit Zone( const char* name )
+			:
+			name( name ),
+			start( Now() )
+		{}
+		Zone( const Zone& ) = delete;
+		Zone& operator=( const Zone& ) = delete;
+		~Zone()
+		{
+			Record( name,start,Now() );
+		}
+	private:
+		const char* name;
+		long long start;
+	};
+	// timing of one zone name over the summarized frames (per-frame totals, in ms)
+	struct ZoneStats
+	{
+		std::string name;
+		float min;
+		float avg;
+		float p99;
+	};
+public:
+	// marks the end of a frame; call once per frame from the render thread
+	static void EndFrame();
+	// min/avg/p99 of every zone over the last nFrames frames, sorted by average descending
+	static std::vector<ZoneStats> GetSummary( unsigned int nFrames = maxFrames );
+	// writes the last nFrames frames in Chrome trace event format (load in about:tracing)
+	// returns false if the file could not be written
+	static bool WriteTrace( const std::string& filename,unsigned int nFrames = maxFrames );
+	// writes GetSummary( nFrames ) as a text table, one zone per line
+	// returns false if there are no complete frames yet or the file could not be written
+	static bool WriteSummary( const std::string& filename,unsigned int nFrames = maxFrames );
+	static long long Now();
+	static constexpr unsigned int maxFrames = 256u;
+private:
+	static void Record( const char* name,long long start,long long end );
+};
+
+#define CHILI_PROFILE_CONCAT_( a,b ) a##b
+#define CHILI_PROFILE_CONCAT( a,b ) CHILI_PROFILE_CONCAT_( a,b )
+#define CHILI_PROFILE_ZONE( name ) Profiler::Zone CHILI_PROFILE_CONCAT( profileZone,__LINE__ )( name )
+#define CHILI_PROFILE_FRAME() Profiler::EndFrame()
+
+#else
+
+#define CHILI_PROFILE_ZONE( name )
+#define CHILI_PROFILE_FRAME()
+
+#endif
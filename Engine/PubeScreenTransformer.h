@@ -7,8 +7,13 @@ class PubeScreenTransformer
 public:
 	PubeScreenTransformer()
 		:
-		xFactor( float( Graphics::ScreenWidth ) / 2.0f ),
-		yFactor( float( Graphics::ScreenHeight ) / 2.0f )
+		PubeScreenTransformer( Graphics::ScreenWidth,Graphics::ScreenHeight )
+	{}
+	// onto a width x height surface, e.g. one rendered below screen resolution
+	PubeScreenTransformer( unsigned int width,unsigned int height )
+		:
+		xFactor( float( width ) / 2.0f ),
+		yFactor( float( height ) / 2.0f )
 	{}
 	Vec3& Transform( Vec3& v ) const
 	{
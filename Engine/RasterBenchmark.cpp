@@ -0,0 +1,219 @@
+/******************************************************************************************
+*	Chili DirectX Framework Version 16.10.01											  *
+*	RasterBenchmark.cpp																	  *
+*	Copyright 2016 PlanetChili <http://www.planetchili.net>								  *
+*																						  *
+*	This file is part of The Chili DirectX Framework.									  *
+*																						  *
+*	The Chili DirectX Framework is free software: you can redistribute it and/or modify	  *
+*	it under the terms of the GNU General Public License as published by				  *
+*	the Free Software Foundation, either version 3 of the License, or					  *
+*	(at your option) any later version.													  *
+*																						  *
+*	The Chili DirectX Framework is distributed in the hope that it will be useful,		  *
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of						  *
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the						  *
+*	GNU General Public License for more details.										  *
+*																						  *
+*	You should have received a copy of the GNU General Public License					  *
+*	along with The Chili DirectX Framework.  If not, see <http://www.gnu.org/licenses/>.  *
+******************************************************************************************/
+#include "RasterBenchmark.h"
+#include "Graphics.h"
+#include "HeadlessPresenter.h"
+#include "ChiliMath.h"
+#include <chrono>
+#include <sstream>
+#include <iomanip>
+#include <vector>
+#include <cmath>
+#include <algorithm>
+
+namespace
+{
+	typedef std::chrono::steady_clock Clock;
+
+	enum class Path
+	{
+		FlatTop,
+		FlatBottom,
+		General
+	};
+
+	struct Triangle
+	{
+		Vec2 v0;
+		Vec2 v1;
+		Vec2 v2;
+	};
+
+	struct Result
+	{
+		double mean;
+		// half width of the 95% confidence interval
+		double ci;
+	};
+
+	constexpr unsigned int nWarmups = 2u;
+	constexpr unsigned int nReps = 10u;
+	// Student's t for 95% confidence with nReps - 1 degrees of freedom
+	constexpr double tCritical = 2.262;
+	// rough pixel budget per repetition, so tiny and huge triangles take similar time
+	constexpr double pixelsPerRep = 4.0e6;
+
+	Result Summarize( const std::vector<double>& samples )
+	{
+		double sum = 0.0;
+		for( double s : samples )
+		{
+			sum += s;
+		}
+		const double mean = sum / double( samples.size() );
+		double sumSq = 0.0;
+		for( double s : samples )
+		{
+			sumSq += sq( s - mean );
+		}
+		const double stdDev = std::sqrt( sumSq / double( samples.size() - 1u ) );
+		return { mean,tCritical * stdDev / std::sqrt( double( samples.size() ) ) };
+	}
+
+	// triangle of the given area and height:base ratio with its first vertex at the origin;
+	// rotation is only applied to the general path, since it would break the flat edge
+	Triangle MakeShape( Path path,float area,float aspect,float rotation )
+	{
+		const float base = std::sqrt( 2.0f * area / aspect );
+		const float height = base * aspect;
+		switch( path )
+		{
+		case Path::FlatTop:
+			return { { 0.0f,0.0f },{ base,0.0f },{ base * 0.5f,height } };
+		case Path::FlatBottom:
+			return { { base * 0.5f,0.0f },{ 0.0f,height },{ base,height } };
+		default:
+		{
+			// lopsided so no two vertices line up even at zero rotation, then scaled
+			// so its actual area (not base * height / 2) matches the requested one
+			Vec2 verts[3] = { { 0.0f,0.0f },{ base,height * 0.3f },{ base * 0.35f,height } };
+			const float shapeArea = 0.5f * std::abs( verts[1].x * verts[2].y - verts[2].x * verts[1].y );
+			const float scale = std::sqrt( area / shapeArea );
+			for( auto& v : verts )
+			{
+				v *= scale;
+			}
+			const float c = std::cos( rotation );
+			const float s = std::sin( rotation );
+			Triangle t;
+			Vec2* const pOut[3] = { &t.v0,&t.v1,&t.v2 };
+			for( int i = 0; i < 3; i++ )
+			{
+				*pOut[i] = { verts[i].x * c - verts[i].y * s,verts[i].x * s + verts[i].y * c };
+			}
+			return t;
+		}
+		}
+	}
+
+	// copies of shape scattered over the screen with sub-pixel offsets; empty if it doesn't fit
+	std::vector<Triangle> Scatter( const Triangle& shape,size_t count )
+	{
+		const float minX = std::min( { shape.v0.x,shape.v1.x,shape.v2.x } );
+		const float maxX = std::max( { shape.v0.x,shape.v1.x,shape.v2.x } );
+		const float minY = std::min( { shape.v0.y,shape.v1.y,shape.v2.y } );
+		const float maxY = std::max( { shape.v0.y,shape.v1.y,shape.v2.y } );
+		const float slackX = float( Graphics::ScreenWidth ) - (maxX - minX) - 1.0f;
+		const float slackY = float( Graphics::ScreenHeight ) - (maxY - minY) - 1.0f;
+		std::vector<Triangle> triangles;
+		if( slackX < 0.0f || slackY < 0.0f )
+		{
+			return triangles;
+		}
+		// fixed seed so every run draws the same triangles
+		unsigned int rng = 12345u;
+		const auto random = [&rng]()
+		{
+			rng = rng * 1664525u + 1013904223u;
+			return float( rng >> 8 ) / float( 1u << 24 );
+		};
+		triangles.reserve( count );
+		for( size_t i = 0u; i < count; i++ )
+		{
+			const Vec2 offset = { random() * slackX - minX,random() * slackY - minY };
+			triangles.push_back( { shape.v0 + offset,shape.v1 + offset,shape.v2 + offset } );
+		}
+		return triangles;
+	}
+}
+
+std::wstring RunRasterBenchmark()
+{
+	auto pPresenter = std::make_unique<HeadlessPresenter>( Graphics::ScreenWidth,Graphics::ScreenHeight );
+	Graphics gfx( std::move( pPresenter ) );
+
+	const float areas[] = { 1.0f,10.0f,100.0f,1000.0f,10000.0f,100000.0f };
+	const float aspects[] = { 1.0f,4.0f,16.0f };
+	const float rotations[] = { 15.0f,45.0f,75.0f };
+	const struct
+	{
+		Path path;
+		const wchar_t* name;
+	} paths[] = {
+		{ Path::FlatTop,L"flat top" },
+		{ Path::FlatBottom,L"flat bottom" },
+		{ Path::General,L"general" }
+	};
+
+	std::wostringstream report;
+	report << std::fixed;
+	report << L"path         area   aspect  rot     Mtri/s (95% CI)        Mpix/s (95% CI)\n";
+	for( const auto& p : paths )
+	{
+		for( float area : areas )
+		{
+			for( float aspect : aspects )
+			{
+				// flat paths only exist unrotated
+				const size_t nRotations = p.path == Path::General ? sizeof( rotations ) / sizeof( *rotations ) : 1u;
+				for( size_t r = 0u; r < nRotations; r++ )
+				{
+					const float degrees = p.path == Path::General ? rotations[r] : 0.0f;
+					const size_t count = static_cast<size_t>( std::min( std::max( pixelsPerRep / double( area ),64.0 ),200000.0 ) );
+					const std::vector<Triangle> triangles = Scatter(
+						MakeShape( p.path,area,aspect,degrees * PI / 180.0f ),count );
+					report << std::left << std::setw( 12 ) << p.name << std::right
+						<< std::setprecision( 0 ) << std::setw( 7 ) << area
+						<< std::setw( 7 ) << aspect << std::setw( 6 ) << degrees;
+					if( triangles.empty() )
+					{
+						report << L"     does not fit on screen\n";
+						continue;
+					}
+					std::vector<double> triRates;
+					std::vector<double> pixRates;
+					for( unsigned int rep = 0u; rep < nWarmups + nReps; rep++ )
+					{
+						gfx.BeginFrame();
+						const auto start = Clock::now();
+						for( const Triangle& t : triangles )
+						{
+							gfx.DrawTriangle( t.v0,t.v1,t.v2,Colors::White );
+						}
+						const std::chrono::duration<double> elapsed = Clock::now() - start;
+						gfx.EndFrame();
+						if( rep >= nWarmups )
+						{
+							triRates.push_back( double( triangles.size() ) / elapsed.count() / 1.0e6 );
+							pixRates.push_back( double( gfx.GetRasterStats().pixelsWritten ) / elapsed.count() / 1.0e6 );
+						}
+					}
+					const Result tri = Summarize( triRates );
+					const Result pix = Summarize( pixRates );
+					report << std::setprecision( 3 )
+						<< std::setw( 11 ) << tri.mean << L" +- " << std::setw( 7 ) << tri.ci
+						<< std::setw( 12 ) << pix.mean << L" +- " << std::setw( 7 ) << pix.ci << L"\n";
+				}
+			}
+		}
+	}
+	return report.str();
+}
@@ -0,0 +1,29 @@
+/******************************************************************************************
+*	Chili DirectX Framework Version 16.10.01											  *
+*	RasterBenchmark.h																	  *
+*	Copyright 2016 PlanetChili <http://www.planetchili.net>								  *
+*																						  *
+*	This file is part of The Chili DirectX Framework.									  *
+*																						  *
+*	The Chili DirectX Framework is free software: you can redistribute it and/or modify	  *
+*	it under the terms of the GNU General Public License as published by				  *
+*	the Free Software Foundation, either version 3 of the License, or					  *
+*	(at your option) any later version.													  *
+*																						  *
+*	The Chili DirectX Framework is distributed in the hope that it will be useful,		  *
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of						  *
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the						  *
+*	GNU General Public License for more details.										  *
+*																						  *
+*	You should have received a copy of the GNU General Public License					  *
+*	along with The Chili DirectX Framework.  If not, see <http://www.gnu.org/licenses/>.  *
+******************************************************************************************/
+#pragma once
+
+#include <string>
+
+// times Graphics::DrawTriangle on a headless target over a sweep of triangle areas
+// (1 to 100k pixels), aspect ratios and rotations, separately for the flat-top,
+// flat-bottom and general (split) paths
+// returns a table of Mtri/s and Mpix/s with 95% confidence intervals
+std::wstring RunRasterBenchmark();
@@ -0,0 +1,74 @@
+/******************************************************************************************
+*	Chili DirectX Framework Version 16.10.01											  *
+*	Replay.cpp																			  *
+*	Copyright 2016 PlanetChili <http://www.planetchili.net>								  *
+*																						  *
+*	This file is part of The Chili DirectX Framework.									  *
+*																						  *
+*	The Chili DirectX Framework is free software: you can redistribute it and/or modify	  *
+*	it under the terms of the GNU General Public License as published by				  *
+*	the Free Software Foundation, either version 3 of the License, or					  *
+*	(at your option) any later version.													  *
+*																						  *
+*	The Chili DirectX Framework is distributed in the hope that it will be useful,		  *
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of						  *
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the						  *
+*	GNU General Public License for more details.										  *
+*																						  *
+*	You should have received a copy of the GNU General Public License					  *
+*	along with The Chili DirectX Framework.  If not, see <http://www.gnu.org/licenses/>.  *
+******************************************************************************************/
+#include "Replay.h"
+#include "Game.h"
+#include "InputLog.h"
+#include "HeadlessPresenter.h"
+#include <chrono>
+#include <sstream>
+#include <iomanip>
+
+std::wstring RunReplay( const std::string& logFile,const std::wstring& videoFile )
+{
+	InputLog log = InputLog::Load( logFile );
+	Keyboard kbd;
+	Mouse mouse;
+	auto pPresenter = std::make_unique<HeadlessPresenter>( Graphics::ScreenWidth,Graphics::ScreenHeight );
+	// combined hash of every frame, in order
+	unsigned long long hash = 0u;
+	pPresenter->SetPresentCallback( [&hash]( const Surface& frame )
+	{
+		hash = hash * 1099511628211ull ^ frame.GetHash();
+	} );
+	Game game( kbd,mouse,std::move( pPresenter ),Game::Mode::Lockstep );
+	if( !videoFile.empty() )
+	{
+		game.StartVideo( videoFile );
+	}
+
+	const auto start = std::chrono::steady_clock::now();
+	for( unsigned int frame = 0u; frame < log.GetFrameCount(); frame++ )
+	{
+		log.Replay( frame,kbd,mouse );
+		game.Go();
+	}
+	const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+	std::wostringstream report;
+	report << L"Frames: " << log.GetFrameCount() << L"\n";
+	report << L"Events: " << log.GetEntries().size() << L"\n";
+	report << std::fixed << std::setprecision( 3 );
+	report << L"Time: " << elapsed.count() << L" s\n";
+	report << L"Frame rate: " << double( log.GetFrameCount() ) / elapsed.count() << L" fps\n";
+	// what the per-frame allocators needed, for sizing them up front
+	const FrameArena::Stats arena = game.GetGraphics().GetFrameArena().GetStats();
+	const SurfacePool::Stats pool = game.GetGraphics().GetSurfacePool().GetStats();
+	report << L"Frame arena: " << arena.peak << L" bytes peak, " << arena.capacity << L" capacity, "
+		<< arena.nGrowths << L" growths\n";
+	report << L"Surface pool: " << pool.peakBytesLeased << L" bytes peak leased, "
+		<< pool.heapAllocations << L" of " << pool.acquired << L" acquisitions from the heap\n";
+	report << L"Output hash: " << std::hex << std::setw( 16 ) << std::setfill( L'0' ) << hash << L"\n";
+	if( !videoFile.empty() )
+	{
+		report << L"\nVideo: " << videoFile << L"\n" << game.StopVideo().ToString();
+	}
+	return report.str();
+}
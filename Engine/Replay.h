@@ -0,0 +1,29 @@
+/******************************************************************************************
+*	Chili DirectX Framework Version 16.10.01											  *
+*	Replay.h																			  *
+*	Copyright 2016 PlanetChili <http://www.planetchili.net>								  *
+*																						  *
+*	This file is part of The Chili DirectX Framework.									  *
+*																						  *
+*	The Chili DirectX Framework is free software: you can redistribute it and/or modify	  *
+*	it under the terms of the GNU General Public License as published by				  *
+*	the Free Software Foundation, either version 3 of the License, or					  *
+*	(at your option) any later version.													  *
+*																						  *
+*	The Chili DirectX Framework is distributed in the hope that it will be useful,		  *
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of						  *
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the						  *
+*	GNU General Public License for more details.										  *
+*																						  *
+*	You should have received a copy of the GNU General Public License					  *
+*	along with The Chili DirectX Framework.  If not, see <http://www.gnu.org/licenses/>.  *
+******************************************************************************************/
+#pragma once
+
+#include <string>
+
+// plays an input log back through a headless Game in lockstep, one frame per logged frame
+// returns a report with the time taken and a hash of every presented frame, which is
+// identical between runs of the same log
+// with videoFile, the frames are also recorded to it as .y4m and the report says how that went
+std::wstring RunReplay( const std::string& logFile,const std::wstring& videoFile = {} );
@@ -0,0 +1,84 @@
+/******************************************************************************************
+*	Chili DirectX Framework Version 16.10.01											  *
+*	ResolutionController.cpp															  *
+*	Copyright 2016 PlanetChili <http://www.planetchili.net>								  *
+*																						  *
+*	This file is part of The Chili DirectX Framework.									  *
+*																						  *
+*	The Chili DirectX Framework is free software: you can redistribute it and/or modify	  *
+*	it under the terms of the GNU General Public License as published by				  *
+*	the Free Software Foundation, either version 3 of the License, or					  *
+*	(at your option) any later version.													  *
+*																						  *
+*	The Chili DirectX Framework is distributed in the hope that it will be useful,		  *
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of						  *
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the						  *
+*	GNU General Public License for more details.										  *
+*																						  *
+*	You should have received a copy of the GNU General Public License					  *
+*	along with The Chili DirectX Framework.  If not, see <http://www.gnu.org/licenses/>.  *
+******************************************************************************************/
+#include "ResolutionController.h"
+#include <algorithm>
+
+namespace
+{
+	// per axis; every step is a multiple of 8 pixels at 640
+	constexpr float scales[] = { 1.0f,0.875f,0.75f,0.625f,0.5f };
+	constexpr unsigned int nScales = sizeof( scales ) / sizeof( *scales );
+}
+
+ResolutionController::ResolutionController( float targetMs,unsigned int fullWidth,unsigned int fullHeight )
+	:
+	targetMs( targetMs ),
+	fullWidth( fullWidth ),
+	fullHeight( fullHeight )
+{}
+
+bool ResolutionController::Update( float frameMs )
+{
+	// the first frame after a change seeds the average, rather than dragging the old cost along
+	average = nSamples == 0u ? frameMs : average + (frameMs - average) * smoothing;
+	nSamples++;
+	nOver = average > targetMs ? nOver + 1u : 0u;
+	if( nOver >= framesToStepDown && step + 1u < nScales )
+	{
+		ChangeStep( step + 1u );
+		return true;
+	}
+	if( step > 0u )
+	{
+		const float upScale = scales[step - 1u] / scales[step];
+		const float predicted = average * upScale * upScale;
+		nUnder = predicted < targetMs * stepUpMargin ? nUnder + 1u : 0u;
+		if( nUnder >= framesToStepUp )
+		{
+			ChangeStep( step - 1u );
+			return true;
+		}
+	}
+	return false;
+}
+
+unsigned int ResolutionController::GetWidth() const
+{
+	return std::max( static_cast<unsigned int>( float( fullWidth ) * scales[step] + 0.5f ),1u );
+}
+
+unsigned int ResolutionController::GetHeight() const
+{
+	return std::max( static_cast<unsigned int>( float( fullHeight ) * scales[step] + 0.5f ),1u );
+}
+
+float ResolutionController::GetScale() const
+{
+	return scales[step];
+}
+
+void ResolutionController::ChangeStep( unsigned int newStep )
+{
+	step = newStep;
+	nSamples = 0u;
+	nOver = 0u;
+	nUnder = 0u;
+}
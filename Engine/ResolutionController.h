@@ -0,0 +1,69 @@
+/******************************************************************************************
+*	Chili DirectX Framework Version 16.10.01											  *
+*	ResolutionController.h																  *
+*	Copyright 2016 PlanetChili <http://www.planetchili.net>								  *
+*																						  *
+*	This file is part of The Chili DirectX Framework.									  *
+*																						  *
+*	The Chili DirectX Framework is free software: you can redistribute it and/or modify	  *
+*	it under the terms of the GNU General Public License as published by				  *
+*	the Free Software Foundation, either version 3 of the License, or					  *
+*	(at your option) any later version.													  *
+*																						  *
+*	The Chili DirectX Framework is distributed in the hope that it will be useful,		  *
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of						  *
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the						  *
+*	GNU General Public License for more details.										  *
+*																						  *
+*	You should have received a copy of the GNU General Public License					  *
+*	along with The Chili DirectX Framework.  If not, see <http://www.gnu.org/licenses/>.  *
+******************************************************************************************/
+#pragma once
+
+// picks the internal render resolution from measured frame cost, stepping through a fixed
+// ladder of scales so resolution only changes in noticeable, poolable steps
+// it steps down once the smoothed cost has been over target for a few frames, and back up only
+// when the cost predicted for the next step up (cost scales with pixel count) stays under
+// target by a margin for a good while; the gap between the two keeps it from oscillating
+class ResolutionController
+{
+public:
+	ResolutionController( float targetMs,unsigned int fullWidth,unsigned int fullHeight );
+	// feed the cost of one frame; true if the resolution changed
+	bool Update( float frameMs );
+	void SetTarget( float targetMsIn )
+	{
+		targetMs = targetMsIn;
+	}
+	float GetTarget() const
+	{
+		return targetMs;
+	}
+	unsigned int GetWidth() const;
+	unsigned int GetHeight() const;
+	// fraction of full resolution along each axis
+	float GetScale() const;
+	// smoothed frame cost at the current resolution
+	float GetAverage() const
+	{
+		return average;
+	}
+private:
+	void ChangeStep( unsigned int newStep );
+private:
+	// weight of the newest frame in the running average
+	static constexpr float smoothing = 0.1f;
+	static constexpr unsigned int framesToStepDown = 4u;
+	static constexpr unsigned int framesToStepUp = 60u;
+	// only step up if the next step is predicted to cost at most this fraction of target
+	static constexpr float stepUpMargin = 0.8f;
+	float targetMs;
+	unsigned int fullWidth;
+	unsigned int fullHeight;
+	// index into the scale ladder, 0 being full resolution
+	unsigned int step = 0u;
+	float average = 0.0f;
+	unsigned int nSamples = 0u;
+	unsigned int nOver = 0u;
+	unsigned int nUnder = 0u;
+};
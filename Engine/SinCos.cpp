@@ -0,0 +1,146 @@
+/******************************************************************************************
+*	Chili DirectX Framework Version 16.10.01											  *
+*	SinCos.cpp																			  *
+*	Copyright 2016 PlanetChili <http://www.planetchili.net>								  *
+*																						  *
+*	This file is part of The Chili DirectX Framework.									  *
+*																						  *
+*	The Chili DirectX Framework is free software: you can redistribute it and/or modify	  *
+*	it under the terms of the GNU General Public License as published by				  *
+*	the Free Software Foundation, either version 3 of the License, or					  *
+*	(at your option) any later version.													  *
+*																						  *
+*	The Chili DirectX Framework is distributed in the hope that it will be useful,		  *
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of						  *
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the						  *
+*	GNU General Public License for more details.										  *
+*																						  *
+*	You should have received a copy of the GNU General Public License					  *
+*	along with The Chili DirectX Framework.  If not, see <http://www.gnu.org/licenses/>.  *
+******************************************************************************************/
+#include "SinCos.h"
+#include <emmintrin.h>
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+// gcc contracts even vector intrinsics' multiplies and adds into fused multiply-adds when built
+// for fma capable targets, which would round the versions (and the 4 and 8 wide loops) differently
+#if defined( __GNUC__ ) && !defined( __clang__ )
+#pragma GCC optimize( "fp-contract=off" )
+#endif
+
+namespace
+{
+	constexpr float twoOverPi = 0.636619772f;
+	// pi/2 split so that q * piOver2A and q * piOver2B are exact for the q of any |x| <= 8192
+	constexpr float piOver2A = 1.5703125f;
+	constexpr float piOver2B = 4.837512969970703125e-4f;
+	constexpr float piOver2C = 7.54978995489188216e-8f;
+	// sin( r ) ~ r + r^3 (s1 + s2 r^2 + s3 r^4) on [-pi/4,pi/4]
+	constexpr float s1 = -1.6666654611e-1f;
+	constexpr float s2 = 8.3321608736e-3f;
+	constexpr float s3 = -1.9515295891e-4f;
+	// cos( r ) ~ 1 - r^2 / 2 + r^4 (c1 + c2 r^2 + c3 r^4)
+	constexpr float c1 = 4.166664568298827e-2f;
+	constexpr float c2 = -1.388731625493765e-3f;
+	constexpr float c3 = 2.443315711809948e-5f;
+}
+
+void FastSinCos( float x,float& sine,float& cosine )
+{
+	// the same operations as the vector loops, one lane wide: plain float arithmetic could be
+	// contracted into fused multiply-adds (e.g. when built for AVX2), rounding differently
+	const __m128 xs = _mm_set_ss( x );
+	const int q = _mm_cvtss_si32( _mm_mul_ss( xs,_mm_set_ss( twoOverPi ) ) );
+	const __m128 qf = _mm_cvtsi32_ss( _mm_setzero_ps(),q );
+	__m128 r = _mm_sub_ss( xs,_mm_mul_ss( qf,_mm_set_ss( piOver2A ) ) );
+	r = _mm_sub_ss( r,_mm_mul_ss( qf,_mm_set_ss( piOver2B ) ) );
+	r = _mm_sub_ss( r,_mm_mul_ss( qf,_mm_set_ss( piOver2C ) ) );
+	const __m128 z = _mm_mul_ss( r,r );
+	__m128 s = _mm_add_ss( _mm_mul_ss( _mm_set_ss( s3 ),z ),_mm_set_ss( s2 ) );
+	s = _mm_add_ss( _mm_mul_ss( s,z ),_mm_set_ss( s1 ) );
+	s = _mm_add_ss( _mm_mul_ss( _mm_mul_ss( s,z ),r ),r );
+	__m128 c = _mm_add_ss( _mm_mul_ss( _mm_set_ss( c3 ),z ),_mm_set_ss( c2 ) );
+	c = _mm_add_ss( _mm_mul_ss( c,z ),_mm_set_ss( c1 ) );
+	c = _mm_sub_ss( _mm_mul_ss( _mm_mul_ss( c,z ),z ),_mm_mul_ss( _mm_set_ss( 0.5f ),z ) );
+	c = _mm_add_ss( c,_mm_set_ss( 1.0f ) );
+	// odd quadrants swap sin and cos; quadrants 2 and 3 negate sin, 1 and 2 negate cos
+	const bool swap = (q & 1) != 0;
+	sine = _mm_cvtss_f32( swap ? c : s );
+	cosine = _mm_cvtss_f32( swap ? s : c );
+	if( q & 2 )
+	{
+		sine = -sine;
+	}
+	if( (q + 1) & 2 )
+	{
+		cosine = -cosine;
+	}
+}
+
+void FastSinCos( const float* angles,float* sines,float* cosines,size_t n )
+{
+	size_t i = 0u;
+#ifdef __AVX2__
+	{
+		const __m256i one = _mm256_set1_epi32( 1 );
+		const __m256i two = _mm256_set1_epi32( 2 );
+		for( ; i + 8u <= n; i += 8u )
+		{
+			const __m256 x = _mm256_loadu_ps( angles + i );
+			const __m256i q = _mm256_cvtps_epi32( _mm256_mul_ps( x,_mm256_set1_ps( twoOverPi ) ) );
+			const __m256 qf = _mm256_cvtepi32_ps( q );
+			__m256 r = _mm256_sub_ps( x,_mm256_mul_ps( qf,_mm256_set1_ps( piOver2A ) ) );
+			r = _mm256_sub_ps( r,_mm256_mul_ps( qf,_mm256_set1_ps( piOver2B ) ) );
+			r = _mm256_sub_ps( r,_mm256_mul_ps( qf,_mm256_set1_ps( piOver2C ) ) );
+			const __m256 z = _mm256_mul_ps( r,r );
+			__m256 s = _mm256_add_ps( _mm256_mul_ps( _mm256_set1_ps( s3 ),z ),_mm256_set1_ps( s2 ) );
+			s = _mm256_add_ps( _mm256_mul_ps( s,z ),_mm256_set1_ps( s1 ) );
+			s = _mm256_add_ps( _mm256_mul_ps( _mm256_mul_ps( s,z ),r ),r );
+			__m256 c = _mm256_add_ps( _mm256_mul_ps( _mm256_set1_ps( c3 ),z ),_mm256_set1_ps( c2 ) );
+			c = _mm256_add_ps( _mm256_mul_ps( c,z ),_mm256_set1_ps( c1 ) );
+			c = _mm256_sub_ps( _mm256_mul_ps( _mm256_mul_ps( c,z ),z ),_mm256_mul_ps( _mm256_set1_ps( 0.5f ),z ) );
+			c = _mm256_add_ps( c,_mm256_set1_ps( 1.0f ) );
+			const __m256 swap = _mm256_castsi256_ps( _mm256_cmpeq_epi32( _mm256_and_si256( q,one ),one ) );
+			const __m256 sineSign = _mm256_castsi256_ps( _mm256_slli_epi32( _mm256_and_si256( q,two ),30 ) );
+			const __m256 cosineSign = _mm256_castsi256_ps( _mm256_slli_epi32( _mm256_and_si256( _mm256_add_epi32( q,one ),two ),30 ) );
+			_mm256_storeu_ps( sines + i,_mm256_xor_ps( _mm256_blendv_ps( s,c,swap ),sineSign ) );
+			_mm256_storeu_ps( cosines + i,_mm256_xor_ps( _mm256_blendv_ps( c,s,swap ),cosineSign ) );
+		}
+	}
+#endif
+	{
+		const __m128i one = _mm_set1_epi32( 1 );
+		const __m128i two = _mm_set1_epi32( 2 );
+		for( ; i + 4u <= n; i += 4u )
+		{
+			const __m128 x = _mm_loadu_ps( angles + i );
+			const __m128i q = _mm_cvtps_epi32( _mm_mul_ps( x,_mm_set1_ps( twoOverPi ) ) );
+			const __m128 qf = _mm_cvtepi32_ps( q );
+			__m128 r = _mm_sub_ps( x,_mm_mul_ps( qf,_mm_set1_ps( piOver2A ) ) );
+			r = _mm_sub_ps( r,_mm_mul_ps( qf,_mm_set1_ps( piOver2B ) ) );
+			r = _mm_sub_ps( r,_mm_mul_ps( qf,_mm_set1_ps( piOver2C ) ) );
+			const __m128 z = _mm_mul_ps( r,r );
+			__m128 s = _mm_add_ps( _mm_mul_ps( _mm_set1_ps( s3 ),z ),_mm_set1_ps( s2 ) );
+			s = _mm_add_ps( _mm_mul_ps( s,z ),_mm_set1_ps( s1 ) );
+			s = _mm_add_ps( _mm_mul_ps( _mm_mul_ps( s,z ),r ),r );
+			__m128 c = _mm_add_ps( _mm_mul_ps( _mm_set1_ps( c3 ),z ),_mm_set1_ps( c2 ) );
+			c = _mm_add_ps( _mm_mul_ps( c,z ),_mm_set1_ps( c1 ) );
+			c = _mm_sub_ps( _mm_mul_ps( _mm_mul_ps( c,z ),z ),_mm_mul_ps( _mm_set1_ps( 0.5f ),z ) );
+			c = _mm_add_ps( c,_mm_set1_ps( 1.0f ) );
+			// SSE2 has no blend: select through and/andnot
+			const __m128 swap = _mm_castsi128_ps( _mm_cmpeq_epi32( _mm_and_si128( q,one ),one ) );
+			const __m128 sineSign = _mm_castsi128_ps( _mm_slli_epi32( _mm_and_si128( q,two ),30 ) );
+			const __m128 cosineSign = _mm_castsi128_ps( _mm_slli_epi32( _mm_and_si128( _mm_add_epi32( q,one ),two ),30 ) );
+			const __m128 sine = _mm_or_ps( _mm_and_ps( swap,c ),_mm_andnot_ps( swap,s ) );
+			const __m128 cosine = _mm_or_ps( _mm_and_ps( swap,s ),_mm_andnot_ps( swap,c ) );
+			_mm_storeu_ps( sines + i,_mm_xor_ps( sine,sineSign ) );
+			_mm_storeu_ps( cosines + i,_mm_xor_ps( cosine,cosineSign ) );
+		}
+	}
+	for( ; i < n; i++ )
+	{
+		FastSinCos( angles[i],sines[i],cosines[i] );
+	}
+}
@@ -0,0 +1,35 @@
+/******************************************************************************************
+*	Chili DirectX Framework Version 16.10.01											  *
+*	SinCos.h																			  *
+*	Copyright 2016 PlanetChili <http://www.planetchili.net>								  *
+*																						  *
+*	This file is part of The Chili DirectX Framework.									  *
+*																						  *
+*	The Chili DirectX Framework is free software: you can redistribute it and/or modify	  *
+*	it under the terms of the GNU General Public License as published by				  *
+*	the Free Software Foundation, either version 3 of the License, or					  *
+*	(at your option) any later version.													  *
+*																						  *
+*	The Chili DirectX Framework is distributed in the hope that it will be useful,		  *
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of						  *
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the						  *
+*	GNU General Public License for more details.										  *
+*																						  *
+*	You should have received a copy of the GNU General Public License					  *
+*	along with The Chili DirectX Framework.  If not, see <http://www.gnu.org/licenses/>.  *
+******************************************************************************************/
+#pragma once
+
+#include <stddef.h>
+
+// sine and cosine of the same angle from one range reduction and two short polynomials, for
+// setting up many rotations at once (e.g. per instance, into Mat3::RotationXYZ's sin/cos form)
+// the angle is reduced to [-pi/4,pi/4] about the nearest multiple of pi/2 in three parts
+// (Cody-Waite), then sin and cos come from degree 7 and 8 minimax polynomials
+// max error against double precision is 7.8e-8 absolute for |x| <= 8192 (sinf and cosf: 3.3e-8)
+// the reduction loses precision beyond that, so wrap larger angles first
+// the batch version takes 4 angles per SSE2 step (8 per AVX2 step when built for it) and gives
+// results bit identical to the single angle version; --check-sincos checks both claims
+void FastSinCos( float x,float& sine,float& cosine );
+// sines[i] and cosines[i] of angles[i] for i in [0,n); the arrays may not overlap
+void FastSinCos( const float* angles,float* sines,float* cosines,size_t n );
@@ -0,0 +1,136 @@
+/******************************************************************************************
+*	Chili DirectX Framework Version 16.10.01											  *
+*	SinCosCheck.cpp																		  *
+*	Copyright 2016 PlanetChili <http://www.planetchili.net>								  *
+*																						  *
+*	This file is part of The Chili DirectX Framework.									  *
+*																						  *
+*	The Chili DirectX Framework is free software: you can redistribute it and/or modify	  *
+*	it under the terms of the GNU General Public License as published by				  *
+*	the Free Software Foundation, either version 3 of the License, or					  *
+*	(at your option) any later version.													  *
+*																						  *
+*	The Chili DirectX Framework is distributed in the hope that it will be useful,		  *
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of						  *
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the						  *
+*	GNU General Public License for more details.										  *
+*																						  *
+*	You should have received a copy of the GNU General Public License					  *
+*	along with The Chili DirectX Framework.  If not, see <http://www.gnu.org/licenses/>.  *
+******************************************************************************************/
+#include "SinCosCheck.h"
+#include "SinCos.h"
+#include "ChiliMath.h"
+#include <sstream>
+#include <iomanip>
+#include <vector>
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+
+namespace
+{
+	// the bound SinCos.h documents, over the range it documents
+	constexpr double maxError = 7.8e-8;
+	constexpr float maxAngle = 8192.0f;
+
+	struct Result
+	{
+		double sineError = 0.0;
+		double cosineError = 0.0;
+		size_t mismatches = 0u;
+	};
+
+	Result Check( const std::vector<float>& angles )
+	{
+		const size_t n = angles.size();
+		std::vector<float> sines( n );
+		std::vector<float> cosines( n );
+		FastSinCos( angles.data(),sines.data(),cosines.data(),n );
+		Result result;
+		for( size_t i = 0u; i < n; i++ )
+		{
+			float sine;
+			float cosine;
+			FastSinCos( angles[i],sine,cosine );
+			// compared as bits, so that -0 against 0 counts too
+			if( std::memcmp( &sine,&sines[i],sizeof( sine ) ) != 0 ||
+				std::memcmp( &cosine,&cosines[i],sizeof( cosine ) ) != 0 )
+			{
+				result.mismatches++;
+			}
+			const double x = double( angles[i] );
+			result.sineError = std::max( result.sineError,std::abs( double( sines[i] ) - std::sin( x ) ) );
+			result.cosineError = std::max( result.cosineError,std::abs( double( cosines[i] ) - std::cos( x ) ) );
+		}
+		return result;
+	}
+}
+
+bool RunSinCosCheck( std::wstring& report )
+{
+	// counts are deliberately not multiples of 8, so the single angle tail is covered as well
+	std::vector<float> sweep;
+	const int nSweep = 1 << 20;
+	for( int i = -nSweep; i <= nSweep; i++ )
+	{
+		sweep.push_back( float( i ) * (2.0f * PI / float( nSweep )) );
+	}
+	// where the reduction changes quadrant, and so where it cancels the most
+	std::vector<float> boundaries;
+	for( int q = -int( maxAngle / (PI / 2.0f) ); q <= int( maxAngle / (PI / 2.0f) ); q++ )
+	{
+		const float x = float( double( q ) * 1.57079632679489661923 );
+		for( float step : { -1.0f,1.0f } )
+		{
+			float y = x;
+			for( int i = 0; i < 4; i++ )
+			{
+				y = std::nextafter( y,step * maxAngle * 2.0f );
+				boundaries.push_back( y );
+			}
+		}
+		boundaries.push_back( x );
+	}
+	// fixed seed so every run checks the same angles
+	std::vector<float> random;
+	unsigned int rng = 12345u;
+	for( int i = 0; i < (1 << 20) + 3; i++ )
+	{
+		rng = rng * 1664525u + 1013904223u;
+		random.push_back( (float( rng >> 8 ) / float( 1u << 24 ) * 2.0f - 1.0f) * maxAngle );
+	}
+	random.push_back( 0.0f );
+	random.push_back( -0.0f );
+	random.push_back( maxAngle );
+	random.push_back( -maxAngle );
+
+	const struct
+	{
+		const wchar_t* name;
+		const std::vector<float>& angles;
+	} sets[] = {
+		{ L"sweep [-2pi,2pi]",sweep },
+		{ L"quadrant edges",boundaries },
+		{ L"random [-8192,8192]",random }
+	};
+
+	std::wostringstream out;
+	out << L"set                     angles   sin error   cos error   mismatches\n";
+	bool passed = true;
+	for( const auto& s : sets )
+	{
+		const Result r = Check( s.angles );
+		const bool ok = r.sineError <= maxError && r.cosineError <= maxError && r.mismatches == 0u;
+		passed = passed && ok;
+		out << std::left << std::setw( 20 ) << s.name << std::right
+			<< std::setw( 10 ) << s.angles.size()
+			<< std::scientific << std::setprecision( 2 )
+			<< std::setw( 12 ) << r.sineError << std::setw( 12 ) << r.cosineError
+			<< std::setw( 13 ) << r.mismatches << (ok ? L"  ok\n" : L"  FAILED\n");
+	}
+	out << L"\nbound " << std::scientific << std::setprecision( 2 ) << maxError << L": "
+		<< (passed ? L"all sets within it, batch and single angle results identical" : L"FAILED");
+	report = out.str();
+	return passed;
+}
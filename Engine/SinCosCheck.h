@@ -0,0 +1,30 @@
+/******************************************************************************************
+*	Chili DirectX Framework Version 16.10.01											  *
+*	SinCosCheck.h																		  *
+*	Copyright 2016 PlanetChili <http://www.planetchili.net>								  *
+*																						  *
+*	This file is part of The Chili DirectX Framework.									  *
+*																						  *
+*	The Chili DirectX Framework is free software: you can redistribute it and/or modify	  *
+*	it under the terms of the GNU General Public License as published by				  *
+*	the Free Software Foundation, either version 3 of the License, or					  *
+*	(at your option) any later version.													  *
+*																						  *
+*	The Chili DirectX Framework is distributed in the hope that it will be useful,		  *
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of						  *
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the						  *
+*	GNU General Public License for more details.										  *
+*																						  *
+*	You should have received a copy of the GNU General Public License					  *
+*	along with The Chili DirectX Framework.  If not, see <http://www.gnu.org/licenses/>.  *
+******************************************************************************************/
+#pragma once
+
+#include <string>
+
+// checks FastSinCos against double precision sin and cos over a dense sweep of a few turns,
+// the angles either side of every multiple of pi/2 up to 8192, and random angles up to 8192,
+// and checks that the batch version's results are bit identical to the single angle version's
+// report gets the largest errors and the mismatch count per set of angles
+// returns false if any error is over the documented bound or any result differs
+bool RunSinCosCheck( std::wstring& report );
@@ -0,0 +1,116 @@
+/******************************************************************************************
+*	Chili DirectX Framework Version 16.10.01											  *
+*	SpscRing.h																			  *
+*	Copyright 2016 PlanetChili <http://www.planetchili.net>								  *
+*																						  *
+*	This file is part of The Chili DirectX Framework.									  *
+*																						  *
+*	The Chili DirectX Framework is free software: you can redistribute it and/or modify	  *
+*	it under the terms of the GNU General Public License as published by				  *
+*	the Free Software Foundation, either version 3 of the License, or					  *
+*	(at your option) any later version.													  *
+*																						  *
+*	The Chili DirectX Framework is distributed in the hope that it will be useful,		  *
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of						  *
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the						  *
+*	GNU General Public License for more details.										  *
+*																						  *
+*	You should have received a copy of the GNU General Public License					  *
+*	along with The Chili DirectX Framework.  If not, see <http://www.gnu.org/licenses/>.  *
+******************************************************************************************/
+#pragma once
+
+#include <atomic>
+#include <memory>
+
+// fixed capacity FIFO for exactly one producer thread and one consumer thread
+// never locks, and never allocates after construction
+// when full, Push drops the new item and counts it rather than overwriting the oldest,
+// since overwriting would need the producer to move head, which only the consumer owns;
+// consumers that don't read every item should still Clear regularly so nothing goes stale
+template<typename T>
+class SpscRing
+{
+public:
+	// capacity is rounded up to a power of two
+	explicit SpscRing( size_t minCapacity )
+		:
+		mask( RoundUpPow2( minCapacity ) - 1u ),
+		items( std::make_unique<T[]>( mask + 1u ) )
+	{}
+	SpscRing( const SpscRing& ) = delete;
+	SpscRing& operator=( const SpscRing& ) = delete;
+	// producer: false (and item dropped) if the consumer has fallen a full ring behind
+	bool Push( const T& item )
+	{
+		const size_t t = tail.load( std::memory_order_relaxed );
+		if( t - cachedHead > mask )
+		{
+			cachedHead = head.load( std::memory_order_acquire );
+			if( t - cachedHead > mask )
+			{
+				dropped.fetch_add( 1u,std::memory_order_relaxed );
+				return false;
+			}
+		}
+		items[t & mask] = item;
+		tail.store( t + 1u,std::memory_order_release );
+		return true;
+	}
+	// consumer: false if there is nothing to take
+	bool Pop( T& item )
+	{
+		const size_t h = head.load( std::memory_order_relaxed );
+		if( h == cachedTail )
+		{
+			cachedTail = tail.load( std::memory_order_acquire );
+			if( h == cachedTail )
+			{
+				return false;
+			}
+		}
+		item = items[h & mask];
+		head.store( h + 1u,std::memory_order_release );
+		return true;
+	}
+	// consumer
+	bool IsEmpty() const
+	{
+		return head.load( std::memory_order_relaxed ) == tail.load( std::memory_order_acquire );
+	}
+	// consumer: discard everything pushed so far
+	void Clear()
+	{
+		cachedTail = tail.load( std::memory_order_acquire );
+		head.store( cachedTail,std::memory_order_release );
+	}
+	size_t GetCapacity() const
+	{
+		return mask + 1u;
+	}
+	// any thread: how many pushes have been dropped because the ring was full
+	size_t GetDropped() const
+	{
+		return dropped.load( std::memory_order_relaxed );
+	}
+private:
+	static size_t RoundUpPow2( size_t n )
+	{
+		size_t p = 1u;
+		while( p < n )
+		{
+			p <<= 1;
+		}
+		return p;
+	}
+private:
+	const size_t mask;
+	std::unique_ptr<T[]> items;
+	// consumer owned: next slot to pop, and the last tail it saw
+	alignas( 64 ) std::atomic<size_t> head{ 0u };
+	size_t cachedTail = 0u;
+	// producer owned: next slot to push, and the last head it saw
+	alignas( 64 ) std::atomic<size_t> tail{ 0u };
+	size_t cachedHead = 0u;
+	std::atomic<size_t> dropped{ 0u };
+};
@@ -18,19 +18,27 @@
 *	You should have received a copy of the GNU General Public License					  *
 *	along with The Chili DirectX Framework.  If not, see <http://www.gnu.org/licenses/>.  *
 ******************************************************************************************/
-#define FULL_WINTARD
-#include "ChiliWin.h"
 #include "Surface.h"
 #include "ChiliException.h"
-namespace Gdiplus
-{
-	using std::min;
-	using std::max;
-}
-#include <gdiplus.h>
+#include "Profiler.h"
+#include "ImageDecoder.h"
+#include "ImageEncoder.h"
+#include "MappedFile.h"
+#include "JobSystem.h"
 #include <sstream>
-
-#pragma comment( lib,"gdiplus.lib" )
+#include <algorithm>
+#include <exception>
+#include <cstring>
+#include <cstdint>
+#ifdef _MSC_VER
+#include <malloc.h>
+#else
+#include <cstdlib>
+#endif
+#include <emmintrin.h>
+#ifdef __AVX__
+#include <immintrin.h>
+#endif
 
 void Surface::PutPixelAlpha( unsigned int x,unsigned int y,Color c )
 {
@@ -50,108 +58,605 @@ void Surface::PutPixelAlpha( unsigned int x,unsigned int y,Color c )
 	PutPixel( x,y,{ rsltRed,rsltGreen,rsltBlue } );
 }
 
-Surface Surface::FromFile( const std::wstring & name )
+void Surface::Clear( Color fillValue )
 {
-	unsigned int width = 0;
-	unsigned int height = 0;
-	unsigned int pitch = 0;
-	std::unique_ptr<Color[]> pBuffer = nullptr;
+	// a full clear supersedes any deferred one
+	std::fill( pendingTiles.begin(),pendingTiles.end(),0u );
+	nPendingTiles = 0u;
+	Fill( pBuffer.get(),GetBufferPixelCount(),fillValue,true );
+}
 
+void Surface::FastClear( Color fillValue )
+{
+	const unsigned int nTiles = tilesX * tilesY;
+	std::fill( pendingTiles.begin(),pendingTiles.end(),~0ull );
+	// mask off the unused bits of the last word
+	if( nTiles % 64u != 0u )
 	{
-		Gdiplus::Bitmap bitmap( name.c_str() );
-		if( bitmap.GetLastStatus() != Gdiplus::Status::Ok )
+		pendingTiles.back() = (1ull << (nTiles % 64u)) - 1u;
+	}
+	nPendingTiles = nTiles;
+	clearColor = fillValue;
+}
+
+void Surface::ResolveClears() const
+{
+	for( unsigned int ty = 0u; ty < tilesY && nPendingTiles != 0u; ty++ )
+	{
+		for( unsigned int tx = 0u; tx < tilesX; tx++ )
 		{
-			std::wstringstream ss;
-			ss << L"Loading image [" << name << L"]: failed to load.";
-			throw Exception( _CRT_WIDE( __FILE__ ),__LINE__,ss.str() );
+			ResolveTile( tx,ty );
 		}
+	}
+}
 
-		pitch = width = bitmap.GetWidth();
-		height = bitmap.GetHeight();
-		pBuffer = std::make_unique<Color[]>( width * height );
+void Surface::ResolveTile( unsigned int tx,unsigned int ty ) const
+{
+	const unsigned int i = ty * tilesX + tx;
+	unsigned long long& word = pendingTiles[i >> 6u];
+	const unsigned long long bit = 1ull << (i & 63u);
+	if( (word & bit) == 0u )
+	{
+		return;
+	}
+	word &= ~bit;
+	nPendingTiles--;
+
+	const unsigned int xStart = tx << tileShift;
+	const unsigned int yStart = ty << tileShift;
+	const unsigned int xEnd = std::min( xStart + tileSize,width );
+	const unsigned int yEnd = std::min( yStart + tileSize,height );
+	for( unsigned int y = yStart; y < yEnd; y++ )
+	{
+		FillSpan( xStart,y,xEnd - xStart,clearColor );
+	}
+}
 
+void Surface::ReadSpan( Color* pDst,unsigned int x,unsigned int y,unsigned int count ) const
+{
+	if( layout == Layout::Linear )
+	{
+		memcpy( static_cast<void*>( pDst ),&pBuffer[y * pitch + x],sizeof( Color ) * count );
+		return;
+	}
+	// partial leading block
+	while( count > 0u && (x & blockMask) != 0u )
+	{
+		*pDst++ = pBuffer[Offset( x++,y )];
+		count--;
+	}
+	// whole block rows are 32 bytes and 32-byte aligned in the source
+	static_assert( blockSize * sizeof( Color ) == 2u * sizeof( __m128i ),"detile assumes 8 pixel block rows" );
+	const Color* pSrc = &pBuffer[Offset( x,y )];
+	for( ; count >= blockSize; count -= blockSize,x += blockSize,pDst += blockSize )
+	{
+		const __m128i lo = _mm_load_si128( reinterpret_cast<const __m128i*>(pSrc) );
+		const __m128i hi = _mm_load_si128( reinterpret_cast<const __m128i*>(pSrc) + 1 );
+		_mm_storeu_si128( reinterpret_cast<__m128i*>(pDst),lo );
+		_mm_storeu_si128( reinterpret_cast<__m128i*>(pDst) + 1,hi );
+		pSrc += blockSize * blockSize;
+	}
+	// partial trailing block
+	for( unsigned int i = 0u; i < count; i++ )
+	{
+		pDst[i] = pSrc[i];
+	}
+}
+
+void Surface::FillSpan( unsigned int x,unsigned int y,unsigned int count,Color c ) const
+{
+	// span is about to be drawn to, so keep it in cache
+	if( layout == Layout::Linear )
+	{
+		Fill( &pBuffer[y * pitch + x],count,c,false );
+		return;
+	}
+	while( count > 0u )
+	{
+		const unsigned int run = std::min( blockSize - (x & blockMask),count );
+		Fill( &pBuffer[Offset( x,y )],run,c,false );
+		x += run;
+		count -= run;
+	}
+}
+
+void Surface::Fill( Color* pDst,unsigned int count,Color c,bool streaming )
+{
+	if( !streaming )
+	{
+		std::fill_n( pDst,count,c );
+		return;
+	}
+#ifdef __AVX__
+	constexpr unsigned int vecBytes = 32u;
+#else
+	constexpr unsigned int vecBytes = 16u;
+#endif
+	// scalar stores until the destination is vector aligned
+	while( count > 0u && reinterpret_cast<uintptr_t>(pDst) % vecBytes != 0u )
+	{
+		*pDst++ = c;
+		count--;
+	}
+	constexpr unsigned int vecPixels = vecBytes / sizeof( Color );
+#ifdef __AVX__
+	const __m256i v = _mm256_set1_epi32( int( c.dword ) );
+	for( ; count >= vecPixels; count -= vecPixels,pDst += vecPixels )
+	{
+		_mm256_stream_si256( reinterpret_cast<__m256i*>(pDst),v );
+	}
+#else
+	const __m128i v = _mm_set1_epi32( int( c.dword ) );
+	for( ; count >= vecPixels; count -= vecPixels,pDst += vecPixels )
+	{
+		_mm_stream_si128( reinterpret_cast<__m128i*>(pDst),v );
+	}
+#endif
+	// streaming stores are weakly ordered, fence before anyone reads the buffer
+	_mm_sfence();
+	while( count-- > 0u )
+	{
+		*pDst++ = c;
+	}
+}
+
+void Surface::Present( unsigned int dstPitch,unsigned char* const pDst ) const
+{
+	CHILI_PROFILE_ZONE( "Surface::Present" );
+	if( nPendingTiles == 0u )
+	{
 		for( unsigned int y = 0; y < height; y++ )
 		{
-			for( unsigned int x = 0; x < width; x++ )
+			ReadSpan( reinterpret_cast<Color*>(&pDst[dstPitch * y]),0u,y,width );
+		}
+		return;
+	}
+	// tiles still pending a fast clear are filled straight into the destination,
+	// so the clear never touches our own buffer
+	for( unsigned int y = 0; y < height; y++ )
+	{
+		Color* const pDstRow = reinterpret_cast<Color*>(&pDst[dstPitch * y]);
+		const unsigned int ty = y >> tileShift;
+		for( unsigned int tx = 0u; tx < tilesX; tx++ )
+		{
+			const unsigned int xStart = tx << tileShift;
+			const unsigned int count = width - xStart < tileSize ? width - xStart : tileSize;
+			if( TileIsPending( tx,ty ) )
 			{
-				Gdiplus::Color c;
-				bitmap.GetPixel( x,y,&c );
-				pBuffer[y * pitch + x] = c.GetValue();
+				Fill( &pDstRow[xStart],count,clearColor,false );
+			}
+			else
+			{
+				ReadSpan( &pDstRow[xStart],xStart,y,count );
 			}
 		}
 	}
+}
+
+Surface Surface::FromFile( const std::wstring & name )
+{
+	const MappedFile file( name );
+	if( !file )
+	{
+		std::wstringstream ss;
+		ss << L"Loading image [" << name << L"]: failed to load.";
+		throw Exception( _CRT_WIDE( __FILE__ ),__LINE__,ss.str() );
+	}
+	return DecodeImage( file.GetData(),file.GetSize(),name );
+}
 
-	return Surface( width,height,pitch,std::move( pBuffer ) );
+std::vector<Surface> Surface::FromFiles( const std::vector<std::wstring>& names,JobSystem& jobs )
+{
+	std::vector<std::unique_ptr<Surface>> decoded( names.size() );
+	// jobs can't carry exceptions back to us, so each one keeps its own
+	std::vector<std::exception_ptr> errors( names.size() );
+	jobs.ParallelFor( 0u,names.size(),[&]( size_t i )
+	{
+		try
+		{
+			decoded[i] = std::make_unique<Surface>( FromFile( names[i] ) );
+		}
+		catch( ... )
+		{
+			errors[i] = std::current_exception();
+		}
+	} );
+	for( const std::exception_ptr& e : errors )
+	{
+		if( e )
+		{
+			std::rethrow_exception( e );
+		}
+	}
+	std::vector<Surface> surfaces;
+	surfaces.reserve( names.size() );
+	for( auto& pSurface : decoded )
+	{
+		surfaces.push_back( std::move( *pSurface ) );
+	}
+	return surfaces;
 }
 
 void Surface::Save( const std::wstring & filename ) const
 {
-	auto GetEncoderClsid = [&filename]( const WCHAR* format,CLSID* pClsid ) -> void
+	if( layout != Layout::Linear )
+	{
+		// encoders want row-major pixels
+		Surface linear( width,height );
+		linear.Copy( *this );
+		linear.Save( filename );
+		return;
+	}
+	ResolveClears();
+	EncodeImage( pBuffer.get(),width,height,pitch,filename );
+}
+
+unsigned long long Surface::GetHash() const
+{
+	unsigned long long hash = 14695981039346656037ull;
+	for( unsigned int y = 0u; y < height; y++ )
+	{
+		for( unsigned int x = 0u; x < width; x++ )
+		{
+			hash = (hash ^ GetPixel( x,y ).dword) * 1099511628211ull;
+		}
+	}
+	return hash;
+}
+
+void Surface::Copy( const Surface & src )
+{
+	assert( width == src.width );
+	assert( height == src.height );
+	src.ResolveClears();
+	std::fill( pendingTiles.begin(),pendingTiles.end(),0u );
+	nPendingTiles = 0u;
+	if( pitch == src.pitch && layout == src.layout )
+	{
+		memcpy( static_cast<void*>( pBuffer.get() ),src.pBuffer.get(),GetBufferPixelCount() * sizeof( Color ) );
+	}
+	else if( layout == Layout::Linear )
+	{
+		for( unsigned int y = 0; y < height; y++ )
+		{
+			src.ReadSpan( &pBuffer[pitch * y],0u,y,width );
+		}
+	}
+	else
 	{
-		UINT  num = 0;          // number of image encoders
-		UINT  size = 0;         // size of the image encoder array in bytes
+		for( unsigned int y = 0; y < height; y++ )
+		{
+			for( unsigned int x = 0; x < width; x++ )
+			{
+				pBuffer[Offset( x,y )] = src.GetPixel( x,y );
+			}
+		}
+	}
+}
 
-		Gdiplus::ImageCodecInfo* pImageCodecInfo = nullptr;
+RectI Surface::Blit( int x,int y,const RectI& srcRect,const Surface& src,const RectI& clip,BlendMode mode,Color key )
+{
+	assert( &src != this );
+	// clip the source rectangle to src, moving the destination along with it
+	RectI srcClipped = srcRect;
+	srcClipped.ClipTo( { 0,int( src.height ),0,int( src.width ) } );
+	x += srcClipped.left - srcRect.left;
+	y += srcClipped.top - srcRect.top;
+	// then the destination to clip and to this surface, moving the source along with it
+	RectI dst( y,y + srcClipped.GetHeight(),x,x + srcClipped.GetWidth() );
+	dst.ClipTo( clip );
+	dst.ClipTo( { 0,int( height ),0,int( width ) } );
+	if( dst.GetWidth() <= 0 || dst.GetHeight() <= 0 )
+	{
+		return dst;
+	}
+	const unsigned int srcX = static_cast<unsigned int>( srcClipped.left + dst.left - x );
+	const unsigned int srcY = static_cast<unsigned int>( srcClipped.top + dst.top - y );
+	const unsigned int dstX = static_cast<unsigned int>( dst.left );
+	const unsigned int count = static_cast<unsigned int>( dst.GetWidth() );
 
-		Gdiplus::GetImageEncodersSize( &num,&size );
-		if( size == 0 )
+	src.ResolveClears();
+	ResolveTilesUnder( dst );
+	// both linear: every row is contiguous on both sides, so the whole rectangle is one call
+	if( layout == Layout::Linear && src.layout == Layout::Linear )
+	{
+		BlitRows( &pBuffer[Offset( dstX,unsigned( dst.top ) )],pitch,&src.pBuffer[srcY * src.pitch + srcX],src.pitch,
+			count,unsigned( dst.GetHeight() ),mode,key );
+		return dst;
+	}
+	Color rowChunk[blitChunk];
+	for( unsigned int row = 0u; row < unsigned( dst.GetHeight() ); row++ )
+	{
+		const unsigned int sy = srcY + row;
+		const unsigned int dy = unsigned( dst.top ) + row;
+		for( unsigned int done = 0u; done < count; )
 		{
-			std::wstringstream ss;
-			ss << L"Saving surface to [" << filename << L"]: failed to get encoder; size == 0.";
-			throw Exception( _CRT_WIDE( __FILE__ ),__LINE__,ss.str() );
+			// runs are contiguous in both surfaces: a Tiled destination is split at block edges,
+			// and a Tiled source is linearized a chunk at a time
+			unsigned int n = count - done;
+			if( layout == Layout::Tiled )
+			{
+				n = std::min( n,blockSize - ((dstX + done) & blockMask) );
+			}
+			const Color* pSrc;
+			if( src.layout == Layout::Linear )
+			{
+				pSrc = &src.pBuffer[sy * src.pitch + srcX + done];
+			}
+			else
+			{
+				n = std::min( n,blitChunk );
+				src.ReadSpan( rowChunk,srcX + done,sy,n );
+				pSrc = rowChunk;
+			}
+			BlitRows( &pBuffer[Offset( dstX + done,dy )],0u,pSrc,0u,n,1u,mode,key );
+			done += n;
 		}
+	}
+	return dst;
+}
+
+RectI Surface::FillRect( const RectI& rect,const RectI& clip,Color c )
+{
+	RectI dst = rect;
+	dst.ClipTo( clip );
+	dst.ClipTo( { 0,int( height ),0,int( width ) } );
+	if( dst.GetWidth() <= 0 || dst.GetHeight() <= 0 )
+	{
+		return dst;
+	}
+	ResolveTilesUnder( dst );
+	for( int y = dst.top; y < dst.bottom; y++ )
+	{
+		FillSpan( unsigned( dst.left ),unsigned( y ),unsigned( dst.GetWidth() ),c );
+	}
+	return dst;
+}
 
-		pImageCodecInfo = (Gdiplus::ImageCodecInfo*)(malloc( size ));
-		if( pImageCodecInfo == nullptr )
+void Surface::ResolveTilesUnder( const RectI& rect ) const
+{
+	// deferred clears under the rectangle have to land before it is drawn over
+	if( nPendingTiles == 0u )
+	{
+		return;
+	}
+	for( unsigned int ty = unsigned( rect.top ) >> tileShift; ty <= unsigned( rect.bottom - 1 ) >> tileShift; ty++ )
+	{
+		for( unsigned int tx = unsigned( rect.left ) >> tileShift; tx <= unsigned( rect.right - 1 ) >> tileShift; tx++ )
 		{
-			std::wstringstream ss;
-			ss << L"Saving surface to [" << filename << L"]: failed to get encoder; failed to allocate memory.";
-			throw Exception( _CRT_WIDE( __FILE__ ),__LINE__,ss.str() );
+			ResolveTile( tx,ty );
 		}
+	}
+}
 
-		GetImageEncoders( num,size,pImageCodecInfo );
+void Surface::BlitRows( Color* pDst,unsigned int dstPitch,const Color* pSrc,unsigned int srcPitch,
+	unsigned int count,unsigned int nRows,BlendMode mode,Color key )
+{
+	switch( mode )
+	{
+	case BlendMode::Opaque:
+		for( unsigned int row = 0u; row < nRows; row++ )
+		{
+			memcpy( static_cast<void*>( pDst + size_t( dstPitch ) * row ),pSrc + size_t( srcPitch ) * row,
+				sizeof( Color ) * count );
+		}
+		break;
+	case BlendMode::ColorKey:
+		BlitKeyed( pDst,dstPitch,pSrc,srcPitch,count,nRows,key );
+		break;
+	case BlendMode::Tint:
+		BlitTint( pDst,dstPitch,pSrc,srcPitch,count,nRows,key );
+		break;
+	default:
+		BlitAlpha( pDst,dstPitch,pSrc,srcPitch,count,nRows );
+		break;
+	}
+}
 
-		for( UINT j = 0; j < num; ++j )
+void Surface::BlitKeyed( Color* pDst,unsigned int dstPitch,const Color* pSrc,unsigned int srcPitch,
+	unsigned int count,unsigned int nRows,Color key )
+{
+	const unsigned int rgbMask = 0x00FFFFFFu;
+	const unsigned int keyRgb = key.dword & rgbMask;
+#ifdef __AVX2__
+	const __m256i mask8 = _mm256_set1_epi32( int( rgbMask ) );
+	const __m256i keys8 = _mm256_set1_epi32( int( keyRgb ) );
+	const __m256i ones8 = _mm256_set1_epi32( -1 );
+#endif
+	const __m128i mask = _mm_set1_epi32( int( rgbMask ) );
+	const __m128i keys = _mm_set1_epi32( int( keyRgb ) );
+	for( unsigned int row = 0u; row < nRows; row++,pDst += dstPitch,pSrc += srcPitch )
+	{
+		unsigned int i = 0u;
+#ifdef __AVX2__
+		// only the pixels that aren't the key are stored, so the destination is never read
+		for( ; i + 8u <= count; i += 8u )
+		{
+			const __m256i s = _mm256_loadu_si256( reinterpret_cast<const __m256i*>(pSrc + i) );
+			const __m256i skip = _mm256_cmpeq_epi32( _mm256_and_si256( s,mask8 ),keys8 );
+			_mm256_maskstore_epi32( reinterpret_cast<int*>(pDst + i),_mm256_xor_si256( skip,ones8 ),s );
+		}
+#endif
+		for( ; i + 4u <= count; i += 4u )
 		{
-			if( wcscmp( pImageCodecInfo[j].MimeType,format ) == 0 )
+			const __m128i s = _mm_loadu_si128( reinterpret_cast<const __m128i*>(pSrc + i) );
+			const __m128i d = _mm_loadu_si128( reinterpret_cast<const __m128i*>(pDst + i) );
+			const __m128i skip = _mm_cmpeq_epi32( _mm_and_si128( s,mask ),keys );
+			_mm_storeu_si128( reinterpret_cast<__m128i*>(pDst + i),
+				_mm_or_si128( _mm_and_si128( skip,d ),_mm_andnot_si128( skip,s ) ) );
+		}
+		for( ; i < count; i++ )
+		{
+			if( (pSrc[i].dword & rgbMask) != keyRgb )
 			{
-				*pClsid = pImageCodecInfo[j].Clsid;
-				free( pImageCodecInfo );
-				return;
+				pDst[i] = pSrc[i];
 			}
 		}
+	}
+}
 
-		free( pImageCodecInfo );
-		std::wstringstream ss;
-		ss << L"Saving surface to [" << filename << 
-			L"]: failed to get encoder; failed to find matching encoder.";
-		throw Exception( _CRT_WIDE( __FILE__ ),__LINE__,ss.str() );
+void Surface::BlitAlpha( Color* pDst,unsigned int dstPitch,const Color* pSrc,unsigned int srcPitch,
+	unsigned int count,unsigned int nRows )
+{
+	// channels widened to 16 bits: s * a + d * (255 - a) is at most 255 * 255, so it fits
+	// unsigned and the shift gives exactly PutPixelAlpha's / 256, alpha of the result is 0 like there
+	const unsigned int rgbMask = 0x00FFFFFFu;
+#ifdef __AVX2__
+	const __m256i zero8 = _mm256_setzero_si256();
+	const __m256i full8 = _mm256_set1_epi16( 255 );
+	const __m256i mask8 = _mm256_set1_epi32( int( rgbMask ) );
+	const auto blend8 = [&]( __m256i s,__m256i d )
+	{
+		const __m256i a = _mm256_shufflehi_epi16( _mm256_shufflelo_epi16( s,_MM_SHUFFLE( 3,3,3,3 ) ),_MM_SHUFFLE( 3,3,3,3 ) );
+		return _mm256_srli_epi16( _mm256_add_epi16( _mm256_mullo_epi16( s,a ),
+			_mm256_mullo_epi16( d,_mm256_sub_epi16( full8,a ) ) ),8 );
+	};
+#endif
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i full = _mm_set1_epi16( 255 );
+	const __m128i mask = _mm_set1_epi32( int( rgbMask ) );
+	const auto blend = [&]( __m128i s,__m128i d )
+	{
+		const __m128i a = _mm_shufflehi_epi16( _mm_shufflelo_epi16( s,_MM_SHUFFLE( 3,3,3,3 ) ),_MM_SHUFFLE( 3,3,3,3 ) );
+		return _mm_srli_epi16( _mm_add_epi16( _mm_mullo_epi16( s,a ),
+			_mm_mullo_epi16( d,_mm_sub_epi16( full,a ) ) ),8 );
 	};
+	for( unsigned int row = 0u; row < nRows; row++,pDst += dstPitch,pSrc += srcPitch )
+	{
+		unsigned int i = 0u;
+#ifdef __AVX2__
+		for( ; i + 8u <= count; i += 8u )
+		{
+			const __m256i s = _mm256_loadu_si256( reinterpret_cast<const __m256i*>(pSrc + i) );
+			const __m256i d = _mm256_loadu_si256( reinterpret_cast<const __m256i*>(pDst + i) );
+			// unpack and pack both work within 128 bit lanes, so pixel order comes back intact
+			const __m256i lo = blend8( _mm256_unpacklo_epi8( s,zero8 ),_mm256_unpacklo_epi8( d,zero8 ) );
+			const __m256i hi = blend8( _mm256_unpackhi_epi8( s,zero8 ),_mm256_unpackhi_epi8( d,zero8 ) );
+			_mm256_storeu_si256( reinterpret_cast<__m256i*>(pDst + i),_mm256_and_si256( _mm256_packus_epi16( lo,hi ),mask8 ) );
+		}
+#endif
+		for( ; i + 4u <= count; i += 4u )
+		{
+			const __m128i s = _mm_loadu_si128( reinterpret_cast<const __m128i*>(pSrc + i) );
+			const __m128i d = _mm_loadu_si128( reinterpret_cast<const __m128i*>(pDst + i) );
+			const __m128i lo = blend( _mm_unpacklo_epi8( s,zero ),_mm_unpacklo_epi8( d,zero ) );
+			const __m128i hi = blend( _mm_unpackhi_epi8( s,zero ),_mm_unpackhi_epi8( d,zero ) );
+			_mm_storeu_si128( reinterpret_cast<__m128i*>(pDst + i),_mm_and_si128( _mm_packus_epi16( lo,hi ),mask ) );
+		}
+		for( ; i < count; i++ )
+		{
+			const Color s = pSrc[i];
+			const Color d = pDst[i];
+			const unsigned int a = s.GetA();
+			pDst[i] = Color(
+				static_cast<unsigned char>( (s.GetR() * a + d.GetR() * (255u - a)) / 256u ),
+				static_cast<unsigned char>( (s.GetG() * a + d.GetG() * (255u - a)) / 256u ),
+				static_cast<unsigned char>( (s.GetB() * a + d.GetB() * (255u - a)) / 256u ) );
+		}
+	}
+}
 
-	CLSID bmpID;
-	GetEncoderClsid( L"image/bmp",&bmpID );
-	Gdiplus::Bitmap bitmap( width,height,pitch * sizeof( Color ),PixelFormat32bppARGB,(BYTE*)pBuffer.get() );
-	if( bitmap.Save( filename.c_str(),&bmpID,nullptr ) != Gdiplus::Status::Ok )
+void Surface::BlitTint( Color* pDst,unsigned int dstPitch,const Color* pSrc,unsigned int srcPitch,
+	unsigned int count,unsigned int nRows,Color tint )
+{
+	// t * a + d * (255 - a) + 128 is at most 255 * 255 + 128, and (x + (x >> 8)) >> 8 of that
+	// is the sum / 255 rounded to nearest, exact for every input in that range
+	const unsigned int rgbMask = 0x00FFFFFFu;
+#ifdef __AVX2__
+	const __m256i zero8 = _mm256_setzero_si256();
+	const __m256i full8 = _mm256_set1_epi16( 255 );
+	const __m256i half8 = _mm256_set1_epi16( 128 );
+	const __m256i mask8 = _mm256_set1_epi32( int( rgbMask ) );
+	const __m256i t8 = _mm256_unpacklo_epi8( _mm256_set1_epi32( int( tint.dword ) ),zero8 );
+	const auto blend8 = [&]( __m256i s,__m256i d )
 	{
-		std::wstringstream ss;
-		ss << L"Saving surface to [" << filename << L"]: failed to save.";
-		throw Exception( _CRT_WIDE( __FILE__ ),__LINE__,ss.str() );
+		const __m256i a = _mm256_shufflehi_epi16( _mm256_shufflelo_epi16( s,_MM_SHUFFLE( 3,3,3,3 ) ),_MM_SHUFFLE( 3,3,3,3 ) );
+		const __m256i sum = _mm256_add_epi16( _mm256_add_epi16( _mm256_mullo_epi16( t8,a ),
+			_mm256_mullo_epi16( d,_mm256_sub_epi16( full8,a ) ) ),half8 );
+		return _mm256_srli_epi16( _mm256_add_epi16( sum,_mm256_srli_epi16( sum,8 ) ),8 );
+	};
+#endif
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i full = _mm_set1_epi16( 255 );
+	const __m128i half = _mm_set1_epi16( 128 );
+	const __m128i mask = _mm_set1_epi32( int( rgbMask ) );
+	const __m128i t = _mm_unpacklo_epi8( _mm_set1_epi32( int( tint.dword ) ),zero );
+	const auto blend = [&]( __m128i s,__m128i d )
+	{
+		const __m128i a = _mm_shufflehi_epi16( _mm_shufflelo_epi16( s,_MM_SHUFFLE( 3,3,3,3 ) ),_MM_SHUFFLE( 3,3,3,3 ) );
+		const __m128i sum = _mm_add_epi16( _mm_add_epi16( _mm_mullo_epi16( t,a ),
+			_mm_mullo_epi16( d,_mm_sub_epi16( full,a ) ) ),half );
+		return _mm_srli_epi16( _mm_add_epi16( sum,_mm_srli_epi16( sum,8 ) ),8 );
+	};
+	const auto blendChannel = []( unsigned int t,unsigned int d,unsigned int a )
+	{
+		const unsigned int sum = t * a + d * (255u - a) + 128u;
+		return static_cast<unsigned char>( (sum + (sum >> 8)) >> 8 );
+	};
+	for( unsigned int row = 0u; row < nRows; row++,pDst += dstPitch,pSrc += srcPitch )
+	{
+		unsigned int i = 0u;
+#ifdef __AVX2__
+		for( ; i + 8u <= count; i += 8u )
+		{
+			const __m256i s = _mm256_loadu_si256( reinterpret_cast<const __m256i*>(pSrc + i) );
+			const __m256i d = _mm256_loadu_si256( reinterpret_cast<const __m256i*>(pDst + i) );
+			const __m256i lo = blend8( _mm256_unpacklo_epi8( s,zero8 ),_mm256_unpacklo_epi8( d,zero8 ) );
+			const __m256i hi = blend8( _mm256_unpackhi_epi8( s,zero8 ),_mm256_unpackhi_epi8( d,zero8 ) );
+			_mm256_storeu_si256( reinterpret_cast<__m256i*>(pDst + i),_mm256_and_si256( _mm256_packus_epi16( lo,hi ),mask8 ) );
+		}
+#endif
+		for( ; i + 4u <= count; i += 4u )
+		{
+			const __m128i s = _mm_loadu_si128( reinterpret_cast<const __m128i*>(pSrc + i) );
+			const __m128i d = _mm_loadu_si128( reinterpret_cast<const __m128i*>(pDst + i) );
+			const __m128i lo = blend( _mm_unpacklo_epi8( s,zero ),_mm_unpacklo_epi8( d,zero ) );
+			const __m128i hi = blend( _mm_unpackhi_epi8( s,zero ),_mm_unpackhi_epi8( d,zero ) );
+			_mm_storeu_si128( reinterpret_cast<__m128i*>(pDst + i),_mm_and_si128( _mm_packus_epi16( lo,hi ),mask ) );
+		}
+		for( ; i < count; i++ )
+		{
+			const unsigned int a = pSrc[i].GetA();
+			const Color d = pDst[i];
+			pDst[i] = Color( blendChannel( tint.GetR(),d.GetR(),a ),blendChannel( tint.GetG(),d.GetG(),a ),
+				blendChannel( tint.GetB(),d.GetB(),a ) );
+		}
 	}
 }
 
-void Surface::Copy( const Surface & src )
+void Surface::AlignedDeleter::operator()( Color* p ) const
 {
-	assert( width == src.width );
-	assert( height == src.height );
-	if( pitch == src.pitch )
+	if( !owning )
 	{
-		memcpy( pBuffer.get(),src.pBuffer.get(),pitch * height * sizeof( Color ) );
+		return;
 	}
-	else
+#ifdef _MSC_VER
+	_aligned_free( p );
+#else
+	free( p );
+#endif
+}
+
+Surface::BufferPtr Surface::AllocateBuffer( unsigned int nPixels )
+{
+	// round up to whole alignment blocks (required by aligned_alloc)
+	const size_t nBytes = (size_t( nPixels ) * sizeof( Color ) + bufferAlignment - 1u) /
+		bufferAlignment * bufferAlignment;
+#ifdef _MSC_VER
+	void* const p = _aligned_malloc( nBytes,bufferAlignment );
+#else
+	void* const p = aligned_alloc( bufferAlignment,nBytes );
+#endif
+	if( p == nullptr )
 	{
-		for( unsigned int y = 0; y < height; y++ )
+		if( nBytes != 0u )
 		{
-			memcpy( &pBuffer[pitch * y],&src.pBuffer[pitch * y],sizeof( Color )* width );
+			throw std::bad_alloc();
 		}
 	}
+	else
+	{
+		memset( p,0,nBytes );
+	}
+	return BufferPtr( static_cast<Color*>(p),AlignedDeleter{} );
 }
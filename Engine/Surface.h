@@ -19,17 +19,19 @@
 *	along with The Chili DirectX Framework.  If not, see <http://www.gnu.org/licenses/>.  *
 ******************************************************************************************/
 #pragma once
-#include "ChiliWin.h"
 #include "Colors.h"
 #include "Rect.h"
 #include "ChiliException.h"
 #include <string>
 #include <assert.h>
 #include <memory>
+#include <vector>
 
+class JobSystem;
 
 class Surface
 {
+	friend class SurfacePool;
 public:
 	class Exception : public ChiliException
 	{
@@ -38,14 +40,70 @@ public:
 		virtual std::wstring GetFullMessage() const override { return GetNote() + L"\nAt: " + GetLocation(); }
 		virtual std::wstring GetExceptionType() const override { return L"Surface Exception"; }
 	};
+	// byte alignment that the start of every row is padded to
+	enum class RowAlignment : unsigned int
+	{
+		Pixel = 4u,
+		SIMD = 32u,
+		CacheLine = 64u
+	};
+	// memory arrangement of the pixels
+	enum class Layout
+	{
+		// row-major, rows pitch pixels apart
+		Linear,
+		// 8x8 pixel blocks stored contiguously (row-major inside the block, blocks
+		// row-major across the surface); detiled into linear form by Present
+		Tiled
+	};
+	// how Blit combines source pixels with the destination
+	enum class BlendMode
+	{
+		// source replaces destination
+		Opaque,
+		// as Opaque, but source pixels whose color (alpha ignored) is the key are skipped
+		ColorKey,
+		// source blended over destination by source alpha, as PutPixelAlpha does
+		Alpha,
+		// the tint color blended over destination by source alpha, source color ignored, for
+		// coverage masks like font glyphs; rounded so that alpha 0 leaves the destination color
+		// as it was and alpha 255 gives exactly the tint
+		Tint
+	};
+private:
+	// releases buffers obtained from AllocateBuffer (views leave memory alone)
+	struct AlignedDeleter
+	{
+		void operator()( Color* p ) const;
+		bool owning = true;
+	};
+public:
+	typedef std::unique_ptr<Color[],AlignedDeleter> BufferPtr;
 public:
 	Surface( unsigned int width,unsigned int height,unsigned int pitch )
 		:
-		pBuffer( std::make_unique<Color[]>( pitch * height ) ),
+		pBuffer( AllocateBuffer( pitch * height ) ),
 		width( width ),
 		height( height ),
 		pitch( pitch )
+	{
+		InitTiles();
+	}
+	Surface( unsigned int width,unsigned int height,RowAlignment rowAlignment )
+		:
+		Surface( width,height,GetPitch( width,static_cast<unsigned int>( rowAlignment ) ) )
 	{}
+	Surface( unsigned int width,unsigned int height,Layout layout )
+		:
+		pBuffer( AllocateBuffer( GetPitch( width,blockSize * sizeof( Color ) ) *
+			GetPitch( height,blockSize * sizeof( Color ) ) ) ),
+		width( width ),
+		height( height ),
+		pitch( GetPitch( width,blockSize * sizeof( Color ) ) ),
+		layout( layout )
+	{
+		InitTiles();
+	}
 	Surface( unsigned int width,unsigned int height )
 		:
 		Surface( width,height,width )
@@ -55,39 +113,56 @@ public:
 		pBuffer( std::move( source.pBuffer ) ),
 		width( source.width ),
 		height( source.height ),
-		pitch( source.pitch )
-	{}
+		pitch( source.pitch ),
+		layout( source.layout ),
+		tilesX( source.tilesX ),
+		tilesY( source.tilesY ),
+		pendingTiles( std::move( source.pendingTiles ) ),
+		nPendingTiles( source.nPendingTiles ),
+		clearColor( source.clearColor )
+	{
+		source.nPendingTiles = 0u;
+	}
 	Surface( Surface& ) = delete;
 	Surface& operator=( Surface&& donor )
 	{
 		width = donor.width;
 		height = donor.height;
 		pitch = donor.pitch;
+		layout = donor.layout;
 		pBuffer = std::move( donor.pBuffer );
 		donor.pBuffer = nullptr;
+		tilesX = donor.tilesX;
+		tilesY = donor.tilesY;
+		pendingTiles = std::move( donor.pendingTiles );
+		nPendingTiles = donor.nPendingTiles;
+		donor.nPendingTiles = 0u;
+		clearColor = donor.clearColor;
 		return *this;
 	}
 	Surface& operator=( const Surface& ) = delete;
 	~Surface()
 	{}
-	void Clear( Color fillValue  )
-	{
-		memset( pBuffer.get(),fillValue.dword,pitch * height * sizeof( Color ) );
-	}
-	void Present( unsigned int dstPitch,BYTE* const pDst ) const
-	{
-		for( unsigned int y = 0; y < height; y++ )
-		{
-			memcpy( &pDst[dstPitch * y],&pBuffer[pitch * y],sizeof(Color) * width );
-		}
-	}
+	// fill every pixel with fillValue (full 32-bit fill using streaming stores)
+	void Clear( Color fillValue );
+	// mark all tiles as cleared without touching the buffer; each tile is filled
+	// on its first write, and tiles never written are filled directly into the
+	// destination at Present
+	void FastClear( Color fillValue );
+	// fill any tiles still pending from a FastClear
+	void ResolveClears() const;
+	void Present( unsigned int dstPitch,unsigned char* const pDst ) const;
 	void PutPixel( unsigned int x,unsigned int y,Color c )
 	{
 		assert( x >= 0 );
 		assert( y >= 0 );
 		assert( x < width );
 		assert( y < height );
-		pBuffer[y * pitch + x] = c;
+		if( nPendingTiles != 0u )
+		{
+			ResolveTile( x >> tileShift,y >> tileShift );
+		}
+		pBuffer[Offset( x,y )] = c;
 	}
 	void PutPixelAlpha( unsigned int x,unsigned int y,Color c );
 	Color GetPixel( unsigned int x,unsigned int y ) const
@@ -96,7 +171,11 @@ public:
 		assert( y >= 0 );
 		assert( x < width );
 		assert( y < height );
-		return pBuffer[y * pitch + x];
+		if( nPendingTiles != 0u && TileIsPending( x >> tileShift,y >> tileShift ) )
+		{
+			return clearColor;
+		}
+		return pBuffer[Offset( x,y )];
 	}
 	unsigned int GetWidth() const
 	{
@@ -106,21 +185,53 @@ public:
 	{
 		return height;
 	}
+	// for the Tiled layout this is the padded width, not a row stride
 	unsigned int GetPitch() const
 	{
 		return pitch;
 	}
+	Layout GetLayout() const
+	{
+		return layout;
+	}
+	// raw access; pixel order depends on GetLayout()
 	Color* GetBufferPtr()
 	{
+		ResolveClears();
 		return pBuffer.get();
 	}
 	const Color* GetBufferPtrConst() const
 	{
+		ResolveClears();
 		return pBuffer.get();
 	}
+	// surface drawing into memory owned by someone else (e.g. a mapped texture);
+	// pitch is in pixels, and the memory must outlive the view
+	static Surface MakeView( Color* pPixels,unsigned int width,unsigned int height,unsigned int pitch,
+		Layout layout = Layout::Linear )
+	{
+		return Surface( width,height,pitch,BufferPtr( pPixels,AlignedDeleter{ false } ),layout );
+	}
+	// BMP, TGA, PPM or QOI (see ImageDecoder.h), decoded straight from a memory mapping
 	static Surface FromFile( const std::wstring& name );
+	// loads every file, decoding them in parallel on jobs; throws the first failure in names order
+	// (call from the thread that owns jobs)
+	static std::vector<Surface> FromFiles( const std::vector<std::wstring>& names,JobSystem& jobs );
+	// format picked by extension: .bmp, .tga, .ppm or .qoi (see ImageEncoder.h)
 	void Save( const std::wstring& filename ) const;
 	void Copy( const Surface& src );
+	// draws the srcRect part of src with its top left corner at (x,y), clipped to clip, to this
+	// surface and to src; key is the color skipped by ColorKey and the color drawn by Tint (unused
+	// otherwise), and src must not be this surface
+	// returns the part of this surface drawn to, empty (zero or negative size) if none
+	RectI Blit( int x,int y,const RectI& srcRect,const Surface& src,const RectI& clip,
+		BlendMode mode = BlendMode::Opaque,Color key = Colors::Magenta );
+	// fills the part of rect inside clip and this surface; returns the part filled, like Blit
+	RectI FillRect( const RectI& rect,const RectI& clip,Color c );
+	// FNV-1a of the visible pixels in row order, so equal images hash equal whatever their layout
+	unsigned long long GetHash() const;
+	// zeroed buffer of nPixels whose base is aligned to bufferAlignment bytes
+	static BufferPtr AllocateBuffer( unsigned int nPixels );
 private:
 	// calculate pixel pitch required for given byte aligment (must be multiple of 4 bytes)
 	static unsigned int GetPitch( unsigned int width,unsigned int byteAlignment )
@@ -129,16 +240,92 @@ private:
 		const unsigned int pixelAlignment = byteAlignment / sizeof( Color );
 		return width + ( pixelAlignment - width % pixelAlignment ) % pixelAlignment;
 	}
-	Surface( unsigned int width,unsigned int height,unsigned int pitch,std::unique_ptr<Color[]> pBufferParam )
+	Surface( unsigned int width,unsigned int height,unsigned int pitch,BufferPtr pBufferParam,
+		Layout layout = Layout::Linear )
 		:
+		pBuffer( std::move( pBufferParam ) ),
 		width( width ),
 		height( height ),
-		pBuffer( std::move( pBufferParam ) ),
-		pitch( pitch )
-	{}
+		pitch( pitch ),
+		layout( layout )
+	{
+		InitTiles();
+	}
+	// hands over the buffer, leaving an empty 0x0 surface
+	BufferPtr ReleaseBuffer()
+	{
+		width = 0u;
+		height = 0u;
+		pitch = 0u;
+		InitTiles();
+		nPendingTiles = 0u;
+		return std::move( pBuffer );
+	}
+	void InitTiles()
+	{
+		tilesX = (width + tileSize - 1u) >> tileShift;
+		tilesY = (height + tileSize - 1u) >> tileShift;
+		pendingTiles.assign( (tilesX * tilesY + 63u) / 64u,0u );
+	}
+	// index of pixel (x,y) in pBuffer
+	unsigned int Offset( unsigned int x,unsigned int y ) const
+	{
+		if( layout == Layout::Tiled )
+		{
+			return (y >> blockShift) * (pitch << blockShift) + ((x >> blockShift) << (2u * blockShift)) +
+				((y & blockMask) << blockShift) + (x & blockMask);
+		}
+		return y * pitch + x;
+	}
+	unsigned int GetBufferPixelCount() const
+	{
+		return layout == Layout::Tiled ?
+			pitch * GetPitch( height,blockSize * sizeof( Color ) ) :
+			pitch * height;
+	}
+	// read/fill count pixels of row y starting at column x, whatever the layout
+	void ReadSpan( Color* pDst,unsigned int x,unsigned int y,unsigned int count ) const;
+	void FillSpan( unsigned int x,unsigned int y,unsigned int count,Color c ) const;
+	bool TileIsPending( unsigned int tx,unsigned int ty ) const
+	{
+		const unsigned int i = ty * tilesX + tx;
+		return (pendingTiles[i >> 6u] >> (i & 63u)) & 1u;
+	}
+	void ResolveTile( unsigned int tx,unsigned int ty ) const;
+	// lands deferred clears under rect (which must be non-empty and inside the surface)
+	void ResolveTilesUnder( const RectI& rect ) const;
+	// fill count pixels starting at pDst; streaming stores bypass the cache for
+	// data that will not be read back soon
+	static void Fill( Color* pDst,unsigned int count,Color c,bool streaming );
+	// combine nRows rows of count pixels of pSrc into pDst as Blit does (pitches in pixels)
+	static void BlitRows( Color* pDst,unsigned int dstPitch,const Color* pSrc,unsigned int srcPitch,
+		unsigned int count,unsigned int nRows,BlendMode mode,Color key );
+	static void BlitKeyed( Color* pDst,unsigned int dstPitch,const Color* pSrc,unsigned int srcPitch,
+		unsigned int count,unsigned int nRows,Color key );
+	static void BlitAlpha( Color* pDst,unsigned int dstPitch,const Color* pSrc,unsigned int srcPitch,
+		unsigned int count,unsigned int nRows );
+	static void BlitTint( Color* pDst,unsigned int dstPitch,const Color* pSrc,unsigned int srcPitch,
+		unsigned int count,unsigned int nRows,Color tint );
 private:
-	std::unique_ptr<Color[]> pBuffer;
+	// fast clear tiles are tileSize x tileSize pixels
+	static constexpr unsigned int tileShift = 5u;
+	static constexpr unsigned int tileSize = 1u << tileShift;
+	static constexpr unsigned int bufferAlignment = 64u;
+	// Tiled layout blocks are blockSize x blockSize pixels
+	static constexpr unsigned int blockShift = 3u;
+	static constexpr unsigned int blockSize = 1u << blockShift;
+	static constexpr unsigned int blockMask = blockSize - 1u;
+	// most pixels of a Tiled source Blit linearizes at a time
+	static constexpr unsigned int blitChunk = 64u;
+	BufferPtr pBuffer;
 	unsigned int width;
 	unsigned int height;
 	unsigned int pitch; // pitch is in PIXELS, not bytes!
+	Layout layout = Layout::Linear;
+	unsigned int tilesX = 0u;
+	unsigned int tilesY = 0u;
+	// one bit per tile, set while the tile still holds a deferred clear
+	mutable std::vector<unsigned long long> pendingTiles;
+	mutable unsigned int nPendingTiles = 0u;
+	Color clearColor;
 };
\ No newline at end of file
@@ -0,0 +1,150 @@
+/******************************************************************************************
+*	Chili DirectX Framework Version 16.10.01											  *
+*	SurfacePool.cpp																		  *
+*	Copyright 2016 PlanetChili <http://www.planetchili.net>								  *
+*																						  *
+*	This file is part of The Chili DirectX Framework.									  *
+*																						  *
+*	The Chili DirectX Framework is free software: you can redistribute it and/or modify	  *
+*	it under the terms of the GNU General Public License as published by				  *
+*	the Free Software Foundation, either version 3 of the License, or					  *
+*	(at your option) any later version.													  *
+*																						  *
+*	The Chili DirectX Framework is distributed in the hope that it will be useful,		  *
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of						  *
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the						  *
+*	GNU General Public License for more details.										  *
+*																						  *
+*	You should have received a copy of the GNU General Public License					  *
+*	along with The Chili DirectX Framework.  If not, see <http://www.gnu.org/licenses/>.  *
+******************************************************************************************/
+#include "SurfacePool.h"
+#include <algorithm>
+
+SurfacePool::Lease::Lease( SurfacePool& pool,Surface surface,unsigned int sizeClass )
+	:
+	pPool( &pool ),
+	surface( std::move( surface ) ),
+	sizeClass( sizeClass )
+{}
+
+SurfacePool::Lease::Lease()
+	:
+	pPool( nullptr ),
+	surface( Surface::MakeView( nullptr,0u,0u,0u ) ),
+	sizeClass( 0u )
+{}
+
+SurfacePool::Lease::Lease( Lease&& donor )
+	:
+	pPool( donor.pPool ),
+	surface( std::move( donor.surface ) ),
+	sizeClass( donor.sizeClass )
+{
+	donor.pPool = nullptr;
+}
+
+SurfacePool::Lease& SurfacePool::Lease::operator=( Lease&& donor )
+{
+	if( this != &donor )
+	{
+		Return();
+		pPool = donor.pPool;
+		surface = std::move( donor.surface );
+		sizeClass = donor.sizeClass;
+		donor.pPool = nullptr;
+	}
+	return *this;
+}
+
+SurfacePool::Lease::~Lease()
+{
+	Return();
+}
+
+void SurfacePool::Lease::Return()
+{
+	if( pPool )
+	{
+		pPool->Release( surface.ReleaseBuffer(),sizeClass );
+		pPool = nullptr;
+	}
+}
+
+SurfacePool::Lease SurfacePool::Acquire( unsigned int width,unsigned int height,Surface::Layout layout )
+{
+	const unsigned int blockBytes = Surface::blockSize * sizeof( Color );
+	const unsigned int pitch = layout == Surface::Layout::Tiled ?
+		Surface::GetPitch( width,blockBytes ) :
+		Surface::GetPitch( width,static_cast<unsigned int>( Surface::RowAlignment::CacheLine ) );
+	const size_t nPixels = layout == Surface::Layout::Tiled ?
+		size_t( pitch ) * Surface::GetPitch( height,blockBytes ) :
+		size_t( pitch ) * height;
+	const unsigned int sizeClass = GetSizeClass( nPixels );
+	const size_t classBytes = GetClassPixels( sizeClass ) * sizeof( Color );
+
+	Surface::BufferPtr pBuffer( nullptr,Surface::AlignedDeleter{} );
+	{
+		std::lock_guard<std::mutex> lock( mtx );
+		stats.acquired++;
+		stats.bytesLeased += classBytes;
+		stats.peakBytesLeased = std::max( stats.peakBytesLeased,stats.bytesLeased );
+		if( sizeClass < freeBuffers.size() && !freeBuffers[sizeClass].empty() )
+		{
+			pBuffer = std::move( freeBuffers[sizeClass].back() );
+			freeBuffers[sizeClass].pop_back();
+			stats.bytesPooled -= classBytes;
+		}
+		else
+		{
+			stats.heapAllocations++;
+		}
+	}
+	if( !pBuffer )
+	{
+		pBuffer = Surface::AllocateBuffer( static_cast<unsigned int>( GetClassPixels( sizeClass ) ) );
+	}
+	return Lease( *this,Surface( width,height,pitch,std::move( pBuffer ),layout ),sizeClass );
+}
+
+void SurfacePool::Trim()
+{
+	std::lock_guard<std::mutex> lock( mtx );
+	freeBuffers.clear();
+	stats.bytesPooled = 0u;
+}
+
+SurfacePool::Stats SurfacePool::GetStats() const
+{
+	std::lock_guard<std::mutex> lock( mtx );
+	return stats;
+}
+
+void SurfacePool::Release( Surface::BufferPtr pBuffer,unsigned int sizeClass )
+{
+	const size_t classBytes = GetClassPixels( sizeClass ) * sizeof( Color );
+	std::lock_guard<std::mutex> lock( mtx );
+	if( sizeClass >= freeBuffers.size() )
+	{
+		freeBuffers.resize( sizeClass + 1u );
+	}
+	freeBuffers[sizeClass].push_back( std::move( pBuffer ) );
+	stats.bytesLeased -= classBytes;
+	stats.bytesPooled += classBytes;
+}
+
+unsigned int SurfacePool::GetSizeClass( size_t nPixels )
+{
+	unsigned int sizeClass = 0u;
+	while( GetClassPixels( sizeClass ) < nPixels )
+	{
+		sizeClass++;
+	}
+	return sizeClass;
+}
+
+size_t SurfacePool::GetClassPixels( unsigned int sizeClass )
+{
+	// minClassPixels * 2^(sizeClass / 4) * (1, 1.25, 1.5 or 1.75)
+	return (minClassPixels << (sizeClass / 4u)) / 4u * (4u + sizeClass % 4u);
+}
@@ -0,0 +1,97 @@
+/******************************************************************************************
+*	Chili DirectX Framework Version 16.10.01											  *
+*	SurfacePool.h																		  *
+*	Copyright 2016 PlanetChili <http://www.planetchili.net>								  *
+*																						  *
+*	This file is part of The Chili DirectX Framework.									  *
+*																						  *
+*	The Chili DirectX Framework is free software: you can redistribute it and/or modify	  *
+*	it under the terms of the GNU General Public License as published by				  *
+*	the Free Software Foundation, either version 3 of the License, or					  *
+*	(at your option) any later version.													  *
+*																						  *
+*	The Chili DirectX Framework is distributed in the hope that it will be useful,		  *
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of						  *
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the						  *
+*	GNU General Public License for more details.										  *
+*																						  *
+*	You should have received a copy of the GNU General Public License					  *
+*	along with The Chili DirectX Framework.  If not, see <http://www.gnu.org/licenses/>.  *
+******************************************************************************************/
+#pragma once
+
+#include "Surface.h"
+#include <vector>
+#include <mutex>
+
+// recycles surface buffers for transient render targets (depth, post process, mip levels...)
+// so that making one every frame doesn't go to the heap
+// buffers are kept by size class, four per power of two of pixels, so a buffer serves any
+// surface within 25% of its size; the pool must outlive every lease taken from it
+class SurfacePool
+{
+public:
+	// a surface on loan from the pool; its buffer goes back to the pool when this is destroyed
+	class Lease
+	{
+		friend class SurfacePool;
+	public:
+		// holds nothing until assigned one from Acquire
+		Lease();
+		Lease( Lease&& donor );
+		Lease& operator=( Lease&& donor );
+		Lease( const Lease& ) = delete;
+		Lease& operator=( const Lease& ) = delete;
+		~Lease();
+		explicit operator bool() const
+		{
+			return pPool != nullptr;
+		}
+		Surface& operator*()
+		{
+			return surface;
+		}
+		Surface* operator->()
+		{
+			return &surface;
+		}
+	private:
+		Lease( SurfacePool& pool,Surface surface,unsigned int sizeClass );
+		void Return();
+	private:
+		SurfacePool* pPool;
+		Surface surface;
+		unsigned int sizeClass;
+	};
+	struct Stats
+	{
+		unsigned long long acquired = 0u;
+		// acquisitions no pooled buffer could serve
+		unsigned long long heapAllocations = 0u;
+		size_t bytesLeased = 0u;
+		// most bytes on loan at once; what the pool needs to hold to never allocate
+		size_t peakBytesLeased = 0u;
+		size_t bytesPooled = 0u;
+	};
+public:
+	SurfacePool() = default;
+	SurfacePool( const SurfacePool& ) = delete;
+	SurfacePool& operator=( const SurfacePool& ) = delete;
+	// contents are whatever the buffer's last user left there: Clear or FastClear before reading
+	// Linear surfaces get cache line aligned rows
+	Lease Acquire( unsigned int width,unsigned int height,Surface::Layout layout = Surface::Layout::Linear );
+	// frees every buffer not on loan
+	void Trim();
+	Stats GetStats() const;
+private:
+	void Release( Surface::BufferPtr pBuffer,unsigned int sizeClass );
+	static unsigned int GetSizeClass( size_t nPixels );
+	static size_t GetClassPixels( unsigned int sizeClass );
+private:
+	// smallest class; anything below is rounded up to it
+	static constexpr size_t minClassPixels = 4096u;
+	// free buffers, indexed by size class
+	std::vector<std::vector<Surface::BufferPtr>> freeBuffers;
+	Stats stats;
+	mutable std::mutex mtx;
+};
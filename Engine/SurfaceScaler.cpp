@@ -0,0 +1,203 @@
+/******************************************************************************************
+*	Chili DirectX Framework Version 16.10.01											  *
+*	SurfaceScaler.cpp																	  *
+*	Copyright 2016 PlanetChili <http://www.planetchili.net>								  *
+*																						  *
+*	This file is part of The Chili DirectX Framework.									  *
+*																						  *
+*	The Chili DirectX Framework is free software: you can redistribute it and/or modify	  *
+*	it under the terms of the GNU General Public License as published by				  *
+*	the Free Software Foundation, either version 3 of the License, or					  *
+*	(at your option) any later version.													  *
+*																						  *
+*	The Chili DirectX Framework is distributed in the hope that it will be useful,		  *
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of						  *
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the						  *
+*	GNU General Public License for more details.										  *
+*																						  *
+*	You should have received a copy of the GNU General Public License					  *
+*	along with The Chili DirectX Framework.  If not, see <http://www.gnu.org/licenses/>.  *
+******************************************************************************************/
+#include "SurfaceScaler.h"
+#include "JobSystem.h"
+#include "Profiler.h"
+#include <algorithm>
+#include <cstring>
+#include <emmintrin.h>
+
+void SurfaceScaler::Scale( const Surface& src,Surface& dst,Filter filter,JobSystem* pJobs )
+{
+	CHILI_PROFILE_ZONE( "SurfaceScaler::Scale" );
+	assert( src.GetLayout() == Surface::Layout::Linear );
+	assert( dst.GetLayout() == Surface::Layout::Linear );
+	if( src.GetWidth() == 0u || src.GetHeight() == 0u )
+	{
+		return;
+	}
+	Prepare( src.GetWidth(),src.GetHeight(),dst.GetWidth(),dst.GetHeight(),filter );
+	// pending clears are resolved here, on the owning thread, not in the workers
+	const Color* const pSrc = src.GetBufferPtrConst();
+	const unsigned int srcPitch = src.GetPitch();
+	Color* const pDst = dst.GetBufferPtr();
+	const unsigned int dstPitch = dst.GetPitch();
+	const auto scaleRow = [&]( size_t y )
+	{
+		Color* const pRow = pDst + size_t( dstPitch ) * y;
+		if( filter == Filter::Nearest )
+		{
+			ScaleRowNearest( pSrc,srcPitch,pRow,static_cast<unsigned int>( y ) );
+		}
+		else
+		{
+			ScaleRowBilinear( pSrc,srcPitch,pRow,static_cast<unsigned int>( y ) );
+		}
+	};
+	if( pJobs )
+	{
+		pJobs->ParallelFor( 0u,dstHeight,scaleRow,rowGrain );
+	}
+	else
+	{
+		for( size_t y = 0u; y < dstHeight; y++ )
+		{
+			scaleRow( y );
+		}
+	}
+}
+
+void SurfaceScaler::MakeTaps( std::vector<Tap>& taps,unsigned int srcSize,unsigned int dstSize,Filter filter )
+{
+	taps.resize( dstSize );
+	for( unsigned int i = 0u; i < dstSize; i++ )
+	{
+		Tap& tap = taps[i];
+		if( filter == Filter::Nearest )
+		{
+			// source pixel under the destination pixel's center
+			const unsigned long long pos = (2ull * i + 1u) * srcSize / (2ull * dstSize);
+			tap = { static_cast<unsigned int>( std::min( pos,srcSize - 1ull ) ),0u };
+			continue;
+		}
+		// destination pixel center in source pixels, 16.16 fixed point, relative to source centers
+		const long long pos = static_cast<long long>( ((2ull * i + 1u) * srcSize << 16) / (2ull * dstSize) ) - 0x8000;
+		if( pos <= 0 )
+		{
+			tap = { 0u,0u };
+			continue;
+		}
+		tap.first = static_cast<unsigned int>( pos >> 16 );
+		tap.weight = static_cast<unsigned int>( ((pos & 0xFFFF) + 0x80) >> 8 );
+		if( tap.weight == 256u )
+		{
+			tap.first++;
+			tap.weight = 0u;
+		}
+		// past the last center only the last pixel contributes
+		if( tap.first >= srcSize - 1u )
+		{
+			tap = { srcSize - 1u,0u };
+		}
+	}
+}
+
+void SurfaceScaler::Prepare( unsigned int srcWidthIn,unsigned int srcHeightIn,unsigned int dstWidthIn,unsigned int dstHeightIn,Filter filterIn )
+{
+	if( srcWidthIn == srcWidth && srcHeightIn == srcHeight && dstWidthIn == dstWidth &&
+		dstHeightIn == dstHeight && filterIn == filter )
+	{
+		return;
+	}
+	srcWidth = srcWidthIn;
+	srcHeight = srcHeightIn;
+	dstWidth = dstWidthIn;
+	dstHeight = dstHeightIn;
+	filter = filterIn;
+	MakeTaps( columns,srcWidth,dstWidth,filter );
+	MakeTaps( rows,srcHeight,dstHeight,filter );
+	columnWeights.resize( 8u * size_t( dstWidth ) );
+	for( unsigned int x = 0u; x < dstWidth; x++ )
+	{
+		std::fill_n( &columnWeights[8u * x],4u,static_cast<unsigned short>( 256u - columns[x].weight ) );
+		std::fill_n( &columnWeights[8u * x + 4u],4u,static_cast<unsigned short>( columns[x].weight ) );
+	}
+}
+
+void SurfaceScaler::ScaleRowNearest( const Color* pSrc,unsigned int srcPitch,Color* pDst,unsigned int y ) const
+{
+	const Color* const pSrcRow = pSrc + size_t( srcPitch ) * rows[y].first;
+	for( unsigned int x = 0u; x < dstWidth; x++ )
+	{
+		pDst[x] = pSrcRow[columns[x].first];
+	}
+}
+
+void SurfaceScaler::ScaleRowBilinear( const Color* pSrc,unsigned int srcPitch,Color* pDst,unsigned int y ) const
+{
+	// a * (256 - w) + b * w is at most 255 * 256, so every channel fits 16 bits unsigned
+	const auto lerp = []( Color a,Color b,unsigned int w )
+	{
+		unsigned int result = 0u;
+		for( unsigned int shift = 0u; shift < 32u; shift += 8u )
+		{
+			const unsigned int ca = (a.dword >> shift) & 0xFFu;
+			const unsigned int cb = (b.dword >> shift) & 0xFFu;
+			result |= ((ca * (256u - w) + cb * w) >> 8) << shift;
+		}
+		return Color( result );
+	};
+	const __m128i zero = _mm_setzero_si128();
+
+	// blend the two source rows into one, padded with a copy of its last pixel so the
+	// right tap of the last column can always be loaded
+	thread_local std::vector<Color> blended;
+	blended.resize( srcWidth + 1u );
+	const Tap& tap = rows[y];
+	const Color* const pTop = pSrc + size_t( srcPitch ) * tap.first;
+	if( tap.weight == 0u )
+	{
+		memcpy( static_cast<void*>( blended.data() ),pTop,sizeof( Color ) * srcWidth );
+	}
+	else
+	{
+		const Color* const pBottom = pTop + srcPitch;
+		const __m128i wTop = _mm_set1_epi16( static_cast<short>( 256u - tap.weight ) );
+		const __m128i wBottom = _mm_set1_epi16( static_cast<short>( tap.weight ) );
+		unsigned int x = 0u;
+		for( ; x + 4u <= srcWidth; x += 4u )
+		{
+			const __m128i a = _mm_loadu_si128( reinterpret_cast<const __m128i*>(pTop + x) );
+			const __m128i b = _mm_loadu_si128( reinterpret_cast<const __m128i*>(pBottom + x) );
+			const __m128i lo = _mm_srli_epi16( _mm_add_epi16(
+				_mm_mullo_epi16( _mm_unpacklo_epi8( a,zero ),wTop ),
+				_mm_mullo_epi16( _mm_unpacklo_epi8( b,zero ),wBottom ) ),8 );
+			const __m128i hi = _mm_srli_epi16( _mm_add_epi16(
+				_mm_mullo_epi16( _mm_unpackhi_epi8( a,zero ),wTop ),
+				_mm_mullo_epi16( _mm_unpackhi_epi8( b,zero ),wBottom ) ),8 );
+			_mm_storeu_si128( reinterpret_cast<__m128i*>(blended.data() + x),_mm_packus_epi16( lo,hi ) );
+		}
+		for( ; x < srcWidth; x++ )
+		{
+			blended[x] = lerp( pTop[x],pBottom[x],tap.weight );
+		}
+	}
+	blended[srcWidth] = blended[srcWidth - 1u];
+
+	// then across: each column's pair of taps is one 8 byte load, multiplied by its
+	// precomputed weights, and the two halves summed
+	const Color* const pRow = blended.data();
+	unsigned int x = 0u;
+	for( ; x + 2u <= dstWidth; x += 2u )
+	{
+		const __m128i a = _mm_unpacklo_epi8( _mm_loadl_epi64( reinterpret_cast<const __m128i*>(pRow + columns[x].first) ),zero );
+		const __m128i b = _mm_unpacklo_epi8( _mm_loadl_epi64( reinterpret_cast<const __m128i*>(pRow + columns[x + 1u].first) ),zero );
+		const __m128i pa = _mm_mullo_epi16( a,_mm_loadu_si128( reinterpret_cast<const __m128i*>(&columnWeights[8u * x]) ) );
+		const __m128i pb = _mm_mullo_epi16( b,_mm_loadu_si128( reinterpret_cast<const __m128i*>(&columnWeights[8u * x + 8u]) ) );
+		const __m128i sum = _mm_srli_epi16( _mm_add_epi16( _mm_unpacklo_epi64( pa,pb ),_mm_unpackhi_epi64( pa,pb ) ),8 );
+		_mm_storel_epi64( reinterpret_cast<__m128i*>(pDst + x),_mm_packus_epi16( sum,sum ) );
+	}
+	for( ; x < dstWidth; x++ )
+	{
+		const unsigned int first = columns[x].first;
+		pDst[x] = lerp( pRow[first],pRow[first + 1u],columns[x].weight );
+	}
+}
@@ -0,0 +1,70 @@
+/******************************************************************************************
+*	Chili DirectX Framework Version 16.10.01											  *
+*	SurfaceScaler.h																		  *
+*	Copyright 2016 PlanetChili <http://www.planetchili.net>								  *
+*																						  *
+*	This file is part of The Chili DirectX Framework.									  *
+*																						  *
+*	The Chili DirectX Framework is free software: you can redistribute it and/or modify	  *
+*	it under the terms of the GNU General Public License as published by				  *
+*	the Free Software Foundation, either version 3 of the License, or					  *
+*	(at your option) any later version.													  *
+*																						  *
+*	The Chili DirectX Framework is distributed in the hope that it will be useful,		  *
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of						  *
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the						  *
+*	GNU General Public License for more details.										  *
+*																						  *
+*	You should have received a copy of the GNU General Public License					  *
+*	along with The Chili DirectX Framework.  If not, see <http://www.gnu.org/licenses/>.  *
+******************************************************************************************/
+#pragma once
+
+#include "Surface.h"
+#include <vector>
+
+class JobSystem;
+
+// stretches all of one Linear surface over all of another, e.g. to upscale a frame rendered
+// at a lower internal resolution
+// the source position and filter weights of every destination column and row are worked out
+// once per pair of sizes and kept, so scaling every frame only filters
+class SurfaceScaler
+{
+public:
+	enum class Filter
+	{
+		Nearest,
+		// 2x2 taps with 8 bit weights, pixel centers aligned and edges clamped
+		Bilinear
+	};
+public:
+	// rows of dst are filtered in bands on pJobs (call from the thread that owns it), or all on
+	// the calling thread when pJobs is null
+	void Scale( const Surface& src,Surface& dst,Filter filter,JobSystem* pJobs );
+private:
+	// one tap pair along an axis: positions first and first + 1, the latter weighted weight / 256
+	struct Tap
+	{
+		unsigned int first;
+		unsigned int weight;
+	};
+	static void MakeTaps( std::vector<Tap>& taps,unsigned int srcSize,unsigned int dstSize,Filter filter );
+	void Prepare( unsigned int srcWidth,unsigned int srcHeight,unsigned int dstWidth,unsigned int dstHeight,Filter filter );
+	// destination row y from the source pixels (pitch in pixels)
+	void ScaleRowNearest( const Color* pSrc,unsigned int srcPitch,Color* pDst,unsigned int y ) const;
+	void ScaleRowBilinear( const Color* pSrc,unsigned int srcPitch,Color* pDst,unsigned int y ) const;
+private:
+	// fewest destination rows worth handing to a worker
+	static constexpr size_t rowGrain = 16u;
+	unsigned int srcWidth = 0u;
+	unsigned int srcHeight = 0u;
+	unsigned int dstWidth = 0u;
+	unsigned int dstHeight = 0u;
+	Filter filter = Filter::Nearest;
+	std::vector<Tap> columns;
+	std::vector<Tap> rows;
+	// per destination column, 16 bit weights of the left and right taps (4 channels each),
+	// ready to multiply unpacked pixel pairs with
+	std::vector<unsigned short> columnWeights;
+};
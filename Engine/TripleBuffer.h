@@ -0,0 +1,64 @@
+/******************************************************************************************
+*	Chili DirectX Framework Version 16.10.01											  *
+*	TripleBuffer.h																		  *
+*	Copyright 2016 PlanetChili <http://www.planetchili.net>								  *
+*																						  *
+*	This file is part of The Chili DirectX Framework.									  *
+*																						  *
+*	The Chili DirectX Framework is free software: you can redistribute it and/or modify	  *
+*	it under the terms of the GNU General Public License as published by				  *
+*	the Free Software Foundation, either version 3 of the License, or					  *
+*	(at your option) any later version.													  *
+*																						  *
+*	The Chili DirectX Framework is distributed in the hope that it will be useful,		  *
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of						  *
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the						  *
+*	GNU General Public License for more details.										  *
+*																						  *
+*	You should have received a copy of the GNU General Public License					  *
+*	along with The Chili DirectX Framework.  If not, see <http://www.gnu.org/licenses/>.  *
+******************************************************************************************/
+#pragma once
+
+#include <atomic>
+
+// lock-free handoff of whole values from one producer thread to one consumer thread
+// the producer fills the write buffer and publishes it; the consumer always sees the
+// most recently published value and never blocks or waits on the producer
+template<typename T>
+class TripleBuffer
+{
+public:
+	TripleBuffer() = default;
+	TripleBuffer( const TripleBuffer& ) = delete;
+	TripleBuffer& operator=( const TripleBuffer& ) = delete;
+	// producer: buffer to fill before the next Publish (contents are stale, overwrite fully)
+	T& GetWriteBuffer()
+	{
+		return buffers[back];
+	}
+	// producer: make the write buffer visible to the consumer
+	void Publish()
+	{
+		back = middle.exchange( back | freshBit,std::memory_order_acq_rel ) & indexMask;
+	}
+	// consumer: latest published value; stays valid and unchanged until the next Read
+	const T& Read()
+	{
+		if( middle.load( std::memory_order_relaxed ) & freshBit )
+		{
+			front = middle.exchange( front,std::memory_order_acq_rel ) & indexMask;
+		}
+		return buffers[front];
+	}
+private:
+	static constexpr unsigned int freshBit = 4u;
+	static constexpr unsigned int indexMask = 3u;
+	T buffers[3];
+	// index of the buffer in transit, with freshBit set while it is unread
+	alignas( 64 ) std::atomic<unsigned int> middle{ 1u };
+	// producer owned
+	alignas( 64 ) unsigned int back = 0u;
+	// consumer owned
+	alignas( 64 ) unsigned int front = 2u;
+};
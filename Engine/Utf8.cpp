@@ -0,0 +1,61 @@
+/******************************************************************************************
+*	Chili DirectX Framework Version 16.10.01											  *
+*	Utf8.cpp																			  *
+*	Copyright 2016 PlanetChili <http://www.planetchili.net>								  *
+*																						  *
+*	This file is part of The Chili DirectX Framework.									  *
+*																						  *
+*	The Chili DirectX Framework is free software: you can redistribute it and/or modify	  *
+*	it under the terms of the GNU General Public License as published by				  *
+*	the Free Software Foundation, either version 3 of the License, or					  *
+*	(at your option) any later version.													  *
+*																						  *
+*	The Chili DirectX Framework is distributed in the hope that it will be useful,		  *
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of						  *
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the						  *
+*	GNU General Public License for more details.										  *
+*																						  *
+*	You should have received a copy of the GNU General Public License					  *
+*	along with The Chili DirectX Framework.  If not, see <http://www.gnu.org/licenses/>.  *
+******************************************************************************************/
+#include "Utf8.h"
+
+std::string ToUtf8( const std::wstring& str )
+{
+	std::string out;
+	out.reserve( str.size() );
+	for( size_t i = 0u; i < str.size(); i++ )
+	{
+		unsigned long c = static_cast<unsigned long>( str[i] );
+		// 16 bit wchar_t (Windows) holds characters past the BMP as surrogate pairs
+		if( c >= 0xD800u && c < 0xDC00u && i + 1u < str.size() &&
+			str[i + 1u] >= 0xDC00 && str[i + 1u] < 0xE000 )
+		{
+			c = 0x10000u + ((c - 0xD800u) << 10) + (static_cast<unsigned long>( str[i + 1u] ) - 0xDC00u);
+			i++;
+		}
+		if( c < 0x80u )
+		{
+			out += static_cast<char>( c );
+		}
+		else if( c < 0x800u )
+		{
+			out += static_cast<char>( 0xC0u | (c >> 6) );
+			out += static_cast<char>( 0x80u | (c & 0x3Fu) );
+		}
+		else if( c < 0x10000u )
+		{
+			out += static_cast<char>( 0xE0u | (c >> 12) );
+			out += static_cast<char>( 0x80u | ((c >> 6) & 0x3Fu) );
+			out += static_cast<char>( 0x80u | (c & 0x3Fu) );
+		}
+		else
+		{
+			out += static_cast<char>( 0xF0u | (c >> 18) );
+			out += static_cast<char>( 0x80u | ((c >> 12) & 0x3Fu) );
+			out += static_cast<char>( 0x80u | ((c >> 6) & 0x3Fu) );
+			out += static_cast<char>( 0x80u | (c & 0x3Fu) );
+		}
+	}
+	return out;
+}
@@ -0,0 +1,292 @@
+/******************************************************************************************
+*	Chili DirectX Framework Version 16.10.01											  *
+*	VideoCapture.cpp																	  *
+*	Copyright 2016 PlanetChili <http://www.planetchili.net>								  *
+*																						  *
+*	This file is part of The Chili DirectX Framework.									  *
+*																						  *
+*	The Chili DirectX Framework is free software: you can redistribute it and/or modify	  *
+*	it under the terms of the GNU General Public License as published by				  *
+*	the Free Software Foundation, either version 3 of the License, or					  *
+*	(at your option) any later version.													  *
+*																						  *
+*	The Chili DirectX Framework is distributed in the hope that it will be useful,		  *
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of						  *
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the						  *
+*	GNU General Public License for more details.										  *
+*																						  *
+*	You should have received a copy of the GNU General Public License					  *
+*	along with The Chili DirectX Framework.  If not, see <http://www.gnu.org/licenses/>.  *
+******************************************************************************************/
+#include "VideoCapture.h"
+#include "Profiler.h"
+#include <chrono>
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+#include <cstring>
+#include <emmintrin.h>
+
+namespace
+{
+	// 8 MiB between system calls; a 640x640 frame is 600 KiB of YUV
+	constexpr size_t writeBufferSize = 8u << 20;
+
+	// BT.601 full range (as in JPEG) in 8.8 fixed point:
+	//   Y = (77R + 150G + 29B + 128) >> 8
+	//   U = ((-43R - 85G + 128B + 128) >> 8) + 128
+	//   V = ((128R - 107G - 21B + 128) >> 8) + 128
+	unsigned char Luma( Color c )
+	{
+		return static_cast<unsigned char>( (77 * c.GetR() + 150 * c.GetG() + 29 * c.GetB() + 128) >> 8 );
+	}
+	unsigned char Chroma( int value )
+	{
+		return static_cast<unsigned char>( std::min( std::max( (value >> 8) + 128,0 ),255 ) );
+	}
+
+	// B,G,R of 8 pixels as 16 bit lanes
+	void Unpack( const Color* pSrc,__m128i& r,__m128i& g,__m128i& b )
+	{
+		const __m128i mask = _mm_set1_epi32( 0xFF );
+		const __m128i p0 = _mm_loadu_si128( reinterpret_cast<const __m128i*>(pSrc) );
+		const __m128i p1 = _mm_loadu_si128( reinterpret_cast<const __m128i*>(pSrc) + 1 );
+		b = _mm_packs_epi32( _mm_and_si128( p0,mask ),_mm_and_si128( p1,mask ) );
+		g = _mm_packs_epi32( _mm_and_si128( _mm_srli_epi32( p0,8 ),mask ),_mm_and_si128( _mm_srli_epi32( p1,8 ),mask ) );
+		r = _mm_packs_epi32( _mm_and_si128( _mm_srli_epi32( p0,16 ),mask ),_mm_and_si128( _mm_srli_epi32( p1,16 ),mask ) );
+	}
+
+	// 8 luma bytes in the low half; the sum fits 16 bits unsigned, so the shift must be logical
+	__m128i LumaX8( __m128i r,__m128i g,__m128i b )
+	{
+		const __m128i sum = _mm_add_epi16(
+			_mm_add_epi16( _mm_mullo_epi16( r,_mm_set1_epi16( 77 ) ),_mm_mullo_epi16( g,_mm_set1_epi16( 150 ) ) ),
+			_mm_add_epi16( _mm_mullo_epi16( b,_mm_set1_epi16( 29 ) ),_mm_set1_epi16( 128 ) ) );
+		const __m128i y = _mm_srli_epi16( sum,8 );
+		return _mm_packus_epi16( y,y );
+	}
+
+	// luma of rows 0 and 1 (the same row when height is odd) and the chroma row between them
+	void ConvertRowPair( const Color* pRow0,const Color* pRow1,unsigned int width,
+		unsigned char* pY0,unsigned char* pY1,unsigned char* pU,unsigned char* pV )
+	{
+		unsigned int x = 0u;
+		const __m128i ones = _mm_set1_epi16( 1 );
+		const __m128i two = _mm_set1_epi32( 2 );
+		const __m128i bias = _mm_set1_epi32( 128 );
+		// coefficients paired up for madd: (R,G) and (B,1)
+		const __m128i uRG = _mm_setr_epi16( -43,-85,-43,-85,-43,-85,-43,-85 );
+		const __m128i uB1 = _mm_setr_epi16( 128,128,128,128,128,128,128,128 );
+		const __m128i vRG = _mm_setr_epi16( 128,-107,128,-107,128,-107,128,-107 );
+		const __m128i vB1 = _mm_setr_epi16( -21,128,-21,128,-21,128,-21,128 );
+		// 8 columns per step: 16 luma, 4 of each chroma
+		for( ; x + 8u <= width; x += 8u )
+		{
+			__m128i r0,g0,b0,r1,g1,b1;
+			Unpack( pRow0 + x,r0,g0,b0 );
+			Unpack( pRow1 + x,r1,g1,b1 );
+			_mm_storel_epi64( reinterpret_cast<__m128i*>(pY0 + x),LumaX8( r0,g0,b0 ) );
+			_mm_storel_epi64( reinterpret_cast<__m128i*>(pY1 + x),LumaX8( r1,g1,b1 ) );
+			// average each 2x2 block: add the rows, then horizontal pairs (madd by 1), rounding
+			const __m128i r = _mm_srai_epi32( _mm_add_epi32( _mm_madd_epi16( _mm_add_epi16( r0,r1 ),ones ),two ),2 );
+			const __m128i g = _mm_srai_epi32( _mm_add_epi32( _mm_madd_epi16( _mm_add_epi16( g0,g1 ),ones ),two ),2 );
+			const __m128i b = _mm_srai_epi32( _mm_add_epi32( _mm_madd_epi16( _mm_add_epi16( b0,b1 ),ones ),two ),2 );
+			const __m128i rg = _mm_unpacklo_epi16( _mm_packs_epi32( r,r ),_mm_packs_epi32( g,g ) );
+			const __m128i b1s = _mm_unpacklo_epi16( _mm_packs_epi32( b,b ),ones );
+			const __m128i u = _mm_add_epi32( _mm_srai_epi32( _mm_add_epi32( _mm_madd_epi16( rg,uRG ),_mm_madd_epi16( b1s,uB1 ) ),8 ),bias );
+			const __m128i v = _mm_add_epi32( _mm_srai_epi32( _mm_add_epi32( _mm_madd_epi16( rg,vRG ),_mm_madd_epi16( b1s,vB1 ) ),8 ),bias );
+			// saturating packs clamp to [0,255] like Chroma does
+			const __m128i uv16 = _mm_packs_epi32( u,v );
+			const __m128i uv8 = _mm_packus_epi16( uv16,uv16 );
+			const int uBytes = _mm_cvtsi128_si32( uv8 );
+			const int vBytes = _mm_cvtsi128_si32( _mm_srli_si128( uv8,4 ) );
+			memcpy( pU + x / 2u,&uBytes,sizeof( uBytes ) );
+			memcpy( pV + x / 2u,&vBytes,sizeof( vBytes ) );
+		}
+		// leftover columns, including a lone last one when width is odd
+		for( ; x < width; x += 2u )
+		{
+			const unsigned int n = x + 1u < width ? 2u : 1u;
+			int r = 0;
+			int g = 0;
+			int b = 0;
+			for( unsigned int i = 0u; i < n; i++ )
+			{
+				const Color c0 = pRow0[x + i];
+				const Color c1 = pRow1[x + i];
+				pY0[x + i] = Luma( c0 );
+				pY1[x + i] = Luma( c1 );
+				r += c0.GetR() + c1.GetR();
+				g += c0.GetG() + c1.GetG();
+				b += c0.GetB() + c1.GetB();
+			}
+			// same rounding as the vector path for full blocks
+			r = (r + int( n )) / int( 2u * n );
+			g = (g + int( n )) / int( 2u * n );
+			b = (b + int( n )) / int( 2u * n );
+			pU[x / 2u] = Chroma( -43 * r - 85 * g + 128 * b + 128 );
+			pV[x / 2u] = Chroma( 128 * r - 107 * g - 21 * b + 128 );
+		}
+	}
+}
+
+std::wstring VideoCapture::Stats::ToString() const
+{
+	std::wostringstream ss;
+	ss << std::fixed << std::setprecision( 3 );
+	ss << L"Frames submitted: " << framesSubmitted << L"\n";
+	ss << L"Frames dropped: " << framesDropped << L"\n";
+	ss << L"Frames written: " << framesWritten << L"\n";
+	ss << L"Bytes written: " << bytesWritten << L"\n";
+	ss << L"Submit (render thread): " << (framesSubmitted != 0u ? submitMsTotal / double( framesSubmitted ) : 0.0)
+		<< L" ms avg, " << submitMsMax << L" ms max\n";
+	ss << L"Convert (writer thread): " << (framesWritten != 0u ? convertMsTotal / double( framesWritten ) : 0.0)
+		<< L" ms avg\n";
+	return ss.str();
+}
+
+VideoCapture::VideoCapture( const std::wstring& filename,unsigned int width,unsigned int height,
+	unsigned int fps,unsigned int queueDepth )
+	:
+	filename( filename ),
+	width( width ),
+	height( height ),
+	out( filename,writeBufferSize )
+{
+	assert( queueDepth > 0u );
+	if( !out )
+	{
+		throw Exception( _CRT_WIDE( __FILE__ ),__LINE__,L"Unable to open video file for writing: " + filename );
+	}
+	// C420jpeg: 4:2:0 with chroma sited between the luma samples, which is what averaging 2x2 blocks gives
+	const std::string header = "YUV4MPEG2 W" + std::to_string( width ) + " H" + std::to_string( height ) +
+		" F" + std::to_string( fps ) + ":1 Ip A1:1 C420jpeg XCOLORRANGE=FULL\n";
+	out.Write( header.data(),header.size() );
+	stats.bytesWritten = header.size();
+	frames.reserve( queueDepth );
+	for( unsigned int i = 0u; i < queueDepth; i++ )
+	{
+		frames.emplace_back( width,height,Surface::RowAlignment::CacheLine );
+		freeFrames.push_back( i );
+	}
+	const size_t chromaSize = size_t( (width + 1u) / 2u ) * ((height + 1u) / 2u);
+	planes.resize( size_t( width ) * height + 2u * chromaSize );
+	writeThread = std::thread( &VideoCapture::WriteLoop,this );
+}
+
+VideoCapture::~VideoCapture()
+{
+	{
+		std::lock_guard<std::mutex> lock( mtx );
+		stopping = true;
+	}
+	cv.notify_all();
+	writeThread.join();
+}
+
+bool VideoCapture::Submit( const Surface& frame )
+{
+	CHILI_PROFILE_ZONE( "VideoCapture::Submit" );
+	assert( frame.GetWidth() == width && frame.GetHeight() == height );
+	const auto start = std::chrono::steady_clock::now();
+	size_t i;
+	{
+		std::lock_guard<std::mutex> lock( mtx );
+		RethrowWriteError();
+		stats.framesSubmitted++;
+		if( freeFrames.empty() )
+		{
+			stats.framesDropped++;
+			return false;
+		}
+		i = freeFrames.back();
+		freeFrames.pop_back();
+	}
+	// the slot is ours until it is queued
+	frames[i].Copy( frame );
+	const std::chrono::duration<double,std::milli> elapsed = std::chrono::steady_clock::now() - start;
+	{
+		std::lock_guard<std::mutex> lock( mtx );
+		readyFrames.push_back( i );
+		stats.submitMsTotal += elapsed.count();
+		stats.submitMsMax = std::max( stats.submitMsMax,elapsed.count() );
+	}
+	cv.notify_all();
+	return true;
+}
+
+void VideoCapture::Flush()
+{
+	std::unique_lock<std::mutex> lock( mtx );
+	cv.wait( lock,[this]() { return (readyFrames.empty() && !busy) || writeFailed; } );
+	RethrowWriteError();
+}
+
+VideoCapture::Stats VideoCapture::GetStats() const
+{
+	std::lock_guard<std::mutex> lock( mtx );
+	return stats;
+}
+
+void VideoCapture::WriteLoop()
+{
+	std::unique_lock<std::mutex> lock( mtx );
+	while( true )
+	{
+		cv.wait( lock,[this]() { return !readyFrames.empty() || stopping; } );
+		if( readyFrames.empty() || writeFailed )
+		{
+			// stopping and everything has been written, or there's no point writing more
+			out.Flush();
+			return;
+		}
+		const size_t i = readyFrames.front();
+		readyFrames.pop_front();
+		busy = true;
+		lock.unlock();
+
+		CHILI_PROFILE_ZONE( "VideoCapture::WriteFrame" );
+		const auto start = std::chrono::steady_clock::now();
+		WriteFrame( frames[i] );
+		const std::chrono::duration<double,std::milli> elapsed = std::chrono::steady_clock::now() - start;
+		const bool failed = !out;
+
+		lock.lock();
+		busy = false;
+		writeFailed = failed;
+		stats.framesWritten++;
+		stats.bytesWritten += 6u + planes.size();
+		stats.convertMsTotal += elapsed.count();
+		freeFrames.push_back( i );
+		cv.notify_all();
+	}
+}
+
+void VideoCapture::WriteFrame( const Surface& frame )
+{
+	const unsigned int chromaWidth = (width + 1u) / 2u;
+	const unsigned int chromaHeight = (height + 1u) / 2u;
+	unsigned char* const pY = planes.data();
+	unsigned char* const pU = pY + size_t( width ) * height;
+	unsigned char* const pV = pU + size_t( chromaWidth ) * chromaHeight;
+	const Color* const pPixels = frame.GetBufferPtrConst();
+	const unsigned int pitch = frame.GetPitch();
+	for( unsigned int cy = 0u; cy < chromaHeight; cy++ )
+	{
+		const unsigned int y0 = 2u * cy;
+		const unsigned int y1 = std::min( y0 + 1u,height - 1u );
+		ConvertRowPair( pPixels + size_t( pitch ) * y0,pPixels + size_t( pitch ) * y1,width,
+			pY + size_t( width ) * y0,pY + size_t( width ) * y1,
+			pU + size_t( chromaWidth ) * cy,pV + size_t( chromaWidth ) * cy );
+	}
+	out.Write( "FRAME\n",6u );
+	out.Write( planes.data(),planes.size() );
+}
+
+void VideoCapture::RethrowWriteError() const
+{
+	if( writeFailed )
+	{
+		throw Exception( _CRT_WIDE( __FILE__ ),__LINE__,L"Error writing video file: " + filename );
+	}
+}
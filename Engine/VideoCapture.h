@@ -0,0 +1,96 @@
+/******************************************************************************************
+*	Chili DirectX Framework Version 16.10.01											  *
+*	VideoCapture.h																		  *
+*	Copyright 2016 PlanetChili <http://www.planetchili.net>								  *
+*																						  *
+*	This file is part of The Chili DirectX Framework.									  *
+*																						  *
+*	The Chili DirectX Framework is free software: you can redistribute it and/or modify	  *
+*	it under the terms of the GNU General Public License as published by				  *
+*	the Free Software Foundation, either version 3 of the License, or					  *
+*	(at your option) any later version.													  *
+*																						  *
+*	The Chili DirectX Framework is distributed in the hope that it will be useful,		  *
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of						  *
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the						  *
+*	GNU General Public License for more details.										  *
+*																						  *
+*	You should have received a copy of the GNU General Public License					  *
+*	along with The Chili DirectX Framework.  If not, see <http://www.gnu.org/licenses/>.  *
+******************************************************************************************/
+#pragma once
+
+#include "Surface.h"
+#include "FileWriter.h"
+#include "ChiliException.h"
+#include <vector>
+#include <deque>
+#include <string>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+// streams frames into a YUV4MPEG2 (.y4m) file, 4:2:0 full range, for recording sessions
+// Submit copies the frame into a free slot of a bounded queue and returns; a writer thread
+// converts it to YUV and appends it through a large buffered writer
+// when every slot is still waiting to be written the frame is dropped (and counted), never waited on
+class VideoCapture
+{
+public:
+	class Exception : public ChiliException
+	{
+	public:
+		using ChiliException::ChiliException;
+		virtual std::wstring GetFullMessage() const override { return GetNote() + L"\nAt: " + GetLocation(); }
+		virtual std::wstring GetExceptionType() const override { return L"Video Capture Exception"; }
+	};
+	struct Stats
+	{
+		unsigned long long framesSubmitted = 0u;
+		// not queued because every slot was busy
+		unsigned long long framesDropped = 0u;
+		unsigned long long framesWritten = 0u;
+		unsigned long long bytesWritten = 0u;
+		// time spent in Submit, i.e. the cost to the rendering thread
+		double submitMsTotal = 0.0;
+		double submitMsMax = 0.0;
+		// time the writer thread spent converting to YUV
+		double convertMsTotal = 0.0;
+		std::wstring ToString() const;
+	};
+public:
+	// frames submitted must be width x height
+	VideoCapture( const std::wstring& filename,unsigned int width,unsigned int height,
+		unsigned int fps = 60u,unsigned int queueDepth = 8u );
+	VideoCapture( const VideoCapture& ) = delete;
+	VideoCapture& operator=( const VideoCapture& ) = delete;
+	// writes out every frame still queued before returning
+	~VideoCapture();
+	// false if the frame was dropped; throws if writing the file has failed
+	bool Submit( const Surface& frame );
+	// block until every queued frame has been written
+	void Flush();
+	Stats GetStats() const;
+private:
+	void WriteLoop();
+	void WriteFrame( const Surface& frame );
+	void RethrowWriteError() const;
+private:
+	const std::wstring filename;
+	const unsigned int width;
+	const unsigned int height;
+	FileWriter out;
+	std::vector<Surface> frames;
+	// indices into frames
+	std::vector<size_t> freeFrames;
+	std::deque<size_t> readyFrames;
+	// Y, then U and V, of the frame being written; writer thread only
+	std::vector<unsigned char> planes;
+	bool busy = false;
+	bool stopping = false;
+	bool writeFailed = false;
+	Stats stats;
+	mutable std::mutex mtx;
+	std::condition_variable cv;
+	std::thread writeThread;
+};